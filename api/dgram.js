@@ -122,12 +122,18 @@ function createDataListener (socket) {
     const { err, data, source } = detail.params
     const buffer = detail.data
 
-    if (err && err.id === socket.id) {
+    if (err?.id && BigInt(err.id) === socket.id) {
       return socket.emit('error', err)
     }
 
     if (!data || BigInt(data.id) !== socket.id) return
 
+    if (source === 'udp.drain') {
+      socket.state.needDrain = false
+      socket.emit('drain')
+      return
+    }
+
     if (source === 'udp.readStart') {
       const message = Buffer.from(buffer)
       const info = {
@@ -313,9 +319,19 @@ async function bind (socket, options, callback) {
       port: options.port || 0,
       address: options.address,
       ipv6Only: !!options.ipv6Only,
-      reuseAddr: !!options.reuseAddr
+      reuseAddr: !!options.reuseAddr,
+      rate: socket.state.rate ?? 0,
+      burst: socket.state.burst ?? 0,
+      highWaterMark: socket.state.highWaterMark ?? 0,
+      compress: socket.state.compress
     })
 
+    if (result.err) {
+      socket.state.bindState = BIND_STATE_UNBOUND
+      callback(result.err)
+      return { err: result.err }
+    }
+
     socket.state.bindState = BIND_STATE_BOUND
 
     if (socket.state.sendBufferSize) {
@@ -342,6 +358,10 @@ async function bind (socket, options, callback) {
       socket.state.recvBufferSize = result.data.size
     }
 
+    if (socket.state.key) {
+      await socket.setKey(socket.state.key)
+    }
+
     callback(result.err, result.data)
   } catch (err) {
     socket.state.bindState = BIND_STATE_UNBOUND
@@ -397,9 +417,19 @@ async function connect (socket, options, callback) {
     result = await ipc.send('udp.connect', {
       id: socket.id,
       port: options?.port ?? 0,
-      address: options?.address
+      address: options?.address,
+      rate: socket.state.rate ?? 0,
+      burst: socket.state.burst ?? 0,
+      highWaterMark: socket.state.highWaterMark ?? 0,
+      compress: socket.state.compress
     })
 
+    if (result.err) {
+      socket.state.connectState = CONNECT_STATE_DISCONNECTED
+      callback(result.err)
+      return { err: result.err }
+    }
+
     socket.state.connectState = CONNECT_STATE_CONNECTED
 
     if (socket.state.sendBufferSize) {
@@ -426,6 +456,10 @@ async function connect (socket, options, callback) {
       socket.state.recvBufferSize = result.data.size
     }
 
+    if (socket.state.key) {
+      await socket.setKey(socket.state.key)
+    }
+
     callback(result.err, result.data)
   } catch (err) {
     socket.state.connectState = CONNECT_STATE_DISCONNECTED
@@ -562,11 +596,30 @@ async function send (socket, options, callback) {
       address: options.address
     })
 
-    result = await ipc.write('udp.send', {
-      id: socket.id,
-      port: options.port,
-      address: options.address
-    }, options.buffer)
+    if (options.sizes) {
+      result = await ipc.write('udp.sendBatch', {
+        id: socket.id,
+        port: options.port,
+        address: options.address,
+        sizes: options.sizes.join(',')
+      }, options.buffer)
+    } else {
+      result = await ipc.write('udp.send', {
+        id: socket.id,
+        port: options.port,
+        address: options.address
+      }, options.buffer)
+    }
+
+    // paced sockets report when the native send queue is over its high-water mark
+    // and emit 'error' for datagrams that fail after this call has returned
+    if (result.data?.backpressure) {
+      socket.state.needDrain = true
+    }
+
+    if (socket.state.rate > 0 && !socket.dataListener) {
+      socket.dataListener = createDataListener(socket)
+    }
 
     callback(result.err, result.data)
   } catch (err) {
@@ -677,12 +730,30 @@ function getSockName (socket, callback) {
  * @param {boolean=} [options.ipv6Only=false] - Default: false.
  * @param {number=} options.recvBufferSize - Sets the SO_RCVBUF socket value.
  * @param {number=} options.sendBufferSize - Sets the SO_SNDBUF socket value.
+ * @param {number=} options.rate - Paces outgoing datagrams to this many bytes per second.
+ * @param {number=} options.burst - Bytes that may be sent at once when pacing, at least 64 KiB. Default: 64 KiB.
+ * @param {number=} options.highWaterMark - Queued bytes after which `writableNeedDrain` is set. Default: 1 MiB.
+ * @param {boolean=} [options.compress=false] - Deflates every datagram sent and inflates every datagram received. Both ends must enable it. Default: false.
+ * @param {Buffer|TypedArray=} options.key - A 32 byte key to seal and open every datagram with. See `Socket#setKey()`.
  * @param {AbortSignal=} options.signal - An AbortSignal that may be used to close a socket.
  * @param {function=} callback - Attached as a listener for 'message' events. Optional.
  * @return {Socket}
  */
 export const createSocket = (options, callback) => new Socket(options, callback)
 
+/**
+ * Returns a snapshot of counters for every open UDP socket.
+ * @return {Promise<object[]>}
+ */
+export async function getAllStats () {
+  const result = await ipc.send('udp.getAllStats')
+  if (result.err) {
+    throw result.err
+  }
+
+  return result.data
+}
+
 /**
  * New instances of dgram.Socket are created using dgram.createSocket().
  * The new keyword is not to be used to create dgram.Socket instances.
@@ -712,7 +783,13 @@ export class Socket extends EventEmitter {
       bindState: BIND_STATE_UNBOUND,
       connectState: CONNECT_STATE_DISCONNECTED,
       reuseAddr: options.reuseAddr === true,
-      ipv6Only: options.ipv6Only === true
+      ipv6Only: options.ipv6Only === true,
+      rate: options.rate,
+      burst: options.burst,
+      highWaterMark: options.highWaterMark,
+      compress: options.compress === true,
+      key: options.key ?? null,
+      needDrain: false
     }
 
     if (isFunction(callback)) {
@@ -978,6 +1055,50 @@ export class Socket extends EventEmitter {
     return send(this, { id, port, address, buffer }, cb)
   }
 
+  /**
+   * Sends each of `messages` as its own datagram with a single call into
+   * the runtime. Compression and encryption are applied to every datagram
+   * natively in one pass.
+   *
+   * @param {Array<Buffer | TypedArray | DataView | string>} messages - Messages to be sent.
+   * @param {integer=} port - Destination port.
+   * @param {string=} address - Destination host name or IP address.
+   * @param {Function=} callback - Called when every message has been sent.
+   */
+  sendBatch (messages, ...args) {
+    const id = this.id || rand64()
+    let port
+    let address
+    let cb = defaultCallback(this)
+
+    if (!Array.isArray(messages)) {
+      throw new TypeError('Invalid messages')
+    }
+
+    const buffers = messages.map((message) => Buffer.from(message))
+
+    if (args.findIndex(isFunction) === args.length - 1) {
+      cb = args.pop()
+    }
+
+    [port, address] = args
+
+    if (port !== undefined || this.state.connectState !== CONNECT_STATE_CONNECTED) {
+      port = parseInt(port)
+
+      if (!Number.isInteger(port) || port <= 0 || port > (64 * 1024)) {
+        throw new ERR_SOCKET_BAD_PORT(
+          `Port should be > 0 and < 65536. Received ${port}.`
+        )
+      }
+    }
+
+    const sizes = buffers.map((buffer) => buffer.length)
+    const buffer = Buffer.concat(buffers)
+
+    return send(this, { id, port, address, buffer, sizes }, cb)
+  }
+
   /**
    * Close the underlying socket and stop listening for data on it. If a
    * callback is provided, it is added as a listener for the 'close' event.
@@ -1137,6 +1258,60 @@ export class Socket extends EventEmitter {
     }
   }
 
+  /**
+   * Installs a 32 byte key used to seal every datagram sent and open every
+   * datagram received natively with XSalsa20-Poly1305, as libsodium's
+   * `crypto_secretbox_easy()` with the 24 byte nonce prepended. Datagrams
+   * that do not open with the key are dropped. `null` removes the key.
+   *
+   * @param {Buffer | TypedArray | null} key
+   */
+  async setKey (key) {
+    if (key !== null && (!isArrayBufferView(key) || key.byteLength !== 32)) {
+      throw new TypeError('Key must be 32 bytes')
+    }
+
+    this.state.key = key
+
+    if (
+      this.state.bindState !== BIND_STATE_BOUND &&
+      this.state.connectState !== CONNECT_STATE_CONNECTED
+    ) {
+      return
+    }
+
+    const buffer = key === null ? Buffer.alloc(0) : Buffer.from(key.buffer, key.byteOffset, key.byteLength)
+    const result = await ipc.write('udp.setKey', { id: this.id }, buffer)
+
+    if (result.err) {
+      throw result.err
+    }
+  }
+
+  /**
+   * Returns packet, byte and error counters for the underlying socket.
+   * `receiveQueueDrops` counts datagrams the kernel dropped because the
+   * receive buffer was full (Linux only).
+   * @return {Promise<object>}
+   */
+  async getStats () {
+    const result = await ipc.send('udp.getStats', { id: this.id })
+    if (result.err) {
+      throw result.err
+    }
+
+    return result.data
+  }
+
+  /**
+   * `true` when a paced socket has more queued bytes than its high-water
+   * mark. Wait for the 'drain' event before sending more data.
+   * @type {boolean}
+   */
+  get writableNeedDrain () {
+    return this.state.needDrain
+  }
+
   /**
    * @see {@link https://nodejs.org/api/dgram.html#socketgetrecvbuffersize}
    */
@@ -1,5 +1,6 @@
 import channels from './channels.js'
 import window from './window.js'
+import ipc from '../ipc.js'
 
 import * as exports from './index.js'
 
@@ -13,3 +14,18 @@ export { channels, window }
 export function channel (name) {
   return channels.channel(name)
 }
+
+/**
+ * Returns a snapshot of native runtime diagnostics, such as the number of
+ * file system requests in flight and the bytes their contexts occupy.
+ * @return {Promise<object>}
+ */
+export async function query () {
+  const result = await ipc.send('diagnostics.query')
+
+  if (result.err) {
+    throw result.err
+  }
+
+  return result.data
+}
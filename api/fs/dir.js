@@ -1,5 +1,6 @@
 import { DirectoryHandle } from './handle.js'
 import { Buffer } from '../buffer.js'
+import { Stats } from './stats.js'
 import {
   UV_DIRENT_UNKNOWN,
   UV_DIRENT_FILE,
@@ -58,6 +59,7 @@ export class Dir {
     this.handle = handle
     this.encoding = options?.encoding || 'utf8'
     this.withFileTypes = options?.withFileTypes !== false
+    this.withStats = options?.withStats === true
   }
 
   /**
@@ -99,7 +101,10 @@ export class Dir {
     let results = []
 
     try {
-      results = await this.handle?.read(options)
+      results = await this.handle?.read({
+        withStats: this.withStats,
+        ...options
+      })
     } catch (err) {
       if (typeof callback === 'function') {
         callback(err)
@@ -111,8 +116,13 @@ export class Dir {
 
     results = results.map((result) => {
       if (this.withFileTypes) {
+        const { stats } = result
         result = Dirent.from(result)
 
+        if (stats && !stats.err) {
+          result.stats = Stats.from(stats)
+        }
+
         if (this.encoding === 'buffer') {
           result.name = Buffer.from(result.name)
         } else {
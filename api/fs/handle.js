@@ -3,7 +3,6 @@ import {
   isBufferLike,
   isTypedArray,
   isEmptyObject,
-  splitBuffer,
   clamp
 } from '../util.js'
 
@@ -15,7 +14,7 @@ import { EventEmitter } from '../events.js'
 import { AbortError } from '../errors.js'
 import diagnostics from '../diagnostics.js'
 import { Buffer } from '../buffer.js'
-import { Stats } from './stats.js'
+import { Stats, getStatsRecord } from './stats.js'
 import { F_OK } from './constants.js'
 import console from '../console.js'
 import fds from './fds.js'
@@ -36,6 +35,15 @@ export const kOpening = Symbol.for('fs.FileHandle.opening')
 export const kClosing = Symbol.for('fs.FileHandle.closing')
 export const kClosed = Symbol.for('fs.FileHandle.closed')
 
+function encodeDigest (digest, encoding) {
+  if (!encoding || encoding === 'hex') {
+    return digest
+  }
+
+  const buffer = Buffer.from(digest, 'hex')
+  return encoding === 'buffer' ? buffer : buffer.toString(encoding)
+}
+
 /**
  * A container for a descriptor tracked in `fds` and opened in the native layer.
  * This class implements the Node.js `FileHandle` interface
@@ -45,6 +53,7 @@ export class FileHandle extends EventEmitter {
   static get DEFAULT_ACCESS_MODE () { return F_OK }
   static get DEFAULT_OPEN_FLAGS () { return 'r' }
   static get DEFAULT_OPEN_MODE () { return 0o666 }
+  static get MAX_IOVECS () { return 16 }
 
   /**
    * Creates a `FileHandle` from a given `id` or `fd`
@@ -297,6 +306,8 @@ export class FileHandle extends EventEmitter {
   /**
    * Creates a `ReadStream` for the underlying file.
    * @param {object=} [options] - An options object
+   * @param {number=} [options.readAhead = 4] - Chunks read natively ahead of
+   *   the stream, 0 to read one chunk at a time
    */
   createReadStream (options) {
     if (this.closing || this.closed) {
@@ -325,6 +336,10 @@ export class FileHandle extends EventEmitter {
   /**
    * Creates a `WriteStream` for the underlying file.
    * @param {object=} [options] - An options object
+   * @param {boolean=} [options.writeBehind = true] - Buffer writes natively
+   *   and write them in batches, errors surface on a later write or on finish
+   * @param {number=} [options.expectedSize] - Bytes to reserve on disk up
+   *   front for the data about to be written
    */
   createWriteStream (options) {
     if (this.closing || this.closed) {
@@ -351,12 +366,217 @@ export class FileHandle extends EventEmitter {
   }
 
   /**
-   * @param {object=} [options]
+   * Synchronizes the file's data with the disk, skipping metadata that is
+   * not needed to read it back. Writes buffered by `writeBehind()` are
+   * flushed first.
+   * @see {@link https://nodejs.org/dist/latest-v16.x/docs/api/fs.html#filehandledatasync}
    */
   async datasync () {
     if (this.closing || this.closed) {
       throw new Error('FileHandle is not opened')
     }
+
+    const result = await ipc.send('fs.fdatasync', { id: this.id })
+
+    if (result.err) {
+      throw result.err
+    }
+  }
+
+  /**
+   * Finalizes the digest of the bytes written since `hashWrites()` and stops
+   * hashing writes.
+   * @param {object=} [options]
+   * @param {string=} [options.encoding = 'hex'] - 'buffer' for a `Buffer`
+   * @return {Promise<string|Buffer>}
+   */
+  async digest (options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.digest', { id: this.id })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    return encodeDigest(result.data.digest, options?.encoding)
+  }
+
+  /**
+   * Allocates disk space for `length` bytes at `offset` so later writes to
+   * the range cannot fail for lack of space and land in contiguous blocks.
+   * @param {number} offset
+   * @param {number} length
+   * @param {object=} [options]
+   * @param {string=} [options.mode = 'allocate'] - 'allocate' extends the
+   *   file to cover the range, 'keep-size' reserves it without changing the
+   *   file size and 'punch-hole' releases it, see `punchHole()`
+   */
+  async fallocate (offset, length, options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.fallocate', {
+      id: this.id,
+      offset,
+      length,
+      mode: options?.mode ?? 'allocate'
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+  }
+
+  /**
+   * Writes every write buffered by `writeBehind()` to the file.
+   * Rejects with the error of a failed batch, if any.
+   */
+  async flush () {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.flush', { id: this.id })
+
+    if (result.err) {
+      throw result.err
+    }
+  }
+
+  /**
+   * Hashes the contents of the file natively, only the digest crosses the
+   * bridge. Writes buffered by `writeBehind()` are flushed first.
+   * @param {string=} [algorithm = 'sha256'] - 'sha256', 'blake2b',
+   *   'blake2b256' or 'xxh64'
+   * @param {object=} [options]
+   * @param {string=} [options.encoding = 'hex'] - 'buffer' for a `Buffer`
+   * @return {Promise<string|Buffer>}
+   */
+  async hash (algorithm, options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.fhash', {
+      id: this.id,
+      algorithm: algorithm ?? 'sha256'
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    return encodeDigest(result.data.digest, options?.encoding)
+  }
+
+  /**
+   * Hashes every byte written to the file from now on, for verifying a
+   * download while it is written. Each write has to start where the
+   * previous one ended, otherwise `digest()` rejects. See `digest()`.
+   * @param {string=} [algorithm = 'sha256'] - 'sha256', 'blake2b',
+   *   'blake2b256' or 'xxh64'
+   */
+  async hashWrites (algorithm) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.hashWrites', {
+      id: this.id,
+      algorithm: algorithm ?? 'sha256'
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+  }
+
+  /**
+   * Maps the underlying file into memory so that `read()` calls are served
+   * from the mapping without read syscalls. The mapping is released with
+   * `munmap()` or when the handle is closed, after the reads it served. The
+   * file should not be truncated while it is mapped.
+   * @param {object=} [options]
+   * @param {string=} [options.advice = 'normal'] - One of 'normal', 'sequential', 'random' or 'willneed'
+   * @return {Promise<number>} The size of the mapping in bytes
+   */
+  async mmap (options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.mmap', {
+      id: this.id,
+      advice: options?.advice ?? 'normal'
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    return result.data.size
+  }
+
+  /**
+   * Releases a mapping created with `mmap()`.
+   */
+  async munmap () {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.munmap', { id: this.id })
+
+    if (result.err) {
+      throw result.err
+    }
+  }
+
+  /**
+   * Releases the disk space of `length` bytes at `offset` without changing
+   * the file size, reads of the range return zeros. Lets rolling logs be
+   * compacted in place.
+   * @param {number} offset
+   * @param {number} length
+   */
+  async punchHole (offset, length) {
+    await this.fallocate(offset, length, { mode: 'punch-hole' })
+  }
+
+  /**
+   * Reads ahead of a sequential reader. Up to `window` chunks of `size`
+   * bytes starting at `offset` are kept in flight natively, so `read()`
+   * calls for the next chunk are answered without waiting on the disk.
+   * Call without options to query the current read-ahead, or with a
+   * `window` of 0 to stop it.
+   * @param {object=} [options]
+   * @param {number=} [options.size = 65536] - Bytes per chunk
+   * @param {number=} [options.window] - Chunks kept ahead of the reader
+   * @param {number=} [options.offset = 0]
+   * @return {Promise<object>} `{ size, window, hits, stalls, misses, stallTime }`,
+   *   `stallTime` is in milliseconds
+   */
+  async readAhead (options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.readAhead', {
+      id: this.id,
+      size: options?.size ?? 64 * 1024,
+      window: options?.window ?? -1,
+      offset: options?.offset ?? 0
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    return result.data
   }
 
   /**
@@ -489,13 +709,14 @@ export class FileHandle extends EventEmitter {
       )
     }
 
-    if (isTypedArray(buffer)) {
-      buffer = Buffer.from(buffer.buffer) // from ArrayBuffer
-    }
+    // a view over the caller provided window so reads fill it in place
+    const target = isTypedArray(buffer)
+      ? Buffer.from(buffer.buffer, buffer.byteOffset, buffer.byteLength)
+      : Buffer.from(buffer)
 
-    if (length > buffer.byteLength - offset) {
+    if (length > target.byteLength - offset) {
       throw new RangeError(
-        `Expecting length to be less than or equal to ${buffer.byteLength - offset}: ` +
+        `Expecting length to be less than or equal to ${target.byteLength - offset}: ` +
         `Got ${length}`
       )
     }
@@ -520,7 +741,7 @@ export class FileHandle extends EventEmitter {
 
     if (isTypedArray(result.data) || result.data instanceof ArrayBuffer) {
       bytesRead = result.data.byteLength
-      Buffer.from(result.data).copy(Buffer.from(buffer), 0, offset)
+      Buffer.from(result.data).copy(target, offset)
       dc.channel('handle.read').publish({ handle: this, bytesRead })
     } else if (isEmptyObject(result.data)) {
       // an empty response from mac returns an empty object sometimes
@@ -546,30 +767,36 @@ export class FileHandle extends EventEmitter {
       throw new Error('FileHandle is not opened')
     }
 
-    const buffers = []
     const signal = options?.signal
-    const stream = this.createReadStream(options)
+    const timeout = options?.timeout
 
-    if (signal instanceof AbortSignal) {
-      if (signal.aborted) {
-        throw new AbortError(signal)
-      }
+    if (signal?.aborted) {
+      throw new AbortError(signal)
+    }
 
-      signal.addEventListener('abort', () => {
-        if (!stream.destroyed && !stream.destroying) {
-          stream.destroy(new AbortError(signal))
-        }
-      })
+    // the native layer sizes, reads and replies with the whole file at once
+    const result = await ipc.request('fs.readFile', {
+      id: this.id
+    }, { signal, timeout, responseType: 'arraybuffer' })
+
+    if (result.err) {
+      throw result.err
     }
 
-    // collect
-    await new Promise((resolve, reject) => {
-      stream.on('data', (buffer) => buffers.push(buffer))
-      stream.once('end', resolve)
-      stream.once('error', reject)
-    })
+    let buffer = null
+
+    if (isTypedArray(result.data) || result.data instanceof ArrayBuffer) {
+      buffer = Buffer.from(result.data)
+    } else if (isEmptyObject(result.data)) {
+      // an empty response from mac returns an empty object sometimes
+      buffer = Buffer.alloc(0)
+    } else {
+      throw new TypeError(
+        `Invalid response buffer from 'fs.readFile' Received: ${typeof result.data}`
+      )
+    }
 
-    const buffer = Buffer.concat(buffers)
+    dc.channel('handle.read').publish({ handle: this, bytesRead: buffer.byteLength })
 
     if (typeof options?.encoding === 'string') {
       return buffer.toString(options.encoding)
@@ -579,12 +806,226 @@ export class FileHandle extends EventEmitter {
   }
 
   /**
+   * Reads into `buffers` in order starting at `position` with a single
+   * request to the native layer.
+   * @param {Buffer[]|TypedArray[]} buffers
+   * @param {number=} [position]
    * @param {object=} [options]
    */
-  async readv (buffers, position) {
+  async readv (buffers, position, options) {
     if (this.closing || this.closed) {
       throw new Error('FileHandle is not opened')
     }
+
+    if (!Array.isArray(buffers) || !buffers.every(isBufferLike)) {
+      throw new TypeError('Expecting buffers to be an array of Buffer or TypedArray.')
+    }
+
+    if (position === null || position === undefined) {
+      position = -1
+    }
+
+    if (typeof position !== 'number') {
+      throw new TypeError(`Expecting position to be a number. Got ${typeof position}`)
+    }
+
+    const { id } = this
+    const signal = options?.signal || null
+    const timeout = options?.timeout || null
+
+    if (signal?.aborted) {
+      throw new AbortError(signal)
+    }
+
+    let bytesRead = 0
+
+    for (let i = 0; i < buffers.length; i += FileHandle.MAX_IOVECS) {
+      const batch = buffers.slice(i, i + FileHandle.MAX_IOVECS)
+      const sizes = batch.map((buffer) => buffer.byteLength)
+      const size = sizes.reduce((a, b) => a + b, 0)
+
+      if (size === 0) {
+        continue
+      }
+
+      const result = await ipc.request('fs.readv', {
+        id,
+        sizes: sizes.join(','),
+        offset: position
+      }, { signal, timeout, responseType: 'arraybuffer' })
+
+      if (result.err) {
+        throw result.err
+      }
+
+      const data = isTypedArray(result.data) || result.data instanceof ArrayBuffer
+        ? Buffer.from(result.data)
+        : Buffer.alloc(0)
+
+      // scatter the packed response back over the caller's buffers
+      let cursor = 0
+      for (const buffer of batch) {
+        if (cursor >= data.byteLength) {
+          break
+        }
+
+        const target = Buffer.from(buffer.buffer, buffer.byteOffset, buffer.byteLength)
+        cursor += data.copy(target, 0, cursor, cursor + target.byteLength)
+      }
+
+      bytesRead += data.byteLength
+      dc.channel('handle.read').publish({ handle: this, bytesRead: data.byteLength })
+
+      if (data.byteLength < size) {
+        break
+      }
+
+      if (position >= 0) {
+        position += size
+      }
+    }
+
+    return { bytesRead, buffers }
+  }
+
+  /**
+   * Sends a range of the file to a peer natively, without the bytes
+   * entering the WebView. UDP sockets are sent `chunkSize` datagrams in
+   * order, paced by the socket's pacing options.
+   * @param {dgram.Socket|bigint} socket - A bound or connected socket, or its id
+   * @param {object=} [options]
+   * @param {number=} [options.offset = 0]
+   * @param {number=} [options.length] - Bytes to send, defaults to the rest
+   *   of the file
+   * @param {number=} [options.port] - Destination of an unconnected socket
+   * @param {string=} [options.address] - Destination of an unconnected socket
+   * @param {number=} [options.chunkSize = 1200] - Bytes per datagram
+   * @param {number=} [options.window = 16] - Datagrams in flight
+   * @param {number=} [options.progressInterval = 100] - Milliseconds between
+   *   calls to `onprogress`
+   * @param {function(object)=} [options.onprogress] - Called with
+   *   `{ bytesSent, total, chunks }` while the transfer is running
+   * @param {AbortSignal=} [options.signal]
+   * @return {Promise<{ bytesSent: number, total: number, chunks: number, elapsed: number }>}
+   */
+  async sendToPeer (socket, options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const signal = options?.signal
+
+    if (signal?.aborted) {
+      throw new AbortError(signal)
+    }
+
+    const transferId = rand64()
+    const onprogress = options?.onprogress
+
+    const ondata = ({ detail }) => {
+      const { data, source } = detail.params ?? {}
+
+      if (source === 'fs.sendToPeer' && data?.id === String(transferId)) {
+        onprogress(data)
+      }
+    }
+
+    const onabort = () => {
+      ipc.send('fs.cancelSendToPeer', { transferId })
+    }
+
+    if (typeof onprogress === 'function') {
+      window.addEventListener('data', ondata)
+    }
+
+    signal?.addEventListener('abort', onabort, { once: true })
+
+    let result = null
+
+    try {
+      result = await ipc.send('fs.sendToPeer', {
+        id: this.id,
+        transferId,
+        peerId: socket?.id ?? socket,
+        offset: options?.offset ?? 0,
+        length: options?.length ?? -1,
+        port: options?.port ?? 0,
+        address: options?.address ?? '',
+        chunkSize: options?.chunkSize ?? 1200,
+        window: options?.window ?? 16,
+        progressInterval: options?.progressInterval ?? 100
+      })
+    } finally {
+      signal?.removeEventListener('abort', onabort)
+      window.removeEventListener('data', ondata)
+    }
+
+    if (result.err) {
+      throw result.err
+    }
+
+    if (result.data.cancelled) {
+      throw new AbortError(signal)
+    }
+
+    const { bytesSent, total, chunks, elapsed } = result.data
+    return { bytesSent, total, chunks, elapsed }
+  }
+
+  /**
+   * Compresses (or decompresses) the rest of this file into `target`
+   * natively on the threadpool, without the bytes entering the WebView.
+   * Both handles are used from their current positions.
+   * @param {FileHandle|bigint} target - An open handle, or its id
+   * @param {object=} [options]
+   * @param {string=} [options.format = 'gzip'] - 'gzip', 'deflate' or 'raw'
+   * @param {number=} [options.level = -1] - 0 to 9, -1 for the zlib default
+   * @param {boolean=} [options.decompress = false]
+   * @param {function(object)=} [options.onprogress] - Called with
+   *   `{ bytesIn, bytesOut }` after every chunk
+   * @return {Promise<{ bytesIn: number, bytesOut: number }>}
+   */
+  async compressTo (target, options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const id = rand64()
+    const onprogress = options?.onprogress
+
+    const ondata = ({ detail }) => {
+      const { data, source } = detail.params ?? {}
+
+      if (source === 'compression.pipe' && data?.id === String(id)) {
+        onprogress({ bytesIn: data.bytesIn, bytesOut: data.bytesOut })
+      }
+    }
+
+    if (typeof onprogress === 'function') {
+      window.addEventListener('data', ondata)
+    }
+
+    let result = null
+
+    try {
+      result = await ipc.send('compression.pipe', {
+        id,
+        source: this.id,
+        target: target?.id ?? target,
+        format: options?.format ?? 'gzip',
+        level: options?.level ?? -1,
+        decompress: options?.decompress === true
+      })
+    } finally {
+      window.removeEventListener('data', ondata)
+    }
+
+    if (result.err) {
+      throw result.err
+    }
+
+    const { bytesIn, bytesOut } = result.data
+    return { bytesIn, bytesOut }
   }
 
   /**
@@ -596,33 +1037,64 @@ export class FileHandle extends EventEmitter {
       throw new Error('FileHandle is not opened')
     }
 
-    const result = await ipc.request('fs.fstat', { ...options, id: this.id })
+    const result = await ipc.request('fs.fstat', {
+      ...options,
+      id: this.id,
+      encoding: 'binary'
+    }, {
+      signal: options?.signal,
+      timeout: options?.timeout,
+      responseType: 'arraybuffer'
+    })
 
     if (result.err) {
       throw result.err
     }
 
-    const stats = Stats.from(result.data, Boolean(options?.bigint))
+    const bigint = Boolean(options?.bigint)
+    const stats = isTypedArray(result.data) || result.data instanceof ArrayBuffer
+      ? Stats.fromRecord(getStatsRecord(result.data), bigint)
+      : Stats.from(result.data, bigint)
     stats.handle = this
     return stats
   }
 
   /**
-   * @param {object=} [options]
+   * Synchronizes the file's data and metadata with the disk. Writes
+   * buffered by `writeBehind()` are flushed first.
+   * @see {@link https://nodejs.org/dist/latest-v16.x/docs/api/fs.html#filehandlesync}
    */
   async sync () {
     if (this.closing || this.closed) {
       throw new Error('FileHandle is not opened')
     }
+
+    const result = await ipc.send('fs.fsync', { id: this.id })
+
+    if (result.err) {
+      throw result.err
+    }
   }
 
   /**
-   * @param {object=} [options]
+   * Truncates or extends the file to `length` bytes. Writes buffered by
+   * `writeBehind()` are flushed first.
+   * @param {number=} [length = 0]
+   * @see {@link https://nodejs.org/dist/latest-v16.x/docs/api/fs.html#filehandletruncatelen}
    */
   async truncate (length) {
     if (this.closing || this.closed) {
       throw new Error('FileHandle is not opened')
     }
+
+    const result = await ipc.send('fs.ftruncate', {
+      id: this.id,
+      length: Math.max(0, Number(length) || 0)
+    })
+
+    if (result.err) {
+      throw result.err
+    }
   }
 
   /**
@@ -634,6 +1106,33 @@ export class FileHandle extends EventEmitter {
     }
   }
 
+  /**
+   * Buffers writes natively so `write()` resolves once the bytes are copied.
+   * Contiguous writes are written in batches of `highWaterMark` bytes, after
+   * `delay` milliseconds, or on `flush()` and `close()`. A failed batch
+   * rejects the next write, flush or close.
+   * @param {object=} [options]
+   * @param {number=} [options.highWaterMark = 65536] - Bytes per batch, 0 to
+   *   flush and stop buffering
+   * @param {number=} [options.delay = 10] - Milliseconds before a partial
+   *   batch is written
+   */
+  async writeBehind (options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    const result = await ipc.send('fs.writeBehind', {
+      id: this.id,
+      highWaterMark: options?.highWaterMark ?? 64 * 1024,
+      delay: options?.delay ?? 10
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+  }
+
   /**
    * Writes `length` bytes at `offset` in `buffer` to the underlying file
    * at `position`.
@@ -731,45 +1230,99 @@ export class FileHandle extends EventEmitter {
     }
 
     const signal = options?.signal
-    const stream = this.createWriteStream(options)
+    const timeout = options?.timeout
     const buffer = Buffer.from(data, options?.encoding ?? 'utf8')
-    const buffers = splitBuffer(buffer, stream.highWaterMark)
 
-    if (signal instanceof AbortSignal) {
-      if (signal.aborted) {
-        throw new AbortError(signal)
-      }
-
-      signal.addEventListener('abort', () => {
-        if (!stream.destroyed && !stream.destroying) {
-          stream.destroy(new AbortError(signal))
-        }
-      })
+    if (signal?.aborted) {
+      throw new AbortError(signal)
     }
 
-    queueMicrotask(async () => {
-      while (buffers.length) {
-        const buffer = buffers.shift()
-        if (!stream.write(buffer)) {
-          // block until drain
-          await new Promise((resolve) => stream.once('drain', resolve))
-        }
-      }
+    const result = await ipc.write('fs.writeFile', {
+      id: this.id
+    }, buffer, { signal, timeout })
 
-      stream.end(null)
-    })
+    if (result.err) {
+      throw result.err
+    }
 
-    await new Promise((resolve, reject) => {
-      stream.once('finish', resolve)
-      stream.once('close', resolve)
-      stream.once('error', reject)
-    })
+    const bytesWritten = parseInt(result.data.result) || 0
+    dc.channel('handle.write').publish({ handle: this, bytesWritten })
   }
 
   /**
+   * Writes `buffers` in order starting at `position` as a single vectored
+   * write for each batch of up to `FileHandle.MAX_IOVECS` buffers.
+   * @param {Buffer[]|TypedArray[]} buffers
+   * @param {number=} [position]
    * @param {object=} [options]
    */
-  async writev (buffers, position) {
+  async writev (buffers, position, options) {
+    if (this.closing || this.closed) {
+      throw new Error('FileHandle is not opened')
+    }
+
+    if (!Array.isArray(buffers) || !buffers.every(isBufferLike)) {
+      throw new TypeError('Expecting buffers to be an array of Buffer or TypedArray.')
+    }
+
+    if (position === null || position === undefined) {
+      position = -1
+    }
+
+    if (typeof position !== 'number') {
+      throw new TypeError(`Expecting position to be a number. Got ${typeof position}`)
+    }
+
+    const { id } = this
+    const signal = options?.signal || null
+    const timeout = options?.timeout || null
+
+    if (signal?.aborted) {
+      throw new AbortError(signal)
+    }
+
+    let bytesWritten = 0
+
+    for (let i = 0; i < buffers.length; i += FileHandle.MAX_IOVECS) {
+      const batch = buffers
+        .slice(i, i + FileHandle.MAX_IOVECS)
+        .filter((buffer) => buffer.byteLength > 0)
+
+      if (batch.length === 0) {
+        continue
+      }
+
+      const sizes = batch.map((buffer) => buffer.byteLength)
+      const body = Buffer.concat(batch.map((buffer) => Buffer.from(
+        buffer.buffer,
+        buffer.byteOffset,
+        buffer.byteLength
+      )))
+
+      const params = { id, sizes: sizes.join(','), offset: position }
+      const result = await ipc.write('fs.writev', params, body, {
+        timeout,
+        signal
+      })
+
+      if (result.err) {
+        throw result.err
+      }
+
+      const written = parseInt(result.data.result) || 0
+      bytesWritten += written
+      dc.channel('handle.write').publish({ handle: this, bytesWritten: written })
+
+      if (written < body.byteLength) {
+        break
+      }
+
+      if (position >= 0) {
+        position += written
+      }
+    }
+
+    return { bytesWritten, buffers }
   }
 }
 
@@ -1027,7 +1580,8 @@ export class DirectoryHandle extends EventEmitter {
 
     const result = await ipc.request('fs.readdir', {
       id,
-      entries
+      entries,
+      withStats: options.withStats === true
     }, options)
 
     if (result.err) {
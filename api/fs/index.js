@@ -28,6 +28,7 @@ import { isBufferLike, isFunction, noop } from '../util.js'
 import * as constants from './constants.js'
 import * as promises from './promises.js'
 import { Stats } from './stats.js'
+import { Watcher } from './watcher.js'
 import console from '../console.js'
 import ipc from '../ipc.js'
 import fds from './fds.js'
@@ -269,6 +270,35 @@ export function fstat (fd, options, callback) {
   }
 }
 
+/**
+ * Hashes the file at `path` natively, only the digest crosses the bridge.
+ * @param {string | Buffer | URL} path
+ * @param {string=} [algorithm = 'sha256'] - 'sha256', 'blake2b',
+ *   'blake2b256' or 'xxh64'
+ * @param {object=} [options]
+ * @param {string=} [options.encoding = 'hex'] - 'buffer' for a `Buffer`
+ * @param {function(err, string|Buffer)} callback
+ */
+export function hash (path, algorithm, options, callback) {
+  if (typeof algorithm === 'function') {
+    callback = algorithm
+    algorithm = undefined
+    options = {}
+  } else if (typeof options === 'function') {
+    callback = options
+    options = {}
+  }
+
+  if (typeof callback !== 'function') {
+    throw new TypeError('callback must be a function.')
+  }
+
+  promises
+    .hash(path, algorithm, options)
+    .then((digest) => callback(null, digest))
+    .catch((err) => callback(err))
+}
+
 /**
  * @ignore
  */
@@ -442,6 +472,7 @@ export function read (fd, buffer, offset, length, position, options, callback) {
  * @param {object=} [options]
  * @param {string=} [options.encoding = 'utf8']
  * @param {boolean=} [options.withFileTypes = false]
+ * @param {boolean=} [options.withStats = false]
  * @param {function(err, buffer)} callback
  */
 export function readdir (path, options, callback) {
@@ -596,16 +627,59 @@ export function stat (path, options, callback) {
     callback(null, stats)
   })
 }
+/**
+ * Computes stats for every path in `paths` with a single request.
+ * @see {@link promises.statMany}
+ * @param {Array<string | Buffer | URL>} paths
+ * @param {object=} [options]
+ * @param {boolean=} [options.bigint = false]
+ * @param {function(err, Array<Stats|Error>)} callback
+ */
+export function statMany (paths, options, callback) {
+  if (typeof options === 'function') {
+    callback = options
+    options = {}
+  }
+
+  if (typeof callback !== 'function') {
+    throw new TypeError('callback must be a function.')
+  }
+
+  promises
+    .statMany(paths, options)
+    .then((stats) => callback(null, stats))
+    .catch((err) => callback(err))
+}
+
 /**
  * @ignore
  */
 export function symlink (target, path, type, callback) {
 }
+
 /**
- * @ignore
+ * Truncates or extends the file at `path` to `length` bytes.
+ * @see {@link https://nodejs.org/dist/latest-v16.x/docs/api/fs.html#fstruncatepath-len-callback}
+ * @param {string | Buffer | URL} path
+ * @param {number=} [length = 0]
+ * @param {function(err)} callback
  */
 export function truncate (path, length, callback) {
+  if (typeof length === 'function') {
+    callback = length
+    length = 0
+  }
+
+  if (typeof callback !== 'function') {
+    throw new TypeError('callback must be a function.')
+  }
+
+  promises
+    .truncate(path, length)
+    .then(() => callback(null))
+    .catch((err) => callback(err))
 }
+
 /**
  * @ignore
  */
@@ -617,9 +691,30 @@ export function unlink (path, callback) {
 export function utimes (path, atime, mtime, callback) {
 }
 /**
- * @ignore
+ * Watches `path` for changes with native change notifications.
+ * @see {@url https://nodejs.org/dist/latest-v16.x/docs/api/fs.html#fswatchfilename-options-listener}
+ * @param {string | Buffer | URL} path
+ * @param {object=} [options]
+ * @param {boolean=} [options.recursive = false]
+ * @param {number=} [options.debounce = 50] - Milliseconds changes are
+ *   coalesced for before being emitted
+ * @param {AbortSignal=} [options.signal]
+ * @param {function(string, string)=} [listener]
+ * @return {Watcher}
  */
-export function watch (path, options, callback) {
+export function watch (path, options, listener) {
+  if (typeof options === 'function') {
+    listener = options
+    options = {}
+  }
+
+  const watcher = new Watcher(path, options)
+
+  if (typeof listener === 'function') {
+    watcher.on('change', listener)
+  }
+
+  return watcher
 }
 /**
  * @ignore
@@ -627,6 +722,34 @@ export function watch (path, options, callback) {
 export function write (fd, buffer, offset, length, position, callback) {
 }
 
+/**
+ * Durably replaces the file at `path` with `data`.
+ * @see {@link promises.writeFileAtomic}
+ * @param {string | Buffer | URL} path
+ * @param {string | Buffer | TypedArray} data
+ * @param {object=} [options]
+ * @param {string=} [options.encoding = 'utf8']
+ * @param {number=} [options.mode = 0o666]
+ * @param {number=} [options.groupCommit = 0]
+ * @param {AbortSignal=} [options.signal]
+ * @param {function(err)} callback
+ */
+export function writeFileAtomic (path, data, options, callback) {
+  if (typeof options === 'function') {
+    callback = options
+    options = {}
+  }
+
+  if (typeof callback !== 'function') {
+    throw new TypeError('callback must be a function.')
+  }
+
+  promises
+    .writeFileAtomic(path, data, options)
+    .then(() => callback(null))
+    .catch((err) => callback(err))
+}
+
 /**
  * @see {@url https://nodejs.org/dist/latest-v16.x/docs/api/fs.html#fswritefilefile-data-options-callback}
  * @param {string | Buffer | URL | number } path - filename or file descriptor
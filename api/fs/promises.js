@@ -2,8 +2,13 @@
  * @module FS.promises
  */
 import { DirectoryHandle, FileHandle } from './handle.js'
-import { Dir, sortDirectoryEntries } from './dir.js'
+import { Dir, Dirent, sortDirectoryEntries } from './dir.js'
+import { Buffer } from '../buffer.js'
+import { rand64 } from '../crypto.js'
+import { Stats, STATS_RECORD_SIZE, getStatsRecord } from './stats.js'
+import { Watcher } from './watcher.js'
 import console from '../console.js'
+import { isTypedArray } from '../util.js'
 import ipc from '../ipc.js'
 
 import * as exports from './promises.js'
@@ -81,6 +86,41 @@ export async function chown (path, uid, gid) {
 export async function copyFile (src, dst, mode) {
 }
 
+/**
+ * Hashes the file at `path` natively, streaming it on the threadpool so only
+ * the digest crosses the bridge.
+ * @param {string | Buffer | URL | FileHandle} path
+ * @param {string=} [algorithm = 'sha256'] - 'sha256', 'blake2b',
+ *   'blake2b256' or 'xxh64'
+ * @param {object=} [options]
+ * @param {string=} [options.encoding = 'hex'] - 'buffer' for a `Buffer`
+ * @return {Promise<string|Buffer>}
+ */
+export async function hash (path, algorithm, options) {
+  if (path instanceof FileHandle) {
+    return await path.hash(algorithm, options)
+  }
+
+  const result = await ipc.send('fs.hash', {
+    path: String(path),
+    algorithm: algorithm ?? 'sha256'
+  })
+
+  if (result.err) {
+    throw result.err
+  }
+
+  const { digest } = result.data
+  const encoding = options?.encoding
+
+  if (!encoding || encoding === 'hex') {
+    return digest
+  }
+
+  const buffer = Buffer.from(digest, 'hex')
+  return encoding === 'buffer' ? buffer : buffer.toString(encoding)
+}
+
 /**
  * @TODO
  * @ignore
@@ -171,6 +211,8 @@ export async function opendir (path, options) {
  * @param {object=} options
  * @param {string=} [options.encoding = 'utf8']
  * @param {boolean=} [options.withFileTypes = false]
+ * @param {boolean=} [options.withStats = false] - Include a `stats` property
+ *   on each `Dirent`, computed natively in the same request as the entries
  */
 export async function readdir (path, options) {
   options = { entries: DirectoryHandle.MAX_ENTRIES, ...options }
@@ -266,6 +308,63 @@ export async function stat (path, options) {
   })
 }
 
+/**
+ * Computes stats for every path in `paths` with a single request. Each
+ * entry in the returned array is a `Stats` instance or the `Error` for
+ * that path.
+ * @param {Array<string | Buffer | URL>} paths
+ * @param {object=} [options]
+ * @param {boolean=} [options.bigint = false]
+ * @return {Promise<Array<Stats | Error>>}
+ */
+export async function statMany (paths, options) {
+  if (!Array.isArray(paths)) {
+    throw new TypeError('Expecting paths to be an array.')
+  }
+
+  if (paths.length === 0) {
+    return []
+  }
+
+  const bigint = Boolean(options?.bigint)
+  const body = Buffer.from(JSON.stringify(paths.map((path) => String(path))))
+  const result = await ipc.write('fs.statMany', { encoding: 'binary' }, body, {
+    ...options,
+    responseType: 'arraybuffer'
+  })
+
+  if (result.err) {
+    throw result.err
+  }
+
+  if (isTypedArray(result.data) || result.data instanceof ArrayBuffer) {
+    if (result.data.byteLength !== paths.length * STATS_RECORD_SIZE) {
+      throw new TypeError('Invalid response size from \'fs.statMany\'')
+    }
+
+    return paths.map((path, i) => {
+      const record = getStatsRecord(result.data, i)
+      const code = Number(record[0])
+
+      if (code < 0) {
+        return Object.assign(new Error(`Failed to stat '${path}'`), { code })
+      }
+
+      return Stats.fromRecord(record, bigint)
+    })
+  }
+
+  return result.data.map((stats) => {
+    if (stats.err) {
+      return Object.assign(new Error(stats.err.message), {
+        code: stats.err.code
+      })
+    }
+
+    return Stats.from(stats, Boolean(options?.bigint))
+  })
+}
+
 /**
  * @TODO
  * @ignore
@@ -274,10 +373,21 @@ export async function symlink (target, path, type) {
 }
 
 /**
- * @TODO
- * @ignore
+ * Truncates or extends the file at `path` to `length` bytes.
+ * @see {@link https://nodejs.org/dist/latest-v16.x/docs/api/fs.html#fspromisestruncatepath-len}
+ * @param {string | Buffer | URL} path
+ * @param {number=} [length = 0]
+ * @return {Promise}
  */
 export async function truncate (path, length) {
+  const result = await ipc.send('fs.truncate', {
+    path: String(path),
+    length: Math.max(0, Number(length) || 0)
+  })
+
+  if (result.err) {
+    throw result.err
+  }
 }
 
 /**
@@ -295,10 +405,124 @@ export async function utimes (path, atime, mtime) {
 }
 
 /**
- * @TODO
- * @ignore
+ * Recursively walks the directory tree at `path` on the native threadpool,
+ * yielding a `Dirent` for every entry found. Entries arrive in batches of
+ * `batchSize`, so large trees only need a handful of round trips. Each
+ * `Dirent` has a `path` relative to `path` and a `depth`, starting at 1.
+ * @param {string | Buffer | URL} path
+ * @param {object=} [options]
+ * @param {number=} [options.depth = -1] - Max depth of entries, -1 for no limit
+ * @param {string[]=} [options.include] - Glob patterns of entries to yield
+ * @param {string[]=} [options.exclude] - Glob patterns of entries to skip,
+ *   excluded directories are not descended into
+ * @param {string=} [options.symlinks = 'report'] - 'report', 'follow' or 'skip'
+ * @param {boolean=} [options.withStats = false]
+ * @param {number=} [options.batchSize = 256]
+ * @param {number=} [options.concurrency = 4]
+ * @param {AbortSignal=} [options.signal]
+ * @return {AsyncGenerator<Dirent>}
+ */
+export async function * walk (path, options) {
+  const id = String(rand64())
+  const batches = []
+
+  let received = 0
+  let result = null
+  let wakeup = null
+
+  const notify = () => {
+    if (wakeup) {
+      wakeup()
+      wakeup = null
+    }
+  }
+
+  const ondata = ({ detail }) => {
+    const { data, source } = detail.params ?? {}
+
+    if (source === 'fs.walk' && data?.id === id) {
+      batches.push(data)
+      received++
+      notify()
+    }
+  }
+
+  window.addEventListener('data', ondata)
+
+  const request = ipc.request('fs.walk', {
+    id,
+    path: String(path),
+    depth: options?.depth ?? -1,
+    include: (options?.include ?? []).join('\n'),
+    exclude: (options?.exclude ?? []).join('\n'),
+    symlinks: options?.symlinks ?? 'report',
+    withStats: options?.withStats === true,
+    batchSize: options?.batchSize ?? 256,
+    concurrency: options?.concurrency ?? 4
+  }, { signal: options?.signal }).then((value) => {
+    result = value
+    notify()
+  })
+
+  try {
+    while (true) {
+      if (batches.length > 0) {
+        yield * createWalkEntries(batches.shift())
+        continue
+      }
+
+      if (result?.err) {
+        throw result.err
+      }
+
+      // batches and the reply can arrive out of order, wait for all of them
+      if (result && received >= result.data.batches) {
+        yield * createWalkEntries(result.data)
+        break
+      }
+
+      await new Promise((resolve) => { wakeup = resolve })
+    }
+  } finally {
+    if (!result) {
+      await ipc.send('fs.cancelWalk', { id })
+      await request
+    }
+
+    window.removeEventListener('data', ondata)
+  }
+}
+
+function createWalkEntries (batch) {
+  return batch.entries.map((entry) => {
+    const dirent = Dirent.from(entry)
+    dirent.path = entry.path
+    dirent.depth = entry.depth
+
+    if (entry.stats) {
+      dirent.stats = Stats.from(entry.stats)
+    }
+
+    return dirent
+  })
+}
+
+/**
+ * Watches `path` for changes, yielding `{ eventType, filename }` for each
+ * change. Changes are coalesced per path for `debounce` milliseconds and
+ * arrive in a single batch. Iteration ends when `options.signal` aborts.
+ * @see {@link https://nodejs.org/dist/latest-v16.x/docs/api/fs.html#fspromiseswatchfilename-options}
+ * @param {string | Buffer | URL} path
+ * @param {object=} [options]
+ * @param {boolean=} [options.recursive = false]
+ * @param {number=} [options.debounce = 50]
+ * @param {AbortSignal=} [options.signal]
+ * @return {AsyncGenerator<object>}
  */
-export async function watch (path, options) {
+export async function * watch (path, options) {
+  const watcher = new Watcher(path, options)
+  await watcher.ready()
+  yield * watcher
 }
 
 /**
@@ -323,5 +547,39 @@ export async function writeFile (path, data, options) {
   })
 }
 
+/**
+ * Durably replaces the file at `path` with `data`. The data is written to a
+ * temporary file next to `path`, synced and renamed over it, and then the
+ * directory is synced, so a crash leaves either the old or the new file.
+ * With `groupCommit`, concurrent writes into the same directory share a
+ * single directory sync, which makes durable writes cheap enough to use on
+ * every state change.
+ * @param {string | Buffer | URL} path
+ * @param {string|Buffer|TypedArray} data
+ * @param {object=} [options]
+ * @param {string=} [options.encoding = 'utf8']
+ * @param {number=} [options.mode = 0o666]
+ * @param {number=} [options.groupCommit = 0] - Milliseconds to wait for
+ *   other writes into the same directory before syncing it
+ * @param {AbortSignal=} [options.signal]
+ * @return {Promise<void>}
+ */
+export async function writeFileAtomic (path, data, options) {
+  if (typeof options === 'string') {
+    options = { encoding: options }
+  }
+
+  const buffer = Buffer.from(data, options?.encoding ?? 'utf8')
+  const result = await ipc.write('fs.writeFileAtomic', {
+    path: String(path),
+    mode: options?.mode ?? 0o666,
+    groupCommit: options?.groupCommit ?? 0
+  }, buffer, { signal: options?.signal })
+
+  if (result.err) {
+    throw result.err
+  }
+}
+
 export * as constants from './constants.js'
 export default exports
@@ -5,6 +5,47 @@ import * as exports from './stats.js'
 
 const isWindows = /win/i.test(os.type())
 
+/**
+ * The number of little-endian signed 64-bit fields in a binary stats record
+ * replied by the native layer when `encoding: 'binary'` is given.
+ */
+export const STATS_RECORD_FIELDS = 21
+
+/**
+ * The size in bytes of a binary stats record.
+ */
+export const STATS_RECORD_SIZE = STATS_RECORD_FIELDS * 8
+
+/**
+ * Returns a view over the `index`th binary stats record in `buffer`. The
+ * fields are: result, dev, ino, mode, nlink, uid, gid, rdev, size, blksize,
+ * blocks, flags, gen, then `tv_sec`, `tv_nsec` pairs for atim, mtim, ctim
+ * and birthtim. `result` is 0 or a negative error code.
+ * @param {ArrayBuffer|TypedArray} buffer
+ * @param {number=} [index = 0]
+ * @return {BigInt64Array}
+ */
+export function getStatsRecord (buffer, index = 0) {
+  let byteOffset = index * STATS_RECORD_SIZE
+
+  if (ArrayBuffer.isView(buffer)) {
+    byteOffset += buffer.byteOffset
+    buffer = buffer.buffer
+  }
+
+  if (byteOffset + STATS_RECORD_SIZE > buffer.byteLength) {
+    throw new RangeError('Stats record is out of bounds of buffer.')
+  }
+
+  // typed array views must be aligned to their element size
+  if (byteOffset % 8 !== 0) {
+    buffer = buffer.slice(byteOffset, byteOffset + STATS_RECORD_SIZE)
+    byteOffset = 0
+  }
+
+  return new BigInt64Array(buffer, byteOffset, STATS_RECORD_FIELDS)
+}
+
 function checkMode (mode, property) {
   if (isWindows) {
     if (
@@ -72,6 +113,33 @@ export class Stats {
     })
   }
 
+  /**
+   * Creates `Stats` from a binary stats record.
+   * @param {BigInt64Array} record
+   * @param {boolean=} [fromBigInt = false]
+   * @see {getStatsRecord}
+   */
+  static fromRecord (record, fromBigInt) {
+    const time = (offset) => ({ tv_sec: record[offset], tv_nsec: record[offset + 1] })
+
+    return this.from({
+      st_dev: record[1],
+      st_ino: record[2],
+      st_mode: record[3],
+      st_nlink: record[4],
+      st_uid: record[5],
+      st_gid: record[6],
+      st_rdev: record[7],
+      st_size: record[8],
+      st_blksize: record[9],
+      st_blocks: record[10],
+      st_atim: time(13),
+      st_mtim: time(15),
+      st_ctim: time(17),
+      st_birthtim: time(19)
+    }, fromBigInt)
+  }
+
   /**
    * `Stats` class constructor.
    * @param {object} stat
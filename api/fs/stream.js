@@ -7,6 +7,7 @@ import { AbortError } from '../errors.js'
 import * as exports from './stream.js'
 
 export const DEFAULT_STREAM_HIGH_WATER_MARK = 64 * 1024
+export const DEFAULT_STREAM_READ_AHEAD = 4
 
 /**
  * A `Readable` stream for a `FileHandle`.
@@ -35,6 +36,10 @@ export class ReadStream extends Readable {
     this.timeout = options?.timeout || undefined
     this.bytesRead = 0
     this.shouldEmitClose = options?.emitClose !== false
+    this.readAhead = typeof options?.readAhead === 'number'
+      ? Math.max(0, options.readAhead)
+      : DEFAULT_STREAM_READ_AHEAD
+    this.readingAhead = false
 
     if (this.start < 0) {
       this.start = 0
@@ -71,6 +76,15 @@ export class ReadStream extends Readable {
     return this.handle?.path || null
   }
 
+  /**
+   * Read-ahead metrics of the underlying `FileHandle`, see
+   * `FileHandle#readAhead()`.
+   * @return {Promise<object>}
+   */
+  async readAheadStats () {
+    return await this.handle.readAhead()
+  }
+
   /**
    * `true` if the stream is in a pending state.
    */
@@ -133,6 +147,22 @@ export class ReadStream extends Readable {
       ? Math.min(this.end - position, buffer.byteLength)
       : buffer.byteLength
 
+    // chunks are read natively ahead of this stream so the next one is
+    // usually resident by the time it is asked for
+    if (this.readAhead > 0 && !this.readingAhead && this.bytesRead === 0) {
+      this.readingAhead = true
+
+      try {
+        await handle.readAhead({
+          size: buffer.byteLength,
+          window: this.readAhead,
+          offset: position
+        })
+      } catch (err) {
+        this.readingAhead = false
+      }
+    }
+
     let result = null
 
     try {
@@ -181,6 +211,10 @@ export class WriteStream extends Writable {
     this.timeout = options?.timeout || undefined
     this.bytesWritten = 0
     this.shouldEmitClose = options?.emitClose !== false
+    this.writeBehind = options?.writeBehind !== false
+    this.writingBehind = false
+    this.expectedSize = Math.max(0, Number(options?.expectedSize) || 0)
+    this.preallocated = false
 
     if (this.start < 0) {
       this.start = 0
@@ -273,6 +307,28 @@ export class WriteStream extends Writable {
       return callback(null)
     }
 
+    // space is reserved without changing the file size, so a stream that
+    // ends short of `expectedSize` leaves no trailing zeros; preallocation
+    // is advisory and ignored where the file system does not support it
+    if (this.expectedSize > 0 && !this.preallocated) {
+      this.preallocated = true
+
+      try {
+        await handle.fallocate(this.start, this.expectedSize, { mode: 'keep-size' })
+      } catch (err) {}
+    }
+
+    // chunks are acknowledged once buffered natively and written in batches
+    if (this.writeBehind && !this.writingBehind) {
+      this.writingBehind = true
+
+      try {
+        await handle.writeBehind({ highWaterMark: this.highWaterMark })
+      } catch (err) {
+        this.writingBehind = false
+      }
+    }
+
     try {
       result = await handle.write(buffer, 0, buffer.length, position, {
         timeout,
@@ -292,6 +348,21 @@ export class WriteStream extends Writable {
 
     callback(null)
   }
+
+  async _final (callback) {
+    if (!this.writingBehind || !this.handle?.opened) {
+      return callback(null)
+    }
+
+    // errors of batches written behind the stream surface before 'finish'
+    try {
+      await this.handle.flush()
+    } catch (err) {
+      return callback(err)
+    }
+
+    callback(null)
+  }
 }
 
 function setHandle (stream, handle) {
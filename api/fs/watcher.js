@@ -0,0 +1,193 @@
+import { EventEmitter } from '../events.js'
+import { rand64 } from '../crypto.js'
+import ipc from '../ipc.js'
+
+/**
+ * A file system watcher backed by native change notifications. Changes are
+ * coalesced per path for `debounce` milliseconds and delivered as a single
+ * batch, so watching a large tree costs nothing while nothing changes.
+ *
+ * Emits 'change' with `(eventType, filename)` for every change of a batch,
+ * 'batch' with the whole batch, 'error' and 'close'.
+ */
+export class Watcher extends EventEmitter {
+  /**
+   * The id of this watcher.
+   * @type {bigint}
+   */
+  id = null
+
+  /**
+   * The path being watched.
+   * @type {string}
+   */
+  path = null
+
+  /**
+   * `true` once `close()` has been called.
+   * @type {boolean}
+   */
+  closed = false
+
+  #ondata = null
+  #started = null
+  #signal = null
+  #onabort = null
+
+  /**
+   * `Watcher` class constructor.
+   * @param {string} path
+   * @param {object=} [options]
+   * @param {boolean=} [options.recursive = false]
+   * @param {number=} [options.debounce = 50] - Milliseconds changes are
+   *   coalesced for before being emitted
+   * @param {AbortSignal=} [options.signal]
+   */
+  constructor (path, options) {
+    super()
+
+    this.id = rand64()
+    this.path = String(path)
+    this.#signal = options?.signal ?? null
+
+    this.#ondata = ({ detail }) => {
+      const { data, source } = detail.params ?? {}
+
+      if (source !== 'fs.watch' || data?.id !== String(this.id)) {
+        return
+      }
+
+      for (const error of data.errors ?? []) {
+        this.emit('error', Object.assign(new Error(error.message), error))
+      }
+
+      if (data.events?.length) {
+        for (const event of data.events) {
+          this.emit('change', event.type, event.path)
+        }
+
+        this.emit('batch', data.events)
+      }
+    }
+
+    if (this.#signal?.aborted) {
+      this.closed = true
+      this.#started = Promise.resolve()
+      return
+    }
+
+    this.#onabort = () => this.close()
+    this.#signal?.addEventListener('abort', this.#onabort, { once: true })
+
+    window.addEventListener('data', this.#ondata)
+
+    this.#started = ipc.send('fs.watch', {
+      id: this.id,
+      path: this.path,
+      recursive: options?.recursive === true,
+      debounce: options?.debounce ?? 50
+    }).then((result) => {
+      if (result.err) {
+        this.closed = true
+        this.#signal?.removeEventListener('abort', this.#onabort)
+        window.removeEventListener('data', this.#ondata)
+        throw result.err
+      }
+    })
+
+    // failing to start rejects `ready()` when nothing listens for errors
+    this.#started.catch((err) => {
+      if (this.listenerCount('error') > 0) {
+        this.emit('error', err)
+      }
+    })
+  }
+
+  /**
+   * Resolves once the native watcher has started, rejects if it could
+   * not be started.
+   * @return {Promise}
+   */
+  async ready () {
+    await this.#started
+  }
+
+  /**
+   * Stops watching. Changes still within the debounce window are emitted
+   * before 'close'.
+   * @return {Promise}
+   */
+  async close () {
+    if (this.closed) {
+      return
+    }
+
+    this.closed = true
+    this.#signal?.removeEventListener('abort', this.#onabort)
+
+    await this.#started
+    await ipc.send('fs.unwatch', { id: this.id })
+
+    window.removeEventListener('data', this.#ondata)
+    this.emit('close')
+  }
+
+  /**
+   * Iterates over changes as `{ eventType, filename }` objects until
+   * the watcher is closed.
+   * @return {AsyncGenerator<object>}
+   */
+  async * [Symbol.asyncIterator] () {
+    const changes = []
+    let wakeup = null
+
+    const notify = () => {
+      if (wakeup) {
+        wakeup()
+        wakeup = null
+      }
+    }
+
+    const onchange = (eventType, filename) => {
+      changes.push({ eventType, filename })
+      notify()
+    }
+
+    const onerror = (err) => {
+      changes.push(err)
+      notify()
+    }
+
+    this.on('change', onchange)
+    this.on('error', onerror)
+    this.on('close', notify)
+
+    try {
+      while (true) {
+        if (changes.length > 0) {
+          const change = changes.shift()
+
+          if (change instanceof Error) {
+            throw change
+          }
+
+          yield change
+          continue
+        }
+
+        if (this.closed) {
+          break
+        }
+
+        await new Promise((resolve) => { wakeup = resolve })
+      }
+    } finally {
+      this.off('change', onchange)
+      this.off('error', onerror)
+      this.off('close', notify)
+      await this.close()
+    }
+  }
+}
+
+export default Watcher
@@ -7,9 +7,183 @@
  * @see {@link https://github.com/socketsupply/stream-relay}
  *
  */
+import { isArrayBufferView, isFunction, noop } from './util.js'
+import { EventEmitter } from './events.js'
+import diagnostics from './diagnostics.js'
+import { Buffer } from './buffer.js'
+import { rand64 } from './crypto.js'
+import ipc from './ipc.js'
+import gc from './gc.js'
+
+import * as exports from './p2p.js'
+
 // import { createPeer } from './external/stream-relay/src/index.js'
 // import dgram from './dgram.js'
 
 // export * from './external/stream-relay/src/index.js'
 // const Peer = createPeer(dgram)
 // export { Peer }
+
+const dc = diagnostics.channels.group('p2p', [
+  'open',
+  'send',
+  'message',
+  'close'
+])
+
+function createDataListener (channel) {
+  window.addEventListener('data', ondata)
+  return ondata
+
+  function ondata ({ detail }) {
+    const { err, data, source } = detail.params
+
+    if (err && BigInt(err.id ?? 0) === channel.id) {
+      return channel.emit('error', err)
+    }
+
+    if (!data || BigInt(data.id) !== channel.id) return
+
+    if (source === 'p2p.message') {
+      const message = Buffer.from(detail.data ?? new ArrayBuffer(0))
+      channel.emit('message', message)
+      dc.channel('message').publish({ channel, buffer: message })
+    }
+  }
+}
+
+/**
+ * A reliable, ordered message channel between two UDP endpoints.
+ * Sequencing, acknowledgements, retransmission and congestion control are
+ * handled natively, so 'message' events are always whole and in order.
+ */
+export class Channel extends EventEmitter {
+  /**
+   * `Channel` class constructor.
+   * @param {object=} options
+   * @param {number=} options.port - Local port to bind to (default: 0)
+   * @param {string=} options.address - Local address to bind to (default: 0.0.0.0)
+   * @param {function=} callback - Attached as a listener for 'message' events.
+   */
+  constructor (options, callback) {
+    super()
+
+    if (isFunction(options)) {
+      callback = options
+      options = {}
+    }
+
+    this.id = rand64()
+    this.options = { port: 0, address: '0.0.0.0', ...options }
+    this.dataListener = null
+    this.state = null
+
+    if (isFunction(callback)) {
+      this.on('message', callback)
+    }
+  }
+
+  /**
+   * Binds the channel and associates it with a remote peer.
+   * @param {number} remotePort
+   * @param {string} remoteAddress
+   * @param {function=} callback
+   * @return {Promise<object>}
+   */
+  async open (remotePort, remoteAddress, callback = noop) {
+    const result = await ipc.send('p2p.open', {
+      id: this.id,
+      port: this.options.port,
+      address: this.options.address,
+      remotePort,
+      remoteAddress
+    })
+
+    if (result.err) {
+      callback(result.err)
+      this.emit('error', result.err)
+      return result
+    }
+
+    this.state = result.data
+    this.dataListener = createDataListener(this)
+    gc.ref(this)
+
+    callback(null, result.data)
+    this.emit('open', result.data)
+    dc.channel('open').publish({ channel: this, ...result.data })
+
+    return result
+  }
+
+  /**
+   * Queues a message for reliable, ordered delivery.
+   * @param {Buffer|TypedArray|string} buffer
+   * @param {function=} callback
+   * @return {Promise<object>}
+   */
+  async send (buffer, callback = noop) {
+    if (!isArrayBufferView(buffer)) {
+      buffer = Buffer.from(buffer)
+    }
+
+    const result = await ipc.write('p2p.send', { id: this.id }, buffer)
+    callback(result.err ?? null, result.data)
+    dc.channel('send').publish({ channel: this, buffer })
+    return result
+  }
+
+  /**
+   * Returns congestion control and delivery counters for this channel.
+   * @return {Promise<object>}
+   */
+  async getState () {
+    const result = await ipc.send('p2p.getState', { id: this.id })
+    if (result.err) throw result.err
+    return result.data
+  }
+
+  /**
+   * Closes the channel and its underlying socket.
+   * @param {function=} callback
+   * @return {Promise<object>}
+   */
+  async close (callback = noop) {
+    if (this.dataListener) {
+      window.removeEventListener('data', this.dataListener)
+      this.dataListener = null
+    }
+
+    const result = await ipc.send('p2p.close', { id: this.id })
+    gc.unref(this)
+
+    callback(result.err ?? null)
+    this.emit('close')
+    dc.channel('close').publish({ channel: this })
+    return result
+  }
+
+  /**
+   * Implements `gc.finalizer` for gc'd resource cleanup.
+   * @return {gc.Finalizer}
+   * @ignore
+   */
+  [gc.finalizer] (options) {
+    return {
+      args: [this.id],
+      async handle (id) {
+        await ipc.send('p2p.close', { id })
+      }
+    }
+  }
+}
+
+/**
+ * Creates a reliable datagram `Channel`.
+ * @param {object=} options
+ * @param {function=} callback
+ * @return {Channel}
+ */
+export const createChannel = (options, callback) => new Channel(options, callback)
+
+export default exports
@@ -26,6 +26,9 @@
  * @module Stream
  */
 import { EventEmitter } from './events.js'
+import { Buffer } from './buffer.js'
+import { rand64 } from './crypto.js'
+import ipc from './ipc.js'
 import * as exports from './stream.js'
 
 export default exports
@@ -967,6 +970,113 @@ export class Transform extends Duplex {
 
 export class PassThrough extends Transform {}
 
+/**
+ * A `Transform` that compresses (or decompresses) with zlib on the native
+ * threadpool, so large payloads do not block the main thread.
+ */
+export class CompressionStream extends Transform {
+  /**
+   * `CompressionStream` class constructor.
+   * @param {object=} [options]
+   * @param {string=} [options.format = 'gzip'] - 'gzip', 'deflate' or 'raw'
+   * @param {number=} [options.level = -1] - 0 to 9, -1 for the zlib default
+   * @param {boolean=} [options.decompress = false]
+   */
+  constructor (options) {
+    super(options)
+
+    this.id = rand64()
+    this.format = options?.format ?? 'gzip'
+    this.level = options?.level ?? -1
+    this.decompress = options?.decompress === true
+    this.bytesIn = 0
+    this.bytesOut = 0
+    this.created = null
+  }
+
+  async #write (data, final) {
+    if (this.created === null) {
+      this.created = ipc.send('compression.createStream', {
+        id: this.id,
+        format: this.format,
+        level: this.level,
+        decompress: this.decompress
+      })
+    }
+
+    const created = await this.created
+
+    if (created.err) {
+      throw created.err
+    }
+
+    const buffer = data === null
+      ? Buffer.alloc(0)
+      : isTypedArray(data) ? data : Buffer.from(data)
+
+    const result = await ipc.write('compression.write', {
+      id: this.id,
+      final
+    }, buffer, { responseType: 'arraybuffer' })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    this.bytesIn += buffer.byteLength
+
+    if (result.data?.byteLength) {
+      this.bytesOut += result.data.byteLength
+      return Buffer.from(result.data)
+    }
+
+    return null
+  }
+
+  _transform (data, cb) {
+    this.#write(data, false).then(
+      (output) => cb(null, output),
+      (err) => cb(err)
+    )
+  }
+
+  _flush (cb) {
+    this.#write(null, true).then(
+      (output) => cb(null, output),
+      (err) => cb(err)
+    )
+  }
+
+  _destroy (cb) {
+    if (this.created === null) {
+      return cb(null)
+    }
+
+    ipc.send('compression.destroyStream', { id: this.id }).then(
+      () => cb(null),
+      () => cb(null)
+    )
+  }
+}
+
+/**
+ * Creates a gzip (by default) `CompressionStream`.
+ * @param {object=} [options]
+ * @return {CompressionStream}
+ */
+export function createCompressionStream (options) {
+  return new CompressionStream({ ...options, decompress: false })
+}
+
+/**
+ * Creates a gunzip (by default) `CompressionStream`.
+ * @param {object=} [options]
+ * @return {CompressionStream}
+ */
+export function createDecompressionStream (options) {
+  return new CompressionStream({ ...options, decompress: true })
+}
+
 function transformAfterFlush (err, data) {
   const cb = this._transformState.afterFinal
   if (err) return cb(err)
@@ -774,6 +774,7 @@ constexpr auto gXCodeProject = R"ASCII(// !$*UTF8*$!
           "-DHOST={{host}}",
           "-DPORT={{port}}",
         );
+        OTHER_LDFLAGS = "-lz";
         PRODUCT_BUNDLE_IDENTIFIER = "{{meta_bundle_identifier}}";
         PRODUCT_NAME = "$(TARGET_NAME)";
         PROVISIONING_PROFILE_SPECIFIER = "{{ios_provisioning_specifier}}";
@@ -822,6 +823,7 @@ constexpr auto gXCodeProject = R"ASCII(// !$*UTF8*$!
         LIBRARY_SEARCH_PATHS = "$(PROJECT_DIR)/lib";
         MARKETING_VERSION = 1.0;
         ONLY_ACTIVE_ARCH = YES;
+        OTHER_LDFLAGS = "-lz";
         PRODUCT_BUNDLE_IDENTIFIER = "{{meta_bundle_identifier}}";
         PRODUCT_NAME = "$(TARGET_NAME)";
         PROVISIONING_PROFILE_SPECIFIER = "{{ios_provisioning_specifier}}";
@@ -1160,18 +1162,22 @@ LOCAL_CFLAGS +=              \
 
 LOCAL_CFLAGS += {{cflags}}
 
-LOCAL_LDLIBS := -landroid -llog
+LOCAL_LDLIBS := -landroid -llog -lz
 LOCAL_SRC_FILES =         \
   android/bridge.cc       \
   android/runtime.cc      \
   android/string_wrap.cc  \
   android/window.cc       \
   core/bluetooth.cc       \
+  core/compression.cc     \
   core/core.cc            \
   core/fs.cc              \
+  core/hash.cc            \
   core/javascript.cc      \
   core/json.cc            \
+  core/p2p.cc             \
   core/peer.cc            \
+  core/secretbox.cc       \
   core/udp.cc             \
   ipc/bridge.cc           \
   ipc/ipc.cc              \
@@ -108,6 +108,7 @@
 #include <queue>
 #include <regex>
 #include <semaphore>
+#include <set>
 #include <span>
 #include <sstream>
 #include <string>
@@ -0,0 +1,632 @@
+#include "core.hh"
+
+#if !defined(_WIN32)
+#include <zlib.h>
+#endif
+
+namespace SSC {
+  static JSON::Object getUnsupportedError (const String source) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"code", UV_ENOTSUP},
+        {"message", "Compression is not supported on this platform"}
+      }}
+    };
+  }
+
+  bool Core::Compression::isSupported () {
+  #if defined(_WIN32)
+    return false;
+  #else
+    return true;
+  #endif
+  }
+
+#if !defined(_WIN32)
+  static int getWindowBits (const String& format) {
+    if (format == "raw") return -MAX_WBITS;
+    if (format == "deflate") return MAX_WBITS;
+    return MAX_WBITS + 16;
+  }
+
+  static int getStatusError (int status) {
+    switch (status) {
+      case Z_MEM_ERROR: return UV_ENOMEM;
+      case Z_DATA_ERROR: return UV_EILSEQ;
+      case Z_NEED_DICT: return UV_EILSEQ;
+      default: return UV_EINVAL;
+    }
+  }
+#endif
+
+  struct CompressionStream {
+    using Options = Core::Compression::Options;
+    static constexpr size_t CHUNK_SIZE = Core::Compression::CHUNK_SIZE;
+
+    uint64_t id = 0;
+    bool decompress = false;
+    bool initialized = false;
+    bool ended = false;
+    bool busy = false;
+    // removed by `destroyStream()` while a step was running
+    bool destroyed = false;
+
+  #if !defined(_WIN32)
+    z_stream zs = {};
+  #endif
+
+    ~CompressionStream () {
+    #if !defined(_WIN32)
+      if (this->initialized) {
+        if (this->decompress) {
+          inflateEnd(&this->zs);
+        } else {
+          deflateEnd(&this->zs);
+        }
+      }
+    #endif
+    }
+
+    int init (bool decompress, const Options& options) {
+      this->decompress = decompress;
+
+    #if defined(_WIN32)
+      return UV_ENOTSUP;
+    #else
+      auto windowBits = getWindowBits(options.format);
+      auto level = std::min(std::max(options.level, -1), 9);
+      auto status = decompress
+        ? inflateInit2(&this->zs, windowBits)
+        : deflateInit2(&this->zs, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+
+      if (status != Z_OK) {
+        return getStatusError(status);
+      }
+
+      this->initialized = true;
+      return 0;
+    #endif
+    }
+
+    // starts over with the same options, discarding any pending state
+    int reset () {
+    #if defined(_WIN32)
+      return UV_ENOTSUP;
+    #else
+      auto status = this->decompress
+        ? inflateReset(&this->zs)
+        : deflateReset(&this->zs);
+
+      this->ended = false;
+      return status == Z_OK ? 0 : getStatusError(status);
+    #endif
+    }
+
+    /**
+     * Feeds `size` bytes and appends whatever output is ready. `final` ends
+     * a compressing stream, a decompressing stream must have reached the
+     * end of its input by then.
+     */
+    int process (
+      const char *bytes,
+      size_t size,
+      bool final,
+      Vector<char>& output,
+      size_t limit = SIZE_MAX
+    ) {
+    #if defined(_WIN32)
+      return UV_ENOTSUP;
+    #else
+      auto flush = final && !this->decompress ? Z_FINISH : Z_NO_FLUSH;
+      int status = Z_OK;
+
+      this->zs.next_in = (Bytef *) bytes;
+      this->zs.avail_in = (uInt) size;
+
+      while (!this->ended) {
+        auto offset = output.size();
+
+        if (offset >= limit) {
+          return UV_E2BIG;
+        }
+
+        output.resize(offset + CHUNK_SIZE);
+        this->zs.next_out = (Bytef *) output.data() + offset;
+        this->zs.avail_out = (uInt) CHUNK_SIZE;
+
+        status = this->decompress
+          ? ::inflate(&this->zs, flush)
+          : ::deflate(&this->zs, flush);
+
+        output.resize(offset + CHUNK_SIZE - this->zs.avail_out);
+
+        if (status == Z_STREAM_END) {
+          this->ended = true;
+          break;
+        }
+
+        // no progress is possible until more input arrives
+        if (status == Z_BUF_ERROR) {
+          break;
+        }
+
+        if (status != Z_OK) {
+          return getStatusError(status);
+        }
+
+        if (this->zs.avail_out > 0 && this->zs.avail_in == 0 && flush != Z_FINISH) {
+          break;
+        }
+      }
+
+      // the compressed input ended early
+      if (final && this->decompress && !this->ended) {
+        return UV_EOF;
+      }
+
+      return 0;
+    #endif
+    }
+  };
+
+  static int processOnce (
+    std::shared_ptr<Core::Compression::Stream>& stream,
+    bool decompress,
+    const char *bytes,
+    size_t size,
+    const Core::Compression::Options& options,
+    Vector<char>& output,
+    size_t limit
+  ) {
+    int err = 0;
+
+    if (stream == nullptr) {
+      stream = std::make_shared<Core::Compression::Stream>();
+      err = stream->init(decompress, options);
+    } else {
+      err = stream->reset();
+    }
+
+    if (err < 0) {
+      stream = nullptr;
+      return err;
+    }
+
+    return stream->process(bytes, size, true, output, limit);
+  }
+
+  int Core::Compression::deflate (
+    std::shared_ptr<Stream>& stream,
+    const char *bytes,
+    size_t size,
+    const Options& options,
+    Vector<char>& output
+  ) {
+    return processOnce(stream, false, bytes, size, options, output, SIZE_MAX);
+  }
+
+  int Core::Compression::inflate (
+    std::shared_ptr<Stream>& stream,
+    const char *bytes,
+    size_t size,
+    const Options& options,
+    Vector<char>& output,
+    size_t limit
+  ) {
+    return processOnce(stream, true, bytes, size, options, output, limit);
+  }
+
+  void Core::Compression::createStream (
+    const String seq,
+    uint64_t id,
+    bool decompress,
+    const Options options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      Lock lock(this->mutex);
+
+      if (this->streams.find(id) != this->streams.end()) {
+        auto json = JSON::Object::Entries {
+          {"source", "compression.createStream"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", UV_EEXIST},
+            {"message", "A compression stream with that id already exists"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto stream = new Stream();
+      auto err = stream->init(decompress, options);
+
+      if (err < 0) {
+        delete stream;
+
+        auto json = JSON::Object::Entries {
+          {"source", "compression.createStream"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      stream->id = id;
+      this->streams.insert_or_assign(id, stream);
+
+      auto json = JSON::Object::Entries {
+        {"source", "compression.createStream"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::Compression::destroyStream (
+    const String seq,
+    uint64_t id,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      Lock lock(this->mutex);
+
+      if (this->streams.find(id) == this->streams.end()) {
+        auto json = JSON::Object::Entries {
+          {"source", "compression.destroyStream"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"type", "NotFoundError"},
+            {"message", "No compression stream found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto stream = this->streams.at(id);
+      this->streams.erase(id);
+
+      // a step still running on the threadpool deletes the stream when done
+      if (stream->busy) {
+        stream->destroyed = true;
+      } else {
+        delete stream;
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "compression.destroyStream"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::Compression::write (
+    const String seq,
+    uint64_t id,
+    char *bytes,
+    size_t size,
+    bool final,
+    Module::Callback cb
+  ) {
+    struct Step {
+      uv_work_t req;
+      Core *core = nullptr;
+      Stream *stream = nullptr;
+      String seq;
+      Module::Callback cb;
+      Vector<char> input;
+      Vector<char> output;
+      bool final = false;
+      int result = 0;
+    };
+
+    // `bytes` belongs to the message and is gone once this call returns
+    auto input = Vector<char>(bytes, bytes + size);
+
+    this->core->dispatchEventLoop([=, this]() {
+      Lock lock(this->mutex);
+
+      if (this->streams.find(id) == this->streams.end()) {
+        auto json = JSON::Object::Entries {
+          {"source", "compression.write"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"type", "NotFoundError"},
+            {"message", "No compression stream found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto stream = this->streams.at(id);
+
+      if (stream->busy) {
+        auto json = JSON::Object::Entries {
+          {"source", "compression.write"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", UV_EBUSY},
+            {"message", "Wait for the previous write to finish"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto step = new Step();
+      step->core = this->core;
+      step->stream = stream;
+      step->seq = seq;
+      step->cb = cb;
+      step->input = std::move(input);
+      step->final = final;
+      step->req.data = step;
+      stream->busy = true;
+
+      auto loop = &this->core->eventLoop;
+      auto err = uv_queue_work(loop, &step->req, [](uv_work_t *req) {
+        auto step = (Step *) req->data;
+        step->result = step->stream->process(
+          step->input.data(),
+          step->input.size(),
+          step->final,
+          step->output
+        );
+      }, [](uv_work_t *req, int status) {
+        auto step = (Step *) req->data;
+        auto stream = step->stream;
+        auto result = status < 0 ? status : step->result;
+        auto id = stream->id;
+
+        stream->busy = false;
+
+        if (stream->destroyed) {
+          delete stream;
+        }
+
+        if (result < 0) {
+          auto json = JSON::Object::Entries {
+            {"source", "compression.write"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(id)},
+              {"code", result},
+              {"message", String(uv_strerror(result))}
+            }}
+          };
+
+          step->cb(step->seq, json, Post{});
+          delete step;
+          return;
+        }
+
+        auto size = step->output.size();
+        auto headers = Headers {{
+          {"content-type" ,"application/octet-stream"},
+          {"content-length", (uint64_t) size}
+        }};
+
+        Post post;
+        post.id = SSC::rand64();
+        post.body = step->core->fs.buffers.acquire(std::max(size, (size_t) 1));
+        post.length = size;
+        post.headers = headers.str();
+        memcpy(post.body, step->output.data(), size);
+
+        step->cb(step->seq, JSON::Object {}, post);
+        delete step;
+      });
+
+      if (err < 0) {
+        stream->busy = false;
+        delete step;
+
+        auto json = JSON::Object::Entries {
+          {"source", "compression.write"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      }
+    });
+  }
+
+  /**
+   * Compresses or decompresses a source descriptor into a target descriptor
+   * from their current positions. Each step reads `CHUNK_SIZE` bytes,
+   * processes them and writes the output on a threadpool worker, progress
+   * is emitted between steps.
+   */
+  struct Core::Compression::Pipe {
+    uv_work_t req;
+    uint64_t id = 0;
+    String seq;
+    Module::Callback cb;
+    Core *core = nullptr;
+    Stream stream;
+    FS::Descriptor *source = nullptr;
+    FS::Descriptor *target = nullptr;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    bool eof = false;
+    int result = 0;
+
+    void step ();
+    void run ();
+    void finish (int err);
+  };
+
+  void Core::Compression::Pipe::run () {
+    uv_fs_t fs;
+    Vector<char> input(CHUNK_SIZE);
+    Vector<char> output;
+    auto buffer = uv_buf_init(input.data(), (unsigned int) input.size());
+    auto result = uv_fs_read(nullptr, &fs, this->source->fd, &buffer, 1, -1, nullptr);
+    uv_fs_req_cleanup(&fs);
+
+    if (result < 0) {
+      this->result = (int) result;
+      return;
+    }
+
+    this->eof = result == 0;
+    this->bytesIn += result;
+    this->result = this->stream.process(input.data(), (size_t) result, this->eof, output);
+
+    size_t written = 0;
+
+    while (this->result == 0 && written < output.size()) {
+      buffer = uv_buf_init(output.data() + written, (unsigned int) (output.size() - written));
+      result = uv_fs_write(nullptr, &fs, this->target->fd, &buffer, 1, -1, nullptr);
+      uv_fs_req_cleanup(&fs);
+
+      if (result < 0) {
+        this->result = (int) result;
+      } else {
+        written += result;
+      }
+    }
+
+    this->bytesOut += written;
+  }
+
+  void Core::Compression::Pipe::step () {
+    auto loop = &this->core->eventLoop;
+    this->req.data = this;
+
+    auto err = uv_queue_work(loop, &this->req, [](uv_work_t *req) {
+      ((Pipe *) req->data)->run();
+    }, [](uv_work_t *req, int status) {
+      auto pipe = (Pipe *) req->data;
+
+      if (status < 0 || pipe->result < 0 || pipe->eof) {
+        return pipe->finish(status < 0 ? status : pipe->result);
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "compression.pipe"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(pipe->id)},
+          {"bytesIn", pipe->bytesIn},
+          {"bytesOut", pipe->bytesOut}
+        }}
+      };
+
+      pipe->cb("-1", json, Post{});
+      pipe->step();
+    });
+
+    if (err < 0) {
+      this->finish(err);
+    }
+  }
+
+  void Core::Compression::Pipe::finish (int err) {
+    auto json = JSON::Object {};
+
+    if (err < 0) {
+      json = JSON::Object::Entries {
+        {"source", "compression.pipe"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(this->id)},
+          {"code", err},
+          {"message", String(uv_strerror(err))}
+        }}
+      };
+    } else {
+      json = JSON::Object::Entries {
+        {"source", "compression.pipe"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(this->id)},
+          {"bytesIn", this->bytesIn},
+          {"bytesOut", this->bytesOut}
+        }}
+      };
+    }
+
+    this->cb(this->seq, json, Post{});
+    this->source->unref();
+    this->target->unref();
+    delete this;
+  }
+
+  void Core::Compression::pipe (
+    const String seq,
+    uint64_t id,
+    uint64_t sourceId,
+    uint64_t targetId,
+    bool decompress,
+    const Options options,
+    Module::Callback cb
+  ) {
+    if (!isSupported()) {
+      return cb(seq, getUnsupportedError("compression.pipe"), Post{});
+    }
+
+    this->core->dispatchEventLoop([=, this]() {
+      auto source = this->core->fs.getDescriptor(sourceId);
+      auto target = this->core->fs.getDescriptor(targetId);
+
+      if (source == nullptr || target == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "compression.pipe"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(source == nullptr ? sourceId : targetId)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto pipe = new Pipe();
+      auto err = pipe->stream.init(decompress, options);
+
+      if (err < 0) {
+        delete pipe;
+
+        auto json = JSON::Object::Entries {
+          {"source", "compression.pipe"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      pipe->id = id;
+      pipe->seq = seq;
+      pipe->cb = cb;
+      pipe->core = this->core;
+      pipe->source = source;
+      pipe->target = target;
+      source->ref();
+      target->ref();
+
+      pipe->step();
+    });
+  }
+}
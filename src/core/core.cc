@@ -93,7 +93,8 @@ namespace SSC {
     if (posts->find(id) == posts->end()) return;
     auto post = getPost(id);
 
-    if (post.body) {
+    // pooled buffers are recycled instead of freed
+    if (post.body && !this->fs.buffers.release(post.body)) {
       delete [] post.body;
     }
 
@@ -457,16 +458,8 @@ namespace SSC {
     this->core->dispatchEventLoop([=, this]() {
       // init page
       if (event == "domcontentloaded") {
-        Lock lock(this->core->fs.mutex);
-
-        for (auto const &tuple : this->core->fs.descriptors) {
-          auto desc = tuple.second;
-          if (desc != nullptr) {
-            desc->stale = true;
-          } else {
-            this->core->fs.descriptors.erase(tuple.first);
-          }
-        }
+        this->core->fs.markDescriptorsStale();
+        this->core->fs.closeWatchers();
       }
 
       auto json = JSON::Object::Entries {
@@ -764,7 +757,9 @@ namespace SSC {
 
     didLoopInit = true;
     Lock lock(loopMutex);
+    FS::configureEngine();
     uv_loop_init(&eventLoop);
+    FS::restoreEngineEnvironment();
     eventLoopAsync.data = (void *) this;
     uv_async_init(&eventLoop, &eventLoopAsync, [](uv_async_t *handle) {
       auto core = reinterpret_cast<SSC::Core  *>(handle->data);
@@ -899,23 +894,17 @@ namespace SSC {
     .invoke = [](uv_timer_t *handle) {
       auto core = reinterpret_cast<Core *>(handle->data);
       Vector<uint64_t> ids;
-      String msg = "";
-
-      Lock lock(core->fs.mutex);
-      for (auto const &tuple : core->fs.descriptors) {
-        ids.push_back(tuple.first);
-      }
 
-      for (auto const id : ids) {
+      // only descriptors marked stale on page load are visited
+      do {
         Lock lock(core->fs.mutex);
-        auto desc = core->fs.descriptors.at(id);
+        ids.swap(core->fs.staleDescriptors);
+      } while (0);
 
-        if (desc == nullptr) {
-          core->fs.descriptors.erase(id);
-          continue;
-        }
+      for (auto const id : ids) {
+        auto desc = core->fs.getDescriptor(id);
 
-        if (desc->isRetained() || !desc->isStale()) {
+        if (desc == nullptr || desc->isRetained()) {
           continue;
         }
 
@@ -925,8 +914,7 @@ namespace SSC {
           core->fs.close("", id, [](auto seq, auto msg, auto post) {});
         } else {
           // free
-          core->fs.descriptors.erase(id);
-          delete desc;
+          core->fs.removeDescriptor(id);
         }
       }
     }
@@ -39,6 +39,8 @@
 #pragma comment(lib, "uv_a.lib")
 #endif
 
+#include "hash.hh"
+#include "secretbox.hh"
 #include "json.hh"
 #include "runtime-preload.hh"
 
@@ -66,6 +68,7 @@ namespace SSC {
 
   // forward
   class Core;
+  struct CompressionStream;
 
   class Headers {
     public:
@@ -191,6 +194,7 @@ namespace SSC {
         using Callback = std::function<void(int, Post)>;
         Callback cb;
         Peer *peer = nullptr;
+        size_t size = 0;
         RequestContext (Callback cb) { this->cb = cb; }
       };
 
@@ -200,6 +204,19 @@ namespace SSC {
         const struct sockaddr*
       )>;
 
+      struct QueuedSend {
+        std::shared_ptr<Vector<char>> bytes;
+        int port = 0;
+        String address = "";
+        RequestContext::Callback cb = nullptr;
+      };
+
+      // default amount of queued bytes after which senders should wait
+      static constexpr size_t DEFAULT_HIGH_WATER_MARK = 1024 * 1024;
+
+      // smallest pacing burst, anything less could stall a full sized datagram
+      static constexpr uint64_t MIN_PACING_BURST = 64 * 1024;
+
       // uv handles
       union {
         uv_udp_t udp;
@@ -222,9 +239,52 @@ namespace SSC {
         struct {
           bool reuseAddr = false;
           bool ipv6Only = false; // @TODO
+          // raw deflate datagram payloads, both ends must agree
+          bool compress = false;
         } udp;
       } options;
 
+      // token bucket pacing for outgoing datagrams, disabled when `rate` is 0
+      struct {
+        uint64_t rate = 0; // in bytes per second
+        uint64_t burst = 0; // in bytes
+        size_t highWaterMark = DEFAULT_HIGH_WATER_MARK; // in bytes
+        size_t queuedBytes = 0;
+        double tokens = 0;
+        uint64_t refilledAt = 0;
+        Queue<QueuedSend> queue;
+        uv_timer_t *timer = nullptr;
+        std::function<void()> ondrain = nullptr;
+      } pacing;
+
+      // datagrams are sealed as the nonce followed by a secretbox once a key
+      // is installed with `udp.setKey`, and opened before delivery
+      struct {
+        bool enabled = false;
+        unsigned char key[Secretbox::KEY_SIZE] = {0};
+      } encryption;
+
+      // zlib streams for `udp.compress`, reset between datagrams rather
+      // than set up again for each one, guarded by `mutex`
+      struct {
+        std::shared_ptr<CompressionStream> deflate = nullptr;
+        std::shared_ptr<CompressionStream> inflate = nullptr;
+      } compression;
+
+      // updated on the event loop thread, safe to read from any thread
+      struct {
+        std::atomic<uint64_t> packetsIn = 0;
+        std::atomic<uint64_t> packetsOut = 0;
+        std::atomic<uint64_t> bytesIn = 0;
+        std::atomic<uint64_t> bytesOut = 0;
+        std::atomic<uint64_t> sendErrors = 0;
+        std::atomic<uint64_t> eagain = 0;
+        // compressed datagrams that failed to inflate
+        std::atomic<uint64_t> inflateErrors = 0;
+        // datagrams that were not sealed with the installed key
+        std::atomic<uint64_t> decryptErrors = 0;
+      } stats;
+
       // peer state
       LocalPeerInfo local;
       RemotePeerInfo remote;
@@ -255,6 +315,14 @@ namespace SSC {
       bool isClosed ();
       bool isConnected ();
       bool isPaused ();
+      bool isPaced ();
+      bool isWritable ();
+      void setPacing (uint64_t rate, uint64_t burst, size_t highWaterMark);
+      void flush ();
+      // kernel receive queue drops by socket inode, read once per stats call
+      using ReceiveQueueDrops = std::map<uint64_t, uint64_t>;
+      static ReceiveQueueDrops readReceiveQueueDrops ();
+      uint64_t getReceiveQueueDrops (const ReceiveQueueDrops& drops);
       int bind ();
       int bind (String address, int port);
       int bind (String address, int port, bool reuseAddr);
@@ -268,6 +336,14 @@ namespace SSC {
         const String address,
         Peer::RequestContext::Callback cb
       );
+      void sendBatch (
+        const char *buf,
+        const Vector<size_t>& sizes,
+        int port,
+        const String address,
+        Peer::RequestContext::Callback cb
+      );
+      void setKey (const unsigned char *key);
       int recvstart ();
       int recvstart (UDPReceiveCallback onrecv);
       int recvstop ();
@@ -357,9 +433,82 @@ namespace SSC {
           }
       };
 
+      class Compression : public Module {
+        public:
+          // output is produced in steps of this many bytes, descriptors
+          // are read in steps of this many bytes
+          static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+          struct Options {
+            // "gzip", "deflate" (zlib wrapper) or "raw"
+            String format = "gzip";
+            // 0 to 9, -1 for the zlib default
+            int level = -1;
+          };
+
+          // a zlib stream fed in steps from JavaScript, see compression.cc
+          using Stream = CompressionStream;
+          // a descriptor compressed into another one, see compression.cc
+          struct Pipe;
+
+          std::map<uint64_t, Stream*> streams;
+          Mutex mutex;
+
+          Compression (auto core) : Module(core) {}
+
+          // zlib is not available on Windows
+          static bool isSupported ();
+
+          // one-shot helpers run on the calling thread, `stream` is created
+          // on first use and reset on the next, `limit` bounds the output
+          // so a small input cannot inflate without bound
+          static int deflate (
+            std::shared_ptr<Stream>& stream,
+            const char *bytes,
+            size_t size,
+            const Options& options,
+            Vector<char>& output
+          );
+          static int inflate (
+            std::shared_ptr<Stream>& stream,
+            const char *bytes,
+            size_t size,
+            const Options& options,
+            Vector<char>& output,
+            size_t limit
+          );
+
+          void createStream (
+            const String seq,
+            uint64_t id,
+            bool decompress,
+            const Options options,
+            Module::Callback cb
+          );
+          void destroyStream (const String seq, uint64_t id, Module::Callback cb);
+          void pipe (
+            const String seq,
+            uint64_t id,
+            uint64_t sourceId,
+            uint64_t targetId,
+            bool decompress,
+            const Options options,
+            Module::Callback cb
+          );
+          void write (
+            const String seq,
+            uint64_t id,
+            char *bytes,
+            size_t size,
+            bool final,
+            Module::Callback cb
+          );
+      };
+
       class Diagnostics : public Module {
         public:
           Diagnostics (auto core) : Module(core) {}
+          void query (const String seq, Module::Callback cb);
       };
 
       class DNS : public Module {
@@ -382,8 +531,33 @@ namespace SSC {
 
       class FS : public Module {
         public:
+          // max buffers accepted by a single `readv()` or `writev()` request
+          static constexpr size_t MAX_IOVECS = 16;
+
+          // "io_uring" when `SSC_FS_ENGINE=io_uring` or `UV_USE_IO_URING`
+          // asks for it on Linux, "threadpool" when `UV_USE_IO_URING` opts
+          // out, otherwise "default". libuv may still fall back to the
+          // threadpool, see `configureEngine()`
+          static String getRequestedEngine ();
+          static void configureEngine ();
+          // unsets what `configureEngine()` set once the loop has read it
+          static void restoreEngineEnvironment ();
+
           FS (auto core) : Module(core) {}
 
+          // reads issued ahead of a sequential reader, see fs.cc
+          struct ReadAhead;
+          // writes buffered and flushed in batches, see fs.cc
+          struct WriteBehind;
+
+          // a read-only mapping of a whole file, unmapped once the
+          // descriptor and every reply lent a range of it have let go
+          struct Mapping {
+            char *bytes = nullptr;
+            size_t size = 0;
+            ~Mapping ();
+          };
+
           struct Descriptor {
             uint64_t id;
             std::atomic<bool> retained = false;
@@ -391,24 +565,141 @@ namespace SSC {
             Mutex mutex;
             uv_dir_t *dir = nullptr;
             uv_file fd = 0;
+            String path;
             Core *core;
 
+            // read-only mapping of the whole file, see `FS::mmap()`
+            std::shared_ptr<Mapping> mapping = nullptr;
+
+            // see `FS::readAhead()` and `FS::writeBehind()`
+            ReadAhead *readAhead = nullptr;
+            WriteBehind *writeBehind = nullptr;
+
+            // digest of the bytes written so far, see `FS::hashWrites()`
+            Hash::Hasher *hasher = nullptr;
+            uint64_t hashedBytes = 0;
+            // where the next hashed write has to start, -1 for the current
+            // position. A write anywhere else makes the digest unavailable
+            int64_t hashOffset = -1;
+            bool hashContiguous = true;
+
+            // held by the descriptor table and by each request in flight,
+            // the descriptor is deleted when the last reference is dropped
+            std::atomic<int> refs = 0;
+
             Descriptor (Core *core, uint64_t id);
+            ~Descriptor ();
             bool isDirectory ();
             bool isFile ();
+            bool isMapped ();
             bool isRetained ();
             bool isStale ();
+            int map (const String advice);
+            void unmap ();
+            void hashWritten (const uv_buf_t *buffers, size_t count, size_t size, int64_t offset);
+            void ref ();
+            void unref ();
           };
 
+          /**
+           * A slab of descriptors addressed by (index, generation) handles.
+           * Slots live in fixed pages that never move, so lookups are lock
+           * free. Removing a descriptor bumps the generation of its slot and
+           * puts the slot on a free list. The 64-bit ids chosen by
+           * JavaScript resolve to handles through an open addressed index
+           * that readers probe without locking and writers replace under
+           * `mutex` when it needs to grow.
+           */
+          class DescriptorTable {
+            public:
+              static constexpr size_t PAGE_SIZE = 1024;
+              static constexpr size_t MAX_PAGES = 256;
+              static constexpr size_t MIN_INDEX_CAPACITY = 64;
+
+              struct Slot {
+                std::atomic<Descriptor*> desc = nullptr;
+                std::atomic<uint32_t> generation = 1;
+              };
+
+              struct IndexEntry {
+                std::atomic<uint64_t> id = 0;
+                // 0 when empty or removed
+                std::atomic<uint64_t> handle = 0;
+              };
+
+              struct Index {
+                IndexEntry *entries = nullptr;
+                size_t capacity = 0;
+                // entries with an id, including removed ones
+                size_t used = 0;
+              };
+
+              Mutex mutex;
+
+              DescriptorTable ();
+              ~DescriptorTable ();
+
+              // descriptors are deleted on the event loop, so the pointer
+              // is only safe to use there and no reference is taken
+              Descriptor* get (uint64_t id);
+              uint64_t getHandle (uint64_t id);
+              Descriptor* resolve (uint64_t handle);
+              uint64_t insert (Descriptor *desc);
+              Descriptor* remove (uint64_t id);
+              Vector<Descriptor*> snapshot ();
+              size_t size ();
+
+            private:
+              std::atomic<Slot*> pages[MAX_PAGES] = {};
+              std::atomic<Index*> index = nullptr;
+              Vector<Index*> retired;
+              Vector<uint32_t> free;
+              std::atomic<size_t> count = 0;
+              uint32_t next = 0;
+
+              void setIndexEntry (Index *index, uint64_t id, uint64_t handle);
+          };
+
+          /**
+           * Free lists of request context storage keyed by size, so every
+           * operation type reuses contexts of its own size. Also tracks the
+           * number and size of contexts in flight for diagnostics.
+           */
+          struct RequestContextPool {
+            static constexpr size_t MAX_FREE_CONTEXTS_PER_SIZE = 64;
+
+            Mutex mutex;
+            std::map<size_t, Vector<void*>> free;
+            std::atomic<size_t> inFlight = 0;
+            std::atomic<size_t> inFlightBytes = 0;
+
+            ~RequestContextPool ();
+            void* acquire (size_t size);
+            void release (void *ptr, size_t size);
+            size_t pooled ();
+          };
+
+          static RequestContextPool requestContexts;
+
+          /**
+           * Context for a single `uv_fs_*` request. Storage comes from
+           * `requestContexts` and is sized for the (derived) context type.
+           */
           struct RequestContext : Module::RequestContext {
-            uint64_t id;
             Descriptor *desc = nullptr;
             uv_fs_t req;
-            uv_buf_t iov[16];
-            // 256 which corresponds to DirectoryHandle.MAX_BUFFER_SIZE
-            uv_dirent_t dirents[256];
+            // `read()` and `write()` need one buffer, whole file requests two
+            uv_buf_t buffers[2] = {};
+            uv_buf_t *iov = buffers;
             int offset = 0;
             int result = 0;
+            // include batched stats for each entry in `readdir()` replies
+            bool withStats = false;
+            // reply with binary stats records instead of JSON
+            bool binary = false;
+            // for requests that span multiple `uv_fs_*` calls
+            size_t size = 0;
+            size_t bytes = 0;
 
             RequestContext () = default;
             RequestContext (Descriptor *desc)
@@ -416,29 +707,139 @@ namespace SSC {
             RequestContext (String seq, Callback cb)
               : RequestContext(nullptr, seq, cb) {}
             RequestContext (Descriptor *desc, String seq, Callback cb) {
-              this->id = SSC::rand64();
               this->cb = cb;
               this->seq = seq;
               this->desc = desc;
               this->req.data = (void *) this;
+
+              if (desc != nullptr) {
+                desc->ref();
+              }
             }
 
-            ~RequestContext () {
+            virtual ~RequestContext () {
               uv_fs_req_cleanup(&this->req);
+
+              if (this->desc != nullptr) {
+                this->desc->unref();
+              }
             }
 
+            static void* operator new (size_t size);
+            static void operator delete (void *ptr, size_t size);
+
             void setBuffer (int index, size_t len, char *base);
-            void freeBuffer (int index);
             char* getBuffer (int index);
             size_t getBufferSize (int index);
           };
 
-          std::map<uint64_t, Descriptor*> descriptors;
+          // context for `writev()` with up to `MAX_IOVECS` buffers
+          struct VectoredRequestContext : RequestContext {
+            uv_buf_t vectors[MAX_IOVECS] = {};
+
+            VectoredRequestContext (Descriptor *desc, String seq, Callback cb)
+              : RequestContext(desc, seq, cb)
+            {
+              this->iov = this->vectors;
+            }
+          };
+
+          // context for `readdir()`
+          struct DirectoryRequestContext : RequestContext {
+            // 256 which corresponds to DirectoryHandle.MAX_BUFFER_SIZE
+            uv_dirent_t dirents[256];
+
+            DirectoryRequestContext (Descriptor *desc, String seq, Callback cb)
+              : RequestContext(desc, seq, cb) {}
+          };
+
+          /**
+           * A size-classed pool of response buffers. Buffers are never
+           * zero-filled and are recycled once the response that carried
+           * them has been consumed, see `Core::removePost()`.
+           */
+          struct BufferPool {
+            static constexpr size_t MIN_SIZE_CLASS = 4 * 1024;
+            static constexpr size_t MAX_SIZE_CLASS = 4 * 1024 * 1024;
+            static constexpr size_t MAX_FREE_BUFFERS_PER_CLASS = 8;
+
+            Mutex mutex;
+            std::map<size_t, Vector<char*>> free;
+            std::map<char*, size_t> acquired;
+
+            // ranges of file mappings lent to replies, each keeps its
+            // mapping alive until the reply is released
+            std::multimap<char*, std::shared_ptr<Mapping>> lent;
+
+            ~BufferPool ();
+            char* acquire (size_t size);
+            void lend (char *bytes, std::shared_ptr<Mapping> mapping);
+            bool release (char *bytes);
+          };
+
+          struct WalkOptions {
+            // max depth of reported entries, -1 for no limit
+            int maxDepth = -1;
+            // glob patterns, a pattern without a '/' matches the entry name
+            Vector<String> include;
+            Vector<String> exclude;
+            // "report" symbolic links as entries, "follow" or "skip" them
+            String symlinks = "report";
+            bool withStats = false;
+            size_t batchSize = 256;
+            size_t concurrency = 4;
+          };
+
+          // state for an in-flight `walk()`, see fs.cc
+          struct Walker;
+
+          struct WatchOptions {
+            // watch subdirectories, inotify needs a watch per directory
+            bool recursive = false;
+            // milliseconds changes are coalesced for before being emitted
+            uint64_t debounce = 50;
+          };
+
+          // state for an active `watch()`, see fs.cc
+          struct Watcher;
+
+          // directory syncs shared by `writeFileAtomic()`, see fs.cc
+          struct GroupCommit;
+
+          struct SendToPeerOptions {
+            int64_t offset = 0;
+            // bytes to send, -1 to send until the end of the file
+            int64_t length = -1;
+            // destination of datagrams for peers that are not connected
+            int port = 0;
+            String address = "";
+            // bytes per datagram, under the IPv6 minimum MTU by default
+            size_t chunkSize = 1200;
+            // datagrams in flight, further reads wait for sends to complete
+            size_t window = 16;
+            // milliseconds between progress events, 0 for none
+            uint64_t progressInterval = 100;
+          };
+
+          // state for an in-flight `sendToPeer()`, see fs.cc
+          struct Transfer;
+
+          DescriptorTable descriptors;
+          // ids of descriptors marked stale on page load, see `releaseWeakDescriptors`
+          Vector<uint64_t> staleDescriptors;
+          std::map<uint64_t, Walker*> walkers;
+          std::map<uint64_t, Watcher*> watchers;
+          std::map<String, GroupCommit*> commits;
+          std::map<uint64_t, Transfer*> transfers;
+          BufferPool buffers;
           Mutex mutex;
 
           Descriptor * getDescriptor (uint64_t id);
+          bool insertDescriptor (Descriptor *desc);
           void removeDescriptor (uint64_t id);
           bool hasDescriptor (uint64_t id);
+          void markDescriptorsStale ();
+          void closeWatchers ();
 
           void constants (const String seq, Module::Callback cb);
           void access (
@@ -447,6 +848,12 @@ namespace SSC {
             int mode,
             Module::Callback cb
           );
+          void cancelSendToPeer (
+            const String seq,
+            uint64_t transferId,
+            Module::Callback cb
+          );
+          void cancelWalk (const String seq, uint64_t id, Module::Callback cb);
           void chmod (
             const String seq,
             const String path,
@@ -473,15 +880,58 @@ namespace SSC {
             bool preserveRetained,
             Module::Callback cb
           );
-          void fstat (const String seq, uint64_t id, Module::Callback cb);
+          void fhash (
+            const String seq,
+            uint64_t id,
+            const String algorithm,
+            Module::Callback cb
+          );
+          void digest (const String seq, uint64_t id, Module::Callback cb);
+          void fallocate (
+            const String seq,
+            uint64_t id,
+            int64_t offset,
+            int64_t length,
+            const String mode,
+            Module::Callback cb
+          );
+          void flush (
+            const String seq,
+            uint64_t id,
+            Module::Callback cb
+          );
+          void fsync (
+            const String seq,
+            uint64_t id,
+            bool datasync,
+            Module::Callback cb
+          );
+          void fstat (
+            const String seq,
+            uint64_t id,
+            bool binary,
+            Module::Callback cb
+          );
           void getOpenDescriptors (const String seq, Module::Callback cb);
-          void lstat (const String seq, const String path, Module::Callback cb);
+          void lstat (
+            const String seq,
+            const String path,
+            bool binary,
+            Module::Callback cb
+          );
           void mkdir (
             const String seq,
             const String path,
             int mode,
             Module::Callback cb
           );
+          void mmap (
+            const String seq,
+            uint64_t id,
+            const String advice,
+            Module::Callback cb
+          );
+          void munmap (const String seq, uint64_t id, Module::Callback cb);
           void open (
             const String seq,
             uint64_t id,
@@ -503,12 +953,22 @@ namespace SSC {
             size_t offset,
             Module::Callback cb
           );
+          void readAhead (
+            const String seq,
+            uint64_t id,
+            size_t size,
+            int window,
+            int64_t offset,
+            Module::Callback cb
+          );
           void readdir (
             const String seq,
             uint64_t id,
             size_t entries,
+            bool withStats,
             Module::Callback cb
           );
+          void readFile (const String seq, uint64_t id, Module::Callback cb);
           void retainOpenDescriptor (
             const String seq,
             uint64_t id,
@@ -525,9 +985,48 @@ namespace SSC {
             const String path,
             Module::Callback cb
           );
+          void hash (
+            const String seq,
+            const String path,
+            const String algorithm,
+            Module::Callback cb
+          );
+          void hashWrites (
+            const String seq,
+            uint64_t id,
+            const String algorithm,
+            Module::Callback cb
+          );
+          void sendToPeer (
+            const String seq,
+            uint64_t id,
+            uint64_t transferId,
+            uint64_t peerId,
+            const SendToPeerOptions options,
+            Module::Callback cb
+          );
           void stat (
             const String seq,
             const String path,
+            bool binary,
+            Module::Callback cb
+          );
+          void statMany (
+            const String seq,
+            const Vector<String> paths,
+            bool binary,
+            Module::Callback cb
+          );
+          void ftruncate (
+            const String seq,
+            uint64_t id,
+            int64_t length,
+            Module::Callback cb
+          );
+          void truncate (
+            const String seq,
+            const String path,
+            int64_t length,
             Module::Callback cb
           );
           void unlink (
@@ -535,6 +1034,25 @@ namespace SSC {
             const String path,
             Module::Callback cb
           );
+          void unwatch (
+            const String seq,
+            uint64_t id,
+            Module::Callback cb
+          );
+          void walk (
+            const String seq,
+            uint64_t id,
+            const String path,
+            const WalkOptions options,
+            Module::Callback cb
+          );
+          void watch (
+            const String seq,
+            uint64_t id,
+            const String path,
+            const WatchOptions options,
+            Module::Callback cb
+          );
           void write (
             const String seq,
             uint64_t id,
@@ -543,6 +1061,37 @@ namespace SSC {
             size_t offset,
             Module::Callback cb
           );
+          void writeBehind (
+            const String seq,
+            uint64_t id,
+            size_t highWaterMark,
+            uint64_t delay,
+            Module::Callback cb
+          );
+          void writeFile (
+            const String seq,
+            uint64_t id,
+            char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void writeFileAtomic (
+            const String seq,
+            const String path,
+            char *bytes,
+            size_t size,
+            int mode,
+            uint64_t groupCommit,
+            Module::Callback cb
+          );
+          void writev (
+            const String seq,
+            uint64_t id,
+            char *bytes,
+            const Vector<size_t> sizes,
+            int64_t offset,
+            Module::Callback cb
+          );
       };
 
       class OS : public Module {
@@ -577,6 +1126,124 @@ namespace SSC {
           );
       };
 
+      class P2P : public Module {
+        public:
+          // fragments larger than this are split across multiple datagrams
+          static constexpr size_t MAX_PAYLOAD_SIZE = 1200;
+          // max distance ahead of the next expected sequence we buffer
+          static constexpr uint64_t MAX_RECEIVE_WINDOW = 4096;
+          static constexpr uint64_t INITIAL_RTO = 1000; // in milliseconds
+          static constexpr uint64_t MIN_RTO = 200; // in milliseconds
+          static constexpr uint64_t MAX_RTO = 10000; // in milliseconds
+          static constexpr double INITIAL_CWND = 4; // in packets
+          static constexpr double MAX_CWND = 1024; // in packets
+          // packets queued behind the congestion window before sends fail
+          static constexpr size_t MAX_PENDING_PACKETS = 4096;
+          // the largest message a sender can enqueue, reassembly stops here
+          static constexpr size_t MAX_MESSAGE_SIZE = MAX_PENDING_PACKETS * MAX_PAYLOAD_SIZE;
+
+          P2P (auto core) : Module(core) {}
+
+          struct OpenOptions {
+            String address = "0.0.0.0";
+            int port = 0;
+            String remoteAddress = "";
+            int remotePort = 0;
+          };
+
+          struct Segment {
+            std::shared_ptr<Vector<char>> packet;
+            uint64_t sentAt = 0;
+            int transmissions = 0;
+            int missed = 0;
+            bool sacked = false;
+            // presumed lost and waiting for the window to retransmit
+            bool lost = false;
+          };
+
+          /**
+           * A reliable, ordered message channel over a connected UDP `Peer`.
+           * Sequencing, selective acks, retransmission and congestion control
+           * all happen on the core event loop so only whole, ordered messages
+           * are delivered to the WebView.
+           */
+          struct Channel {
+            using ReceiveCallback = std::function<void(char*, size_t)>;
+
+            uint64_t id = 0;
+            Core *core = nullptr;
+            Peer *peer = nullptr;
+            uv_timer_t timer;
+            ReceiveCallback onmessage = nullptr;
+
+            // sender state
+            uint64_t nextSeq = 0;
+            uint64_t recoverySeq = 0;
+            std::map<uint64_t, Segment> inflight;
+            Queue<std::shared_ptr<Vector<char>>> pending;
+
+            // receiver state
+            uint64_t recvNext = 0;
+            std::map<uint64_t, Vector<char>> reorder;
+            Vector<char> message;
+            // skipping the fragments of a message over `MAX_MESSAGE_SIZE`
+            bool discarding = false;
+
+            // congestion control + pacing
+            double cwnd = INITIAL_CWND;
+            double ssthresh = MAX_CWND;
+            double srtt = 0;
+            double rttvar = 0;
+            uint64_t rto = INITIAL_RTO;
+            double nextSendTime = 0;
+
+            // counters
+            uint64_t packetsSent = 0;
+            uint64_t packetsReceived = 0;
+            uint64_t retransmits = 0;
+            uint64_t delivered = 0;
+            uint64_t dropped = 0;
+
+            Channel (Core *core, uint64_t id, Peer *peer);
+            int enqueue (const char *bytes, size_t size);
+            size_t outstanding () const;
+            void receive (const char *bytes, size_t size);
+            void flush ();
+            void schedule ();
+            void onack (uint64_t ack, uint64_t sack);
+            void ontimeout ();
+            void sample (uint64_t rtt);
+            void transmit (uint64_t seq, Segment& segment);
+            void sendAck ();
+            void close (std::function<void()> onclose);
+            void destroy ();
+          };
+
+          std::map<uint64_t, Channel*> channels;
+          Mutex mutex;
+
+          Channel* getChannel (uint64_t id);
+          bool hasChannel (uint64_t id);
+          void removeChannel (uint64_t id);
+          void destroyChannel (uint64_t id);
+
+          void close (const String seq, uint64_t id, Module::Callback cb);
+          void getState (const String seq, uint64_t id, Module::Callback cb);
+          void open (
+            const String seq,
+            uint64_t id,
+            OpenOptions options,
+            Module::Callback cb
+          );
+          void send (
+            const String seq,
+            uint64_t id,
+            char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+      };
+
       class Platform : public Module {
         public:
           Platform (auto core) : Module(core) {}
@@ -607,11 +1274,19 @@ namespace SSC {
             String address;
             int port;
             bool reuseAddr = false;
+            bool compress = false;
+            uint64_t rate = 0;
+            uint64_t burst = 0;
+            size_t highWaterMark = 0;
           };
 
           struct ConnectOptions {
             String address;
             int port;
+            bool compress = false;
+            uint64_t rate = 0;
+            uint64_t burst = 0;
+            size_t highWaterMark = 0;
           };
 
           struct SendOptions {
@@ -620,6 +1295,8 @@ namespace SSC {
             char *bytes = nullptr;
             size_t size = 0;
             bool ephemeral = false;
+            // datagram sizes `bytes` is split into for a `udp.sendBatch`
+            Vector<size_t> sizes;
           };
 
           void bind (
@@ -639,6 +1316,8 @@ namespace SSC {
           void getPeerName (const String seq, uint64_t id, Module::Callback cb);
           void getSockName (const String seq, uint64_t id, Module::Callback cb);
           void getState (const String seq, uint64_t id,  Module::Callback cb);
+          void getStats (const String seq, uint64_t id, Module::Callback cb);
+          void getAllStats (const String seq, Module::Callback cb);
           void readStart (const String seq, uint64_t id, Module::Callback cb);
           void readStop (const String seq, uint64_t id, Module::Callback cb);
           void send (
@@ -647,12 +1326,20 @@ namespace SSC {
             SendOptions options,
             Module::Callback cb
           );
+          void setKey (
+            const String seq,
+            uint64_t id,
+            const Vector<unsigned char> key,
+            Module::Callback cb
+          );
       };
 
+      Compression compression;
       Diagnostics diagnostics;
       DNS dns;
       FS fs;
       OS os;
+      P2P p2p;
       Platform platform;
       UDP udp;
 
@@ -690,10 +1377,12 @@ namespace SSC {
 #endif
 
       Core () :
+        compression(this),
         diagnostics(this),
         dns(this),
         fs(this),
         os(this),
+        p2p(this),
         platform(this),
         udp(this)
       {
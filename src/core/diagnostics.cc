@@ -2,4 +2,34 @@
 #include "json.hh"
 
 namespace SSC {
+  void Core::Diagnostics::query (const String seq, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto& fs = this->core->fs;
+      size_t descriptors = fs.descriptors.size();
+      size_t buffers = 0;
+
+      do {
+        Lock lock(fs.buffers.mutex);
+        buffers = fs.buffers.acquired.size();
+      } while (0);
+
+      auto json = JSON::Object::Entries {
+        {"source", "diagnostics.query"},
+        {"data", JSON::Object::Entries {
+          {"fs", JSON::Object::Entries {
+            {"requestedEngine", FS::getRequestedEngine()},
+            {"descriptors", descriptors},
+            {"buffers", buffers},
+            {"requests", JSON::Object::Entries {
+              {"inFlight", fs.requestContexts.inFlight.load()},
+              {"bytes", fs.requestContexts.inFlightBytes.load()},
+              {"pooled", fs.requestContexts.pooled()}
+            }}
+          }}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
 }
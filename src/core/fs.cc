@@ -1,5 +1,10 @@
 #include "core.hh"
 
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
+
 namespace SSC {
   #define SET_CONSTANT(c) constants[#c] = (c);
   static std::map<String, int32_t> getFSConstantsMap () {
@@ -169,10 +174,8 @@ namespace SSC {
   }
   #undef SET_CONSTANT
 
-  JSON::Object getStatsJSON (const String& source, uv_stat_t* stats) {
+  JSON::Object getStatsDataJSON (uv_stat_t* stats) {
     return JSON::Object::Entries {
-      {"source", source},
-      {"data", JSON::Object::Entries {
         {"st_dev", std::to_string(stats->st_dev)},
         {"st_mode", std::to_string(stats->st_mode)},
         {"st_nlink", std::to_string(stats->st_nlink)},
@@ -201,270 +204,988 @@ namespace SSC {
           {"tv_sec", std::to_string(stats->st_birthtim.tv_sec)},
           {"tv_nsec", std::to_string(stats->st_birthtim.tv_nsec)}
         }}
-      }}
     };
   }
 
-  void Core::FS::RequestContext::setBuffer (int index, size_t len, char *base) {
-    this->iov[index].base = base;
-    this->iov[index].len = len;
+  JSON::Object getStatsJSON (const String& source, uv_stat_t* stats) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"data", getStatsDataJSON(stats)}
+    };
   }
 
-  void Core::FS::RequestContext::freeBuffer (int index) {
-    if (this->iov[index].base != nullptr) {
-      delete [] (char *) this->iov[index].base;
-      this->iov[index].base = nullptr;
+  // number of 64-bit fields in a binary stats record, see `writeStatsRecord()`
+  static constexpr size_t STATS_RECORD_FIELDS = 21;
+  static constexpr size_t STATS_RECORD_SIZE = STATS_RECORD_FIELDS * sizeof(int64_t);
+
+  /**
+   * Writes `stats` as a fixed-layout record of little-endian signed 64-bit
+   * fields: result, dev, ino, mode, nlink, uid, gid, rdev, size, blksize,
+   * blocks, flags, gen, followed by `tv_sec` and `tv_nsec` pairs for atim,
+   * mtim, ctim and birthtim. `result` is 0 or a negative error code in
+   * which case every other field is 0.
+   */
+  static void writeStatsRecord (char *bytes, int result, uv_stat_t *stats) {
+    int64_t fields[STATS_RECORD_FIELDS] = {0};
+    fields[0] = result;
+
+    if (result == 0 && stats != nullptr) {
+      int64_t values[] = {
+        (int64_t) stats->st_dev,
+        (int64_t) stats->st_ino,
+        (int64_t) stats->st_mode,
+        (int64_t) stats->st_nlink,
+        (int64_t) stats->st_uid,
+        (int64_t) stats->st_gid,
+        (int64_t) stats->st_rdev,
+        (int64_t) stats->st_size,
+        (int64_t) stats->st_blksize,
+        (int64_t) stats->st_blocks,
+        (int64_t) stats->st_flags,
+        (int64_t) stats->st_gen,
+        (int64_t) stats->st_atim.tv_sec,
+        (int64_t) stats->st_atim.tv_nsec,
+        (int64_t) stats->st_mtim.tv_sec,
+        (int64_t) stats->st_mtim.tv_nsec,
+        (int64_t) stats->st_ctim.tv_sec,
+        (int64_t) stats->st_ctim.tv_nsec,
+        (int64_t) stats->st_birthtim.tv_sec,
+        (int64_t) stats->st_birthtim.tv_nsec
+      };
+
+      memcpy(fields + 1, values, sizeof(values));
     }
 
-    this->iov[index].len = 0;
+    for (size_t i = 0; i < STATS_RECORD_FIELDS; ++i) {
+      auto value = (uint64_t) fields[i];
+      for (size_t j = 0; j < sizeof(int64_t); ++j) {
+        bytes[i * sizeof(int64_t) + j] = (char) ((value >> (j * 8)) & 0xff);
+      }
+    }
   }
 
-  char* Core::FS::RequestContext::getBuffer (int index) {
-    return this->iov[index].base;
+  static Post getStatsRecordPost (char *bytes, size_t size) {
+    auto headers = Headers {{
+      {"content-type" ,"application/octet-stream"},
+      {"content-length", (uint64_t) size}
+    }};
+
+    Post post;
+    post.id = SSC::rand64();
+    post.body = bytes;
+    post.length = (int) size;
+    post.headers = headers.str();
+    return post;
   }
 
-  size_t Core::FS::RequestContext::getBufferSize (int index) {
-    return this->iov[index].len;
+  static Post getStatsRecordPost (uv_stat_t *stats) {
+    auto bytes = new char[STATS_RECORD_SIZE]{0};
+    writeStatsRecord(bytes, 0, stats);
+    return getStatsRecordPost(bytes, STATS_RECORD_SIZE);
   }
 
-  Core::FS::Descriptor::Descriptor (Core *core, uint64_t id) {
-    this->core = core;
-    this->id = id;
+  // max number of threadpool work items a batched stat fans out to
+  static constexpr size_t STAT_BATCH_CONCURRENCY = 4;
+  // min number of paths given to each work item of a batched stat
+  static constexpr size_t STAT_BATCH_MIN_CHUNK_SIZE = 32;
+
+  struct StatBatch {
+    using Callback = std::function<void(StatBatch*)>;
+
+    struct Work {
+      StatBatch *batch = nullptr;
+      uv_work_t req;
+      size_t start = 0;
+      size_t end = 0;
+    };
+
+    Vector<String> paths;
+    Vector<uv_stat_t> stats;
+    Vector<int> results;
+    Vector<Work> work;
+    std::atomic<size_t> pending = 0;
+    Callback callback;
+  };
+
+  /**
+   * Stats `paths` synchronously on up to `STAT_BATCH_CONCURRENCY` threadpool
+   * workers and calls `callback` on the loop thread once every path is done.
+   * `uv_fs_stat()` uses statx(2) on Linux where the kernel supports it.
+   */
+  static void statBatch (
+    uv_loop_t *loop,
+    const Vector<String>& paths,
+    StatBatch::Callback callback
+  ) {
+    auto batch = new StatBatch();
+    auto size = paths.size();
+    auto chunks = std::min(
+      STAT_BATCH_CONCURRENCY,
+      std::max((size_t) 1, (size + STAT_BATCH_MIN_CHUNK_SIZE - 1) / STAT_BATCH_MIN_CHUNK_SIZE)
+    );
+
+    auto chunkSize = (size + chunks - 1) / chunks;
+
+    batch->paths = paths;
+    batch->stats.resize(size);
+    batch->results.resize(size, 0);
+    batch->work.resize(chunks);
+    batch->callback = callback;
+    batch->pending = chunks;
+
+    for (size_t i = 0; i < chunks; ++i) {
+      auto work = &batch->work[i];
+      work->batch = batch;
+      work->start = std::min(size, i * chunkSize);
+      work->end = std::min(size, work->start + chunkSize);
+      work->req.data = work;
+
+      uv_queue_work(loop, &work->req, [](uv_work_t *req) {
+        auto work = (StatBatch::Work *) req->data;
+        auto batch = work->batch;
+
+        for (auto i = work->start; i < work->end; ++i) {
+          uv_fs_t fs;
+          // a null callback runs the request synchronously on this worker
+          auto err = uv_fs_stat(req->loop, &fs, batch->paths[i].c_str(), nullptr);
+
+          if (err < 0) {
+            batch->results[i] = err;
+          } else {
+            batch->stats[i] = fs.statbuf;
+          }
+
+          uv_fs_req_cleanup(&fs);
+        }
+      }, [](uv_work_t *req, int status) {
+        auto work = (StatBatch::Work *) req->data;
+        auto batch = work->batch;
+
+        if (status < 0) {
+          for (auto i = work->start; i < work->end; ++i) {
+            batch->results[i] = status;
+          }
+        }
+
+        if (--batch->pending == 0) {
+          batch->callback(batch);
+          delete batch;
+        }
+      });
+    }
   }
 
-  bool Core::FS::Descriptor::isDirectory () {
+  static JSON::Any getStatBatchEntryJSON (StatBatch *batch, size_t index) {
+    auto err = batch->results[index];
+
+    if (err < 0) {
+      return JSON::Object::Entries {
+        {"err", JSON::Object::Entries {
+          {"code", err},
+          {"message", String(uv_strerror(err))}
+        }}
+      };
+    }
+
+    return getStatsDataJSON(&batch->stats[index]);
+  }
+
+  Core::FS::RequestContextPool Core::FS::requestContexts;
+
+  Core::FS::RequestContextPool::~RequestContextPool () {
     Lock lock(this->mutex);
-    return this->dir != nullptr;
+    for (auto& tuple : this->free) {
+      for (auto ptr : tuple.second) {
+        ::operator delete(ptr);
+      }
+    }
+
+    this->free.clear();
   }
 
-  bool Core::FS::Descriptor::isFile () {
+  void* Core::FS::RequestContextPool::acquire (size_t size) {
+    void *ptr = nullptr;
+
+    do {
+      Lock lock(this->mutex);
+      auto& free = this->free[size];
+
+      if (free.size() > 0) {
+        ptr = free.back();
+        free.pop_back();
+      }
+    } while (0);
+
+    if (ptr == nullptr) {
+      ptr = ::operator new(size);
+    }
+
+    this->inFlight++;
+    this->inFlightBytes += size;
+    return ptr;
+  }
+
+  void Core::FS::RequestContextPool::release (void *ptr, size_t size) {
+    if (ptr == nullptr) {
+      return;
+    }
+
+    this->inFlight--;
+    this->inFlightBytes -= size;
+
     Lock lock(this->mutex);
-    return this->fd > 0 && this->dir == nullptr;
+    auto& free = this->free[size];
+
+    if (free.size() < MAX_FREE_CONTEXTS_PER_SIZE) {
+      free.push_back(ptr);
+    } else {
+      ::operator delete(ptr);
+    }
   }
 
-  bool Core::FS::Descriptor::isRetained () {
-    return this->retained;
+  size_t Core::FS::RequestContextPool::pooled () {
+    Lock lock(this->mutex);
+    size_t count = 0;
+
+    for (const auto& tuple : this->free) {
+      count += tuple.second.size();
+    }
+
+    return count;
   }
 
-  bool Core::FS::Descriptor::isStale () {
-    return this->stale;
+  void* Core::FS::RequestContext::operator new (size_t size) {
+    return requestContexts.acquire(size);
   }
 
-  Core::FS::Descriptor * Core::FS::getDescriptor (uint64_t id) {
+  // `size` is the size of the dynamic type as the destructor is virtual
+  void Core::FS::RequestContext::operator delete (void *ptr, size_t size) {
+    requestContexts.release(ptr, size);
+  }
+
+  void Core::FS::RequestContext::setBuffer (int index, size_t len, char *base) {
+    this->iov[index].base = base;
+    this->iov[index].len = len;
+  }
+
+  char* Core::FS::RequestContext::getBuffer (int index) {
+    return this->iov[index].base;
+  }
+
+  size_t Core::FS::RequestContext::getBufferSize (int index) {
+    return this->iov[index].len;
+  }
+
+  Core::FS::BufferPool::~BufferPool () {
     Lock lock(this->mutex);
-    if (descriptors.find(id) != descriptors.end()) {
-      return descriptors.at(id);
+    for (auto& tuple : this->free) {
+      for (auto bytes : tuple.second) {
+        delete [] bytes;
+      }
     }
-    return nullptr;
+
+    this->free.clear();
   }
 
-  void Core::FS::removeDescriptor (uint64_t id) {
+  char* Core::FS::BufferPool::acquire (size_t size) {
+    auto sizeClass = MIN_SIZE_CLASS;
+
+    while (sizeClass < size && sizeClass < MAX_SIZE_CLASS) {
+      sizeClass <<= 1;
+    }
+
+    // oversized buffers are never kept in the free lists but are still
+    // tracked so that `release()` recognizes them
+    if (size > MAX_SIZE_CLASS) {
+      sizeClass = size;
+    }
+
     Lock lock(this->mutex);
-    if (descriptors.find(id) != descriptors.end()) {
-      descriptors.erase(id);
+    char *bytes = nullptr;
+
+    if (sizeClass <= MAX_SIZE_CLASS && this->free[sizeClass].size() > 0) {
+      bytes = this->free[sizeClass].back();
+      this->free[sizeClass].pop_back();
+    } else {
+      // intentionally not zero-filled, callers overwrite what they read
+      bytes = new char[sizeClass];
     }
+
+    this->acquired[bytes] = sizeClass;
+    return bytes;
   }
 
-  bool Core::FS::hasDescriptor (uint64_t id) {
+  void Core::FS::BufferPool::lend (char *bytes, std::shared_ptr<Mapping> mapping) {
     Lock lock(this->mutex);
-    return descriptors.find(id) != descriptors.end();
+    this->lent.emplace(bytes, mapping);
   }
 
-  void Core::FS::retainOpenDescriptor (
-    const String seq,
-    uint64_t id,
-    Module::Callback cb
-  ) {
-    auto desc = getDescriptor(id);
+  bool Core::FS::BufferPool::release (char *bytes) {
+    if (bytes == nullptr) {
+      return false;
+    }
 
-    if (desc == nullptr) {
-      auto json = JSON::Object::Entries {
-        {"source", "fs.retainOpenDescriptor"},
-        {"err", JSON::Object::Entries {
-          {"id", std::to_string(id)},
-          {"code", "ENOTOPEN"},
-          {"type", "NotFoundError"},
-          {"message", "No file descriptor found with that id"}
-        }}
-      };
+    Lock lock(this->mutex);
+    auto range = this->lent.find(bytes);
 
-      return cb(seq, json, Post{});
+    // the mapping is unmapped with its last reference
+    if (range != this->lent.end()) {
+      this->lent.erase(range);
+      return true;
     }
 
-    desc->retained = true;
-    auto json = JSON::Object::Entries {
-      {"source", "fs.retainOpenDescriptor"},
-      {"data", JSON::Object::Entries {
-        {"id", std::to_string(desc->id)}
-      }}
+    auto entry = this->acquired.find(bytes);
+
+    if (entry == this->acquired.end()) {
+      return false;
+    }
+
+    auto sizeClass = entry->second;
+    this->acquired.erase(entry);
+
+    if (
+      sizeClass <= MAX_SIZE_CLASS &&
+      this->free[sizeClass].size() < MAX_FREE_BUFFERS_PER_CLASS
+    ) {
+      this->free[sizeClass].push_back(bytes);
+    } else {
+      delete [] bytes;
+    }
+
+    return true;
+  }
+
+  /**
+   * Sequential reads issued ahead of the reader. Up to `window` chunks of
+   * `size` bytes are kept in flight or completed in a ring, so a read at the
+   * offset of the oldest chunk is answered without waiting on the disk. A
+   * read at any other offset restarts the ring after it.
+   */
+  struct Core::FS::ReadAhead {
+    struct Chunk {
+      ReadAhead *ahead = nullptr;
+      uv_fs_t req;
+      uv_buf_t buf;
+      char *bytes = nullptr;
+      int64_t offset = 0;
+      // the ring generation the chunk was read for, see `reset()`
+      uint64_t generation = 0;
+      bool done = false;
+      // dropped from the ring by a seek while still in flight
+      bool discarded = false;
+
+      // a read waiting for this chunk, see `stalls`
+      bool awaited = false;
+      String seq;
+      Module::Callback cb;
+      size_t length = 0;
+      uint64_t since = 0;
     };
 
-    cb(seq, json, Post{});
+    Descriptor *desc = nullptr;
+    size_t size = 0;
+    size_t window = 0;
+    int64_t next = 0;
+    std::deque<Chunk*> ring;
+    size_t active = 0;
+    // bumped by every `reset()`, older chunks in flight no longer count
+    uint64_t generation = 0;
+    bool eof = false;
+    bool stopped = false;
+    Vector<std::function<void()>> onstop;
+
+    uint64_t hits = 0;
+    uint64_t stalls = 0;
+    uint64_t misses = 0;
+    // nanoseconds reads waited on chunks still in flight
+    uint64_t stallTime = 0;
+
+    void fill ();
+    bool read (const String seq, size_t size, int64_t offset, Module::Callback cb);
+    void respond (Chunk *chunk, const String seq, size_t length, Module::Callback cb);
+    void complete (Chunk *chunk);
+    void reset (int64_t offset);
+    void invalidate ();
+    void stop (std::function<void()> cb);
+    void finish ();
+    JSON::Object json ();
+  };
+
+  // anything that changes the file drops the chunks read ahead of it
+  static inline void invalidateReadAhead (Core::FS::Descriptor *desc) {
+    if (desc->readAhead != nullptr) {
+      desc->readAhead->invalidate();
+    }
   }
 
-  void Core::FS::access (
-    const String seq,
-    const String path,
-    int mode,
-    Module::Callback cb
-  ) {
-    this->core->dispatchEventLoop([=, this]() {
-      auto filename = path.c_str();
-      auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
-      auto req = &ctx->req;
-      auto err = uv_fs_access(loop, req, filename, mode, [](uv_fs_t* req) {
-        auto ctx = (RequestContext *) req->data;
-        auto json = JSON::Object {};
+  /**
+   * Writes acknowledged as soon as they are buffered. Contiguous writes are
+   * copied into blocks of `highWaterMark` bytes and sealed into a batch
+   * once `highWaterMark` bytes are pending, `delay` milliseconds have
+   * passed or a flush is requested. Batches are written one at a time with
+   * a single vectored write each. A failed batch is reported to the next
+   * write, flush or close.
+   */
+  struct Core::FS::WriteBehind {
+    // batches queued past this many `highWaterMark`s hold back acknowledgements
+    static constexpr size_t MAX_QUEUED_BATCHES = 16;
+
+    using Waiter = std::function<void(int)>;
+
+    struct Batch {
+      WriteBehind *behind = nullptr;
+      uv_fs_t req;
+      Vector<char*> blocks;
+      Vector<uv_buf_t> buffers;
+      Vector<Waiter> waiters;
+      int64_t offset = -1;
+      size_t size = 0;
+    };
 
-        if (req->result < 0) {
-          json = JSON::Object::Entries {
-            {"source", "fs.access"},
-            {"err", JSON::Object::Entries {
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
-            }}
-          };
-        } else {
-          json = JSON::Object::Entries {
-            {"source", "fs.access"},
-            {"data", JSON::Object::Entries {
-              {"mode", req->flags},
-            }}
-          };
-        }
+    Descriptor *desc = nullptr;
+    size_t highWaterMark = 0;
+    uint64_t delay = 0;
+
+    // bytes not sealed into a batch yet, starting at `offset`
+    Vector<char*> blocks;
+    size_t used = 0;
+    size_t pending = 0;
+    int64_t offset = -1;
+
+    std::deque<Batch*> batches;
+    size_t queued = 0;
+    int error = 0;
+    uv_timer_t timer;
+    // set by `stop()`, writes then bypass the buffer once the batches drain
+    bool stopped = false;
+    Vector<Waiter> onstop;
+    size_t closing = 0;
+
+    int init ();
+    int write (const char *bytes, size_t size, int64_t offset, Waiter waiter);
+    void seal ();
+    void flush (Waiter waiter);
+    void next ();
+    void complete (Batch *batch);
+    void stop (Waiter waiter);
+    void finish ();
+    JSON::Object json ();
+  };
 
-        ctx->cb(ctx->seq, json, Post {});
-        delete ctx;
-      });
+  Core::FS::Descriptor::Descriptor (Core *core, uint64_t id) {
+    this->core = core;
+    this->id = id;
+  }
 
-      if (err < 0) {
-        auto json = JSON::Object::Entries {
-          {"source", "fs.access"},
-          {"err", JSON::Object::Entries {
-            {"code", err},
-            {"message", String(uv_strerror(err))}
-          }}
-        };
+  Core::FS::Descriptor::~Descriptor () {
+    // descriptors are deleted when closed or released as weak descriptors
+    this->unmap();
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
+    if (this->readAhead != nullptr) {
+      this->readAhead->finish();
+    }
+
+    // writes still buffered when a descriptor is released without being
+    // closed are dropped, batches in flight hold a reference to it
+    if (this->writeBehind != nullptr) {
+      for (auto bytes : this->writeBehind->blocks) {
+        this->core->fs.buffers.release(bytes);
       }
-    });
+
+      uv_close((uv_handle_t *) &this->writeBehind->timer, [](uv_handle_t *timer) {
+        delete (WriteBehind *) timer->data;
+      });
+    }
+
+    if (this->hasher != nullptr) {
+      delete this->hasher;
+    }
   }
 
-  void Core::FS::chmod (
-    const String seq,
-    const String path,
-    int mode,
-    Module::Callback cb
+  void Core::FS::Descriptor::hashWritten (
+    const uv_buf_t *buffers,
+    size_t count,
+    size_t size,
+    int64_t offset
   ) {
-    this->core->dispatchEventLoop([=, this]() {
-      auto filename = path.c_str();
-      auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
-      auto req = &ctx->req;
-      auto err = uv_fs_chmod(loop, req, filename, mode, [](uv_fs_t* req) {
-        auto ctx = (RequestContext *) req->data;
-        auto json = JSON::Object {};
+    Lock lock(this->mutex);
 
-        if (req->result < 0) {
-          json = JSON::Object::Entries {
-            {"source", "fs.chmod"},
-            {"err", JSON::Object::Entries {
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
-            }}
-          };
-        } else {
-          json = JSON::Object::Entries {
-            {"source", "fs.chmod"},
-            {"data", JSON::Object::Entries {
-              {"mode", req->flags},
-            }}
-          };
-        }
+    if (this->hasher == nullptr || !this->hashContiguous || size == 0) {
+      return;
+    }
 
-        ctx->cb(ctx->seq, json, Post {});
-        delete ctx;
-      });
+    // the digest is of the bytes in file order, so every write has to
+    // continue where the previous one ended
+    if (this->hashedBytes > 0 && offset != this->hashOffset) {
+      this->hashContiguous = false;
+      return;
+    }
 
-      if (err < 0) {
-        auto json = JSON::Object::Entries {
-          {"source", "fs.chmod"},
-          {"err", JSON::Object::Entries {
-            {"code", err},
-            {"message", String(uv_strerror(err))}
-          }}
-        };
+    this->hashOffset = offset < 0 ? -1 : offset + (int64_t) size;
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
-      }
-    });
+    // only the bytes that made it to the file, a short write is retried
+    for (size_t i = 0; i < count && size > 0; ++i) {
+      auto length = std::min(size, (size_t) buffers[i].len);
+      this->hasher->update((const unsigned char *) buffers[i].base, length);
+      this->hashedBytes += length;
+      size -= length;
+    }
   }
 
-  void Core::FS::close (
-    const String seq,
-    uint64_t id,
-    Module::Callback cb
-  ) {
-    this->core->dispatchEventLoop([=, this]() {
-      auto desc = getDescriptor(id);
+  Core::FS::Mapping::~Mapping () {
+  #if !defined(_WIN32)
+    if (this->bytes != nullptr) {
+      ::munmap(this->bytes, this->size);
+    }
+  #endif
+  }
 
-      if (desc == nullptr) {
-        auto json = JSON::Object::Entries {
-          {"source", "fs.close"},
-          {"err", JSON::Object::Entries {
-            {"id", std::to_string(id)},
-            {"code", "ENOTOPEN"},
-            {"type", "NotFoundError"},
-            {"message", "No file descriptor found with that id"}
-          }}
-        };
+  bool Core::FS::Descriptor::isMapped () {
+    Lock lock(this->mutex);
+    return this->mapping != nullptr;
+  }
+
+  int Core::FS::Descriptor::map (const String advice) {
+  #if defined(_WIN32)
+    return UV_ENOTSUP;
+  #else
+    Lock lock(this->mutex);
+    int flag = MADV_NORMAL;
+
+    if (advice == "sequential") {
+      flag = MADV_SEQUENTIAL;
+    } else if (advice == "random") {
+      flag = MADV_RANDOM;
+    } else if (advice == "willneed") {
+      flag = MADV_WILLNEED;
+    } else if (advice.size() > 0 && advice != "normal") {
+      return UV_EINVAL;
+    }
+
+    if (this->mapping == nullptr) {
+      struct stat st;
+
+      if (::fstat(this->fd, &st) != 0) {
+        return uv_translate_sys_error(errno);
+      }
+
+      // empty files cannot be mapped, reads fall back to `uv_fs_read()`
+      if (st.st_size == 0) {
+        return 0;
+      }
+
+      auto size = (size_t) st.st_size;
+      auto mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, this->fd, 0);
+
+      if (mapping == MAP_FAILED) {
+        return uv_translate_sys_error(errno);
+      }
+
+      this->mapping = std::make_shared<Mapping>();
+      this->mapping->bytes = (char *) mapping;
+      this->mapping->size = size;
+    }
+
+    if (::madvise(this->mapping->bytes, this->mapping->size, flag) != 0) {
+      return uv_translate_sys_error(errno);
+    }
+
+    return 0;
+  #endif
+  }
+
+  // replies still holding a range of the mapping defer the `munmap()`
+  void Core::FS::Descriptor::unmap () {
+    Lock lock(this->mutex);
+    this->mapping = nullptr;
+  }
+
+  // `dir` and `fd` are set before the descriptor is inserted into the table
+  bool Core::FS::Descriptor::isDirectory () {
+    return this->dir != nullptr;
+  }
+
+  bool Core::FS::Descriptor::isFile () {
+    return this->fd > 0 && this->dir == nullptr;
+  }
+
+  void Core::FS::Descriptor::ref () {
+    this->refs++;
+  }
+
+  void Core::FS::Descriptor::unref () {
+    if (--this->refs <= 0) {
+      delete this;
+    }
+  }
+
+  bool Core::FS::Descriptor::isRetained () {
+    return this->retained;
+  }
+
+  bool Core::FS::Descriptor::isStale () {
+    return this->stale;
+  }
+
+  static inline uint64_t getDescriptorHandle (uint32_t index, uint32_t generation) {
+    return ((uint64_t) generation << 32) | index;
+  }
+
+  static inline size_t getDescriptorIndexSlot (uint64_t id, size_t capacity) {
+    // fibonacci hashing spreads sequential ids, `capacity` is a power of two
+    return (size_t) ((id * 0x9E3779B97F4A7C15ULL) >> 32) & (capacity - 1);
+  }
+
+  Core::FS::DescriptorTable::DescriptorTable () {
+    auto index = new Index();
+    index->capacity = MIN_INDEX_CAPACITY;
+    index->entries = new IndexEntry[index->capacity];
+    this->index = index;
+  }
+
+  Core::FS::DescriptorTable::~DescriptorTable () {
+    for (auto& page : this->pages) {
+      delete [] page.load();
+    }
+
+    for (auto index : this->retired) {
+      delete [] index->entries;
+      delete index;
+    }
+
+    auto index = this->index.load();
+    delete [] index->entries;
+    delete index;
+  }
+
+  uint64_t Core::FS::DescriptorTable::getHandle (uint64_t id) {
+    auto index = this->index.load(std::memory_order_acquire);
+    auto slot = getDescriptorIndexSlot(id, index->capacity);
+
+    for (size_t i = 0; i < index->capacity; ++i) {
+      auto& entry = index->entries[(slot + i) & (index->capacity - 1)];
+      auto key = entry.id.load(std::memory_order_acquire);
+
+      if (key == 0) {
+        return 0;
+      }
+
+      if (key == id) {
+        auto handle = entry.handle.load(std::memory_order_acquire);
+
+        // a removed entry reused for another id while it was read
+        if (entry.id.load(std::memory_order_acquire) != id) {
+          return 0;
+        }
+
+        return handle;
+      }
+    }
+
+    return 0;
+  }
+
+  Core::FS::Descriptor* Core::FS::DescriptorTable::resolve (uint64_t handle) {
+    auto index = (uint32_t) (handle & 0xffffffff);
+    auto generation = (uint32_t) (handle >> 32);
+
+    if (handle == 0 || index / PAGE_SIZE >= MAX_PAGES) {
+      return nullptr;
+    }
+
+    auto page = this->pages[index / PAGE_SIZE].load(std::memory_order_acquire);
+
+    if (page == nullptr) {
+      return nullptr;
+    }
+
+    auto& slot = page[index % PAGE_SIZE];
+
+    // a slot reused while it was read changes generation
+    if (slot.generation.load(std::memory_order_acquire) != generation) {
+      return nullptr;
+    }
+
+    auto desc = slot.desc.load(std::memory_order_acquire);
+
+    if (slot.generation.load(std::memory_order_acquire) != generation) {
+      return nullptr;
+    }
+
+    return desc;
+  }
+
+  Core::FS::Descriptor* Core::FS::DescriptorTable::get (uint64_t id) {
+    auto desc = this->resolve(this->getHandle(id));
+
+    if (desc != nullptr && desc->id != id) {
+      return nullptr;
+    }
+
+    return desc;
+  }
+
+  void Core::FS::DescriptorTable::setIndexEntry (
+    Index *index,
+    uint64_t id,
+    uint64_t handle
+  ) {
+    auto slot = getDescriptorIndexSlot(id, index->capacity);
+    IndexEntry *removed = nullptr;
+    IndexEntry *target = nullptr;
+
+    for (size_t i = 0; i < index->capacity; ++i) {
+      auto& entry = index->entries[(slot + i) & (index->capacity - 1)];
+      auto key = entry.id.load(std::memory_order_relaxed);
+
+      if (key == id) {
+        entry.handle.store(handle, std::memory_order_release);
+        return;
+      }
+
+      if (key == 0) {
+        target = &entry;
+        break;
+      }
+
+      if (removed == nullptr && entry.handle.load(std::memory_order_relaxed) == 0) {
+        removed = &entry;
+      }
+    }
+
+    if (handle == 0) {
+      return;
+    }
+
+    // reuse a removed entry in the probe chain before taking an empty one
+    if (removed != nullptr) {
+      target = removed;
+    } else if (target != nullptr) {
+      index->used++;
+    } else {
+      return;
+    }
+
+    // readers matching the id before the handle is stored see a miss, and
+    // readers of the id a removed entry had see it change after the handle
+    target->id.store(id, std::memory_order_release);
+    target->handle.store(handle, std::memory_order_release);
+  }
+
+  uint64_t Core::FS::DescriptorTable::insert (Descriptor *desc) {
+    Lock lock(this->mutex);
+    uint32_t position = 0;
+
+    if (desc->id == 0) {
+      return 0;
+    }
+
+    if (this->free.size() > 0) {
+      position = this->free.back();
+      this->free.pop_back();
+    } else {
+      if (this->next >= PAGE_SIZE * MAX_PAGES) {
+        return 0;
+      }
+
+      position = this->next++;
+
+      if (this->pages[position / PAGE_SIZE].load() == nullptr) {
+        this->pages[position / PAGE_SIZE].store(
+          new Slot[PAGE_SIZE],
+          std::memory_order_release
+        );
+      }
+    }
+
+    // replacing a descriptor for an id already in the table
+    auto previous = this->remove(desc->id);
+
+    if (previous != desc) {
+      desc->ref();
+    }
+
+    if (previous != nullptr && previous != desc) {
+      previous->unref();
+    }
+
+    auto& slot = this->pages[position / PAGE_SIZE].load()[position % PAGE_SIZE];
+    auto handle = getDescriptorHandle(position, slot.generation.load());
+    auto index = this->index.load();
+
+    slot.desc.store(desc, std::memory_order_release);
+
+    // keep the index at most half full, removed entries are dropped when it
+    // grows. Growth is geometric so retired indexes stay bounded
+    if ((index->used + 1) * 2 > index->capacity) {
+      auto grown = new Index();
+      grown->capacity = index->capacity * 2;
+      grown->entries = new IndexEntry[grown->capacity];
+
+      for (size_t i = 0; i < index->capacity; ++i) {
+        auto& entry = index->entries[i];
+        auto value = entry.handle.load();
+
+        if (entry.id.load() != 0 && value != 0) {
+          this->setIndexEntry(grown, entry.id.load(), value);
+        }
+      }
+
+      // readers may still hold the previous index
+      this->retired.push_back(index);
+      this->index.store(grown, std::memory_order_release);
+      index = grown;
+    }
+
+    this->setIndexEntry(index, desc->id, handle);
+    this->count++;
+    return handle;
+  }
+
+  Core::FS::Descriptor* Core::FS::DescriptorTable::remove (uint64_t id) {
+    Lock lock(this->mutex);
+    auto handle = this->getHandle(id);
+    auto desc = this->resolve(handle);
+
+    if (desc == nullptr) {
+      return nullptr;
+    }
+
+    auto position = (uint32_t) (handle & 0xffffffff);
+    auto& slot = this->pages[position / PAGE_SIZE].load()[position % PAGE_SIZE];
+
+    this->setIndexEntry(this->index.load(), id, 0);
+    slot.generation++;
+    slot.desc.store(nullptr, std::memory_order_release);
+    this->free.push_back(position);
+    this->count--;
+    return desc;
+  }
+
+  Vector<Core::FS::Descriptor*> Core::FS::DescriptorTable::snapshot () {
+    Lock lock(this->mutex);
+    Vector<Descriptor*> descriptors;
+
+    for (uint32_t i = 0; i < this->next; ++i) {
+      auto desc = this->pages[i / PAGE_SIZE].load()[i % PAGE_SIZE].desc.load();
+
+      if (desc != nullptr) {
+        descriptors.push_back(desc);
+      }
+    }
+
+    return descriptors;
+  }
+
+  size_t Core::FS::DescriptorTable::size () {
+    return this->count;
+  }
+
+  Core::FS::Descriptor * Core::FS::getDescriptor (uint64_t id) {
+    return this->descriptors.get(id);
+  }
+
+  bool Core::FS::insertDescriptor (Descriptor *desc) {
+    return this->descriptors.insert(desc) != 0;
+  }
+
+  void Core::FS::removeDescriptor (uint64_t id) {
+    auto desc = this->descriptors.remove(id);
+
+    if (desc != nullptr) {
+      desc->unref();
+    }
+  }
+
+  bool Core::FS::hasDescriptor (uint64_t id) {
+    return this->descriptors.get(id) != nullptr;
+  }
+
+  void Core::FS::markDescriptorsStale () {
+    Lock lock(this->mutex);
+
+    for (auto desc : this->descriptors.snapshot()) {
+      if (!desc->isStale()) {
+        desc->stale = true;
+        this->staleDescriptors.push_back(desc->id);
+      }
+    }
+  }
+
+  void Core::FS::retainOpenDescriptor (
+    const String seq,
+    uint64_t id,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.retainOpenDescriptor"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
 
         return cb(seq, json, Post{});
       }
 
+      desc->retained = true;
+      auto json = JSON::Object::Entries {
+        {"source", "fs.retainOpenDescriptor"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(desc->id)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::FS::access (
+    const String seq,
+    const String path,
+    int mode,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto filename = path.c_str();
       auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(desc, seq, cb);
+      auto ctx = new RequestContext(seq, cb);
       auto req = &ctx->req;
-      auto err = uv_fs_close(loop, req, desc->fd, [](uv_fs_t* req) {
+      auto err = uv_fs_access(loop, req, filename, mode, [](uv_fs_t* req) {
         auto ctx = (RequestContext *) req->data;
-        auto desc = ctx->desc;
         auto json = JSON::Object {};
 
         if (req->result < 0) {
           json = JSON::Object::Entries {
-            {"source", "fs.close"},
+            {"source", "fs.access"},
             {"err", JSON::Object::Entries {
-              {"id", std::to_string(desc->id)},
               {"code", req->result},
               {"message", String(uv_strerror((int) req->result))}
             }}
           };
         } else {
           json = JSON::Object::Entries {
-            {"source", "fs.close"},
+            {"source", "fs.access"},
             {"data", JSON::Object::Entries {
-              {"id", std::to_string(desc->id)},
-              {"fd", desc->fd}
+              {"mode", req->flags},
             }}
           };
-
-          desc->core->fs.removeDescriptor(desc->id);
-          delete desc;
         }
 
-        ctx->cb(ctx->seq, json, Post{});
+        ctx->cb(ctx->seq, json, Post {});
         delete ctx;
       });
 
       if (err < 0) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.close"},
+          {"source", "fs.access"},
           {"err", JSON::Object::Entries {
-            {"id", std::to_string(desc->id)},
             {"code", err},
             {"message", String(uv_strerror(err))}
           }}
@@ -476,100 +1197,361 @@ namespace SSC {
     });
   }
 
-  void Core::FS::open (
+  void Core::FS::chmod (
     const String seq,
-    uint64_t id,
     const String path,
-    int flags,
     int mode,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
       auto filename = path.c_str();
-      auto desc = new Descriptor(this->core, id);
       auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(desc, seq, cb);
+      auto ctx = new RequestContext(seq, cb);
       auto req = &ctx->req;
-      auto err = uv_fs_open(loop, req, filename, flags, mode, [](uv_fs_t* req) {
+      auto err = uv_fs_chmod(loop, req, filename, mode, [](uv_fs_t* req) {
         auto ctx = (RequestContext *) req->data;
-        auto desc = ctx->desc;
         auto json = JSON::Object {};
 
         if (req->result < 0) {
           json = JSON::Object::Entries {
-            {"source", "fs.open"},
+            {"source", "fs.chmod"},
             {"err", JSON::Object::Entries {
-              {"id", std::to_string(desc->id)},
               {"code", req->result},
               {"message", String(uv_strerror((int) req->result))}
             }}
           };
-
-          delete desc;
         } else {
           json = JSON::Object::Entries {
-            {"source", "fs.open"},
+            {"source", "fs.chmod"},
             {"data", JSON::Object::Entries {
-              {"id", std::to_string(desc->id)},
-              {"fd", (int) req->result}
+              {"mode", req->flags},
             }}
           };
-
-          desc->fd = (int) req->result;
-          // insert into `descriptors` map
-          Lock lock(desc->core->fs.mutex);
-          desc->core->fs.descriptors.insert_or_assign(desc->id, desc);
         }
 
-        ctx->cb(ctx->seq, json, Post{});
+        ctx->cb(ctx->seq, json, Post {});
         delete ctx;
       });
 
       if (err < 0) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.open"},
+          {"source", "fs.chmod"},
           {"err", JSON::Object::Entries {
-            {"id", std::to_string(desc->id)},
             {"code", err},
             {"message", String(uv_strerror(err))}
           }}
         };
 
         ctx->cb(ctx->seq, json, Post{});
-        delete desc;
         delete ctx;
       }
     });
   }
 
-  void Core::FS::opendir (
+  // see `Core::FS::Transfer` below
+  static bool cancelTransfers (Core::FS::Descriptor *desc, std::function<void()> callback);
+
+  void Core::FS::close (
     const String seq,
     uint64_t id,
-    const String path,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
-      auto filename = path.c_str();
-      auto desc =  new Descriptor(this->core, id);
-      auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(desc, seq, cb);
-      auto req = &ctx->req;
-      auto err = uv_fs_opendir(loop, req, filename, [](uv_fs_t *req) {
-        auto ctx = (RequestContext *) req->data;
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.close"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // buffered writes are flushed first, their error is the close error
+      if (desc->writeBehind != nullptr) {
+        return desc->writeBehind->stop([=, this](int err) {
+          this->close(seq, id, [=](auto seq, auto json, auto post) {
+            if (err == 0) {
+              return cb(seq, json, post);
+            }
+
+            auto error = JSON::Object::Entries {
+              {"source", "fs.close"},
+              {"err", JSON::Object::Entries {
+                {"id", std::to_string(id)},
+                {"code", err},
+                {"message", String(uv_strerror(err))}
+              }}
+            };
+
+            cb(seq, error, post);
+          });
+        });
+      }
+
+      // reads issued ahead must finish before the file is closed under them
+      if (desc->readAhead != nullptr) {
+        return desc->readAhead->stop([=, this]() {
+          this->close(seq, id, cb);
+        });
+      }
+
+      // as must transfers reading from it, they are cancelled first
+      if (cancelTransfers(desc, [=, this]() { this->close(seq, id, cb); })) {
+        return;
+      }
+
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(desc, seq, cb);
+      auto req = &ctx->req;
+      auto err = uv_fs_close(loop, req, desc->fd, [](uv_fs_t* req) {
+        auto ctx = (RequestContext *) req->data;
         auto desc = ctx->desc;
         auto json = JSON::Object {};
 
         if (req->result < 0) {
           json = JSON::Object::Entries {
-            {"source", "fs.opendir"},
+            {"source", "fs.close"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.close"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"fd", desc->fd}
+            }}
+          };
+
+          desc->core->fs.removeDescriptor(desc->id);
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.close"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(desc->id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::mmap (
+    const String seq,
+    uint64_t id,
+    const String advice,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.mmap"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto err = desc->map(advice);
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.mmap"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      Lock lock(desc->mutex);
+      auto json = JSON::Object::Entries {
+        {"source", "fs.mmap"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"size", (uint64_t) (desc->mapping != nullptr ? desc->mapping->size : 0)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::FS::munmap (
+    const String seq,
+    uint64_t id,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.munmap"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      desc->unmap();
+
+      auto json = JSON::Object::Entries {
+        {"source", "fs.munmap"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::FS::open (
+    const String seq,
+    uint64_t id,
+    const String path,
+    int flags,
+    int mode,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto filename = path.c_str();
+      auto desc = new Descriptor(this->core, id);
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(desc, seq, cb);
+      auto req = &ctx->req;
+      auto err = uv_fs_open(loop, req, filename, flags, mode, [](uv_fs_t* req) {
+        auto ctx = (RequestContext *) req->data;
+        auto desc = ctx->desc;
+        auto json = JSON::Object {};
+
+        if (req->result >= 0) {
+          desc->fd = (int) req->result;
+
+          // the descriptor table is full
+          if (!desc->core->fs.insertDescriptor(desc)) {
+            uv_fs_t close;
+            uv_fs_close(nullptr, &close, desc->fd, nullptr);
+            uv_fs_req_cleanup(&close);
+            req->result = UV_EMFILE;
+          }
+        }
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.open"},
             {"err", JSON::Object::Entries {
               {"id", std::to_string(desc->id)},
               {"code", req->result},
               {"message", String(uv_strerror((int) req->result))}
             }}
           };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.open"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"fd", (int) req->result}
+            }}
+          };
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.open"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(desc->id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
 
-          delete desc;
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::opendir (
+    const String seq,
+    uint64_t id,
+    const String path,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto filename = path.c_str();
+      auto desc =  new Descriptor(this->core, id);
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(desc, seq, cb);
+      auto req = &ctx->req;
+      desc->path = path;
+      auto err = uv_fs_opendir(loop, req, filename, [](uv_fs_t *req) {
+        auto ctx = (RequestContext *) req->data;
+        auto desc = ctx->desc;
+        auto json = JSON::Object {};
+
+        if (req->result >= 0) {
+          desc->dir = (uv_dir_t *) req->ptr;
+
+          // the descriptor table is full
+          if (!desc->core->fs.insertDescriptor(desc)) {
+            uv_fs_t closedir;
+            uv_fs_closedir(nullptr, &closedir, desc->dir, nullptr);
+            uv_fs_req_cleanup(&closedir);
+            desc->dir = nullptr;
+            req->result = UV_EMFILE;
+          }
+        }
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.opendir"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
         } else {
           json = JSON::Object::Entries {
             {"source", "fs.opendir"},
@@ -577,11 +1559,6 @@ namespace SSC {
               {"id", std::to_string(desc->id)}
             }}
           };
-
-          desc->dir = (uv_dir_t *) req->ptr;
-          // insert into `descriptors` map
-          Lock lock(desc->core->fs.mutex);
-          desc->core->fs.descriptors.insert_or_assign(desc->id, desc);
         }
 
         ctx->cb(ctx->seq, json, Post{});
@@ -599,7 +1576,6 @@ namespace SSC {
         };
 
         ctx->cb(ctx->seq, json, Post{});
-        delete desc;
         delete ctx;
       }
     });
@@ -609,6 +1585,7 @@ namespace SSC {
     const String seq,
     uint64_t id,
     size_t nentries,
+    bool withStats,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
@@ -643,17 +1620,54 @@ namespace SSC {
 
       Lock lock(desc->mutex);
       auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(desc, seq, cb);
+      auto ctx = new DirectoryRequestContext(desc, seq, cb);
       auto req = &ctx->req;
 
       desc->dir->dirents = ctx->dirents;
       desc->dir->nentries = nentries;
+      ctx->withStats = withStats;
 
       auto err = uv_fs_readdir(loop, req, desc->dir, [](uv_fs_t *req) {
+        // the entries of a reply are allocated together and freed at once
+        JSON::Arena::Scope scope;
         auto ctx = (RequestContext *) req->data;
         auto desc = ctx->desc;
         auto json = JSON::Object {};
 
+        // stat every entry in one batch and reply with them inline
+        if (ctx->withStats && req->result > 0) {
+          Vector<JSON::Object::Entries> entries;
+          Vector<String> paths;
+
+          for (int i = 0; i < req->result; ++i) {
+            auto name = String(desc->dir->dirents[i].name);
+            entries.push_back(JSON::Object::Entries {
+              {"type", desc->dir->dirents[i].type},
+              {"name", name}
+            });
+
+            paths.push_back(desc->path + "/" + name);
+          }
+
+          return statBatch(req->loop, paths, [=](auto batch) mutable {
+            JSON::Arena::Scope scope;
+            Vector<JSON::Any> data;
+
+            for (size_t i = 0; i < entries.size(); ++i) {
+              entries[i]["stats"] = getStatBatchEntryJSON(batch, i);
+              data.push_back(entries[i]);
+            }
+
+            auto json = JSON::Object::Entries {
+              {"source", "fs.readdir"},
+              {"data", data}
+            };
+
+            ctx->cb(ctx->seq, json, Post{});
+            delete ctx;
+          });
+        }
+
         if (req->result < 0) {
           json = JSON::Object::Entries {
             {"source", "fs.readdir"},
@@ -763,7 +1777,6 @@ namespace SSC {
           };
 
           desc->core->fs.removeDescriptor(desc->id);
-          delete desc;
         }
 
         ctx->cb(ctx->seq, json, Post{});
@@ -791,27 +1804,29 @@ namespace SSC {
     uint64_t id,
     Module::Callback cb
   ) {
-    auto desc = getDescriptor(id);
-
-    if (desc == nullptr) {
-      auto json = JSON::Object::Entries {
-        {"source", "fs.closeOpenDescriptor"},
-        {"err", JSON::Object::Entries {
-          {"id", std::to_string(id)},
-          {"code", "ENOTOPEN"},
-          {"type", "NotFoundError"},
-          {"message", "No descriptor found with that id"}
-        }}
-      };
-
-      return cb(seq, json, Post{});
-    }
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
 
-    if (desc->isDirectory()) {
-      this->closedir(seq, id, cb);
-    } else if (desc->isFile()) {
-      this->close(seq, id, cb);
-    }
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.closeOpenDescriptor"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      if (desc->isDirectory()) {
+        this->closedir(seq, id, cb);
+      } else if (desc->isFile()) {
+        this->close(seq, id, cb);
+      }
+    });
   }
 
   void Core::FS::closeOpenDescriptors (const String seq, Module::Callback cb) {
@@ -823,50 +1838,335 @@ namespace SSC {
     bool preserveRetained,
     Module::Callback cb
   ) {
-    Lock lock(this->mutex);
+    this->core->dispatchEventLoop([=, this]() {
+      Lock lock(this->mutex);
 
-    auto pending = descriptors.size();
-    int queued = 0;
-    auto json = JSON::Object {};
-    auto ids = Vector<uint64_t> {};
+      auto snapshot = descriptors.snapshot();
+      auto pending = snapshot.size();
+      int queued = 0;
+      auto json = JSON::Object {};
+
+      for (auto const desc : snapshot) {
+        auto id = desc->id;
+        pending--;
+
+        if (preserveRetained && desc->isRetained()) {
+          continue;
+        }
+
+        if (desc->isDirectory()) {
+          queued++;
+          this->closedir(seq, id, [pending, cb](auto seq, auto json, auto post) {
+            if (pending == 0) {
+              cb(seq, json, post);
+            }
+          });
+        } else if (desc->isFile()) {
+          queued++;
+          this->close(seq, id, [pending, cb](auto seq, auto json, auto post) {
+            if (pending == 0) {
+              cb(seq, json, post);
+            }
+          });
+        }
+      }
+
+      if (queued == 0) {
+        cb(seq, json, Post{});
+      }
+    });
+  }
+
+  void Core::FS::ReadAhead::fill () {
+    auto loop = &this->desc->core->eventLoop;
+
+    while (!this->stopped && !this->eof && this->ring.size() < this->window) {
+      auto chunk = new Chunk();
+      chunk->ahead = this;
+      chunk->offset = this->next;
+      chunk->generation = this->generation;
+      chunk->bytes = this->desc->core->fs.buffers.acquire(this->size);
+      chunk->buf = uv_buf_init(chunk->bytes, (unsigned int) this->size);
+      chunk->req.data = chunk;
+
+      auto err = uv_fs_read(loop, &chunk->req, this->desc->fd, &chunk->buf, 1, chunk->offset, [](uv_fs_t *req) {
+        auto chunk = (Chunk *) req->data;
+        chunk->ahead->complete(chunk);
+      });
 
-    for (auto const &tuple : descriptors) {
-      ids.push_back(tuple.first);
+      // reads fall back to `uv_fs_read()` until the ring is restarted
+      if (err < 0) {
+        this->desc->core->fs.buffers.release(chunk->bytes);
+        delete chunk;
+        this->eof = true;
+        break;
+      }
+
+      this->desc->ref();
+      this->active++;
+      this->next += this->size;
+      this->ring.push_back(chunk);
     }
+  }
 
-    for (auto const id : ids) {
-      auto desc = descriptors[id];
-      pending--;
+  bool Core::FS::ReadAhead::read (
+    const String seq,
+    size_t size,
+    int64_t offset,
+    Module::Callback cb
+  ) {
+    if (this->stopped) {
+      return false;
+    }
 
-      if (desc == nullptr) {
-        descriptors.erase(id);
-        continue;
+    if (this->ring.size() == 0 || this->ring.front()->offset != offset || size > this->size) {
+      // reads past the end of the file are expected once the ring is drained
+      if (!(this->eof && this->ring.size() == 0 && offset == this->next)) {
+        this->misses++;
+        this->reset(offset + size);
+        this->fill();
       }
 
-      if (preserveRetained && desc->isRetained()) {
-        continue;
+      return false;
+    }
+
+    auto chunk = this->ring.front();
+    this->ring.pop_front();
+
+    if (chunk->done) {
+      this->hits++;
+      this->respond(chunk, seq, size, cb);
+      delete chunk;
+    } else {
+      this->stalls++;
+      chunk->awaited = true;
+      chunk->seq = seq;
+      chunk->cb = cb;
+      chunk->length = size;
+      chunk->since = uv_hrtime();
+    }
+
+    this->fill();
+    return true;
+  }
+
+  void Core::FS::ReadAhead::respond (
+    Chunk *chunk,
+    const String seq,
+    size_t length,
+    Module::Callback cb
+  ) {
+    auto result = chunk->req.result;
+
+    if (result < 0) {
+      auto json = JSON::Object::Entries {
+        {"source", "fs.read"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(this->desc->id)},
+          {"code", result},
+          {"message", String(uv_strerror((int) result))}
+        }}
+      };
+
+      this->desc->core->fs.buffers.release(chunk->bytes);
+      return cb(seq, json, Post{});
+    }
+
+    length = std::min(length, (size_t) result);
+
+    auto headers = Headers {{
+      {"content-type" ,"application/octet-stream"},
+      {"content-length", (uint64_t) length}
+    }};
+
+    Post post;
+    post.id = SSC::rand64();
+    post.body = chunk->bytes;
+    post.length = (int) length;
+    post.headers = headers.str();
+
+    cb(seq, JSON::Object {}, post);
+  }
+
+  void Core::FS::ReadAhead::complete (Chunk *chunk) {
+    auto desc = this->desc;
+    auto result = chunk->req.result;
+    auto current = chunk->generation == this->generation;
+
+    this->active--;
+    chunk->done = true;
+
+    if (chunk->awaited) {
+      this->stallTime += uv_hrtime() - chunk->since;
+      this->respond(chunk, chunk->seq, chunk->length, chunk->cb);
+      uv_fs_req_cleanup(&chunk->req);
+      delete chunk;
+    } else if (chunk->discarded) {
+      desc->core->fs.buffers.release(chunk->bytes);
+      uv_fs_req_cleanup(&chunk->req);
+      delete chunk;
+    } else {
+      uv_fs_req_cleanup(&chunk->req);
+    }
+
+    // a short read or an error ends the ring, the reader sees it in order,
+    // chunks of a ring that was reset since say nothing about the file now
+    if (current && result < (ssize_t) this->size) {
+      this->eof = true;
+    }
+
+    if (this->stopped && this->active == 0) {
+      this->finish();
+    }
+
+    desc->unref();
+  }
+
+  void Core::FS::ReadAhead::reset (int64_t offset) {
+    for (auto chunk : this->ring) {
+      if (chunk->done) {
+        this->desc->core->fs.buffers.release(chunk->bytes);
+        delete chunk;
+      } else {
+        chunk->discarded = true;
       }
+    }
 
-      if (desc->isDirectory()) {
-        queued++;
-        this->closedir(seq, id, [pending, cb](auto seq, auto json, auto post) {
-          if (pending == 0) {
-            cb(seq, json, post);
-          }
-        });
-      } else if (desc->isFile()) {
-        queued++;
-        this->close(seq, id, [pending, cb](auto seq, auto json, auto post) {
-          if (pending == 0) {
-            cb(seq, json, post);
-          }
+    this->ring.clear();
+    this->generation++;
+    this->next = offset;
+    this->eof = false;
+  }
+
+  void Core::FS::ReadAhead::invalidate () {
+    if (this->stopped) {
+      return;
+    }
+
+    // chunks read before a write to the file may hold stale bytes, the
+    // ring is read again from the same position
+    auto offset = this->ring.size() > 0 ? this->ring.front()->offset : this->next;
+    this->reset(offset);
+    this->fill();
+  }
+
+  void Core::FS::ReadAhead::stop (std::function<void()> cb) {
+    this->stopped = true;
+
+    // every caller is notified, a stop already waiting on reads included
+    if (cb != nullptr) {
+      this->onstop.push_back(cb);
+    }
+
+    // the descriptor is not closed under reads still in flight
+    if (this->active == 0) {
+      this->finish();
+    }
+  }
+
+  void Core::FS::ReadAhead::finish () {
+    auto onstop = this->onstop;
+
+    this->reset(0);
+    this->desc->readAhead = nullptr;
+    delete this;
+
+    for (const auto& callback : onstop) {
+      callback();
+    }
+  }
+
+  JSON::Object Core::FS::ReadAhead::json () {
+    return JSON::Object::Entries {
+      {"id", std::to_string(this->desc->id)},
+      {"size", (uint64_t) this->size},
+      {"window", (uint64_t) this->window},
+      {"hits", this->hits},
+      {"stalls", this->stalls},
+      {"misses", this->misses},
+      {"stallTime", (double) this->stallTime / 1e6}
+    };
+  }
+
+  void Core::FS::readAhead (
+    const String seq,
+    uint64_t id,
+    size_t size,
+    int window,
+    int64_t offset,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.readAhead"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto ahead = desc->readAhead;
+
+      // a negative window only queries the current read-ahead
+      if (window < 0 || (window == 0 && ahead == nullptr)) {
+        auto data = ahead != nullptr ? ahead->json() : JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"window", 0}
+        };
+
+        auto json = JSON::Object::Entries {
+          {"source", "fs.readAhead"},
+          {"data", data}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      if (window == 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.readAhead"},
+          {"data", ahead->json()}
+        };
+
+        return ahead->stop([=]() {
+          cb(seq, json, Post{});
         });
       }
-    }
 
-    if (queued == 0) {
+      if (ahead == nullptr) {
+        ahead = new ReadAhead();
+        ahead->desc = desc;
+        desc->readAhead = ahead;
+
+        // let the kernel read ahead as well, chunks are then mostly copies
+        // out of the page cache
+      #if defined(__linux__)
+        posix_fadvise(desc->fd, offset, 0, POSIX_FADV_SEQUENTIAL);
+      #elif defined(__APPLE__)
+        fcntl(desc->fd, F_RDAHEAD, 1);
+      #endif
+      }
+
+      ahead->size = std::max(size, (size_t) 1);
+      ahead->window = (size_t) window;
+      ahead->reset(offset);
+      ahead->fill();
+
+      auto json = JSON::Object::Entries {
+        {"source", "fs.readAhead"},
+        {"data", ahead->json()}
+      };
+
       cb(seq, json, Post{});
-    }
+    });
   }
 
   void Core::FS::read (
@@ -893,10 +2193,46 @@ namespace SSC {
         return cb(seq, json, Post{});
       }
 
+      // reads see writes still buffered on the descriptor
+      if (desc->writeBehind != nullptr && desc->writeBehind->queued > 0) {
+        return desc->writeBehind->flush([=, this](int) {
+          this->read(seq, id, size, offset, cb);
+        });
+      }
+
+      // sequential reads are served from chunks read ahead of them
+      if (desc->readAhead != nullptr && desc->readAhead->read(seq, size, offset, cb)) {
+        return;
+      }
+
+      // ranges of mapped files are lent to the reply without a read or a
+      // copy, the mapping outlives `munmap()` and close until it is released
+      if (desc->isMapped() && (int64_t) offset >= 0) {
+        Lock lock(desc->mutex);
+        auto mapping = desc->mapping;
+
+        if (mapping != nullptr && offset < mapping->size) {
+          auto length = std::min(size, mapping->size - offset);
+          auto headers = Headers {{
+            {"content-type" ,"application/octet-stream"},
+            {"content-length", (uint64_t) length}
+          }};
+
+          Post post;
+          post.id = SSC::rand64();
+          post.body = mapping->bytes + offset;
+          post.length = length;
+          post.headers = headers.str();
+
+          this->buffers.lend(post.body, mapping);
+          return cb(seq, JSON::Object {}, post);
+        }
+      }
+
       auto loop = &this->core->eventLoop;
       auto ctx = new RequestContext(desc, seq, cb);
       auto req = &ctx->req;
-      auto bytes = new char[size]{0};
+      auto bytes = this->buffers.acquire(size);
 
       ctx->setBuffer(0, size, bytes);
 
@@ -916,10 +2252,7 @@ namespace SSC {
             }}
           };
 
-          auto bytes = ctx->getBuffer(0);
-          if (bytes != nullptr) {
-            delete [] bytes;
-          }
+          desc->core->fs.buffers.release(ctx->getBuffer(0));
         } else {
           auto headers = Headers {{
             {"content-type" ,"application/octet-stream"},
@@ -947,18 +2280,96 @@ namespace SSC {
         };
 
         ctx->cb(ctx->seq, json, Post{});
-        delete [] bytes;
+        this->buffers.release(bytes);
         delete ctx;
       }
     });
   }
 
-  void Core::FS::write (
+  // files that do not report a size (procfs, pipes) start with this buffer
+  // size and grow until EOF
+  static constexpr size_t DEFAULT_READ_FILE_BUFFER_SIZE = 64 * 1024;
+
+  static void readFileChunk (Core::FS::RequestContext *ctx) {
+    auto desc = ctx->desc;
+    auto loop = desc->core->getEventLoop();
+    auto pool = &desc->core->fs.buffers;
+
+    if (ctx->bytes == ctx->getBufferSize(0)) {
+      auto size = ctx->getBufferSize(0) * 2;
+      auto bytes = pool->acquire(size);
+      memcpy(bytes, ctx->getBuffer(0), ctx->bytes);
+      pool->release(ctx->getBuffer(0));
+      ctx->setBuffer(0, size, bytes);
+    }
+
+    ctx->setBuffer(1, ctx->getBufferSize(0) - ctx->bytes, ctx->getBuffer(0) + ctx->bytes);
+
+    auto err = uv_fs_read(loop, &ctx->req, desc->fd, &ctx->iov[1], 1, -1, [](uv_fs_t* req) {
+      auto ctx = static_cast<Core::FS::RequestContext*>(req->data);
+      auto desc = ctx->desc;
+      auto result = req->result;
+
+      uv_fs_req_cleanup(req);
+
+      if (result < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.readFile"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(desc->id)},
+            {"code", result},
+            {"message", String(uv_strerror((int) result))}
+          }}
+        };
+
+        desc->core->fs.buffers.release(ctx->getBuffer(0));
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+        return;
+      }
+
+      ctx->bytes += result;
+
+      // done at EOF or once a file of known size has been read in full
+      if (result == 0 || (ctx->size > 0 && ctx->bytes >= ctx->size)) {
+        auto headers = Headers {{
+          {"content-type" ,"application/octet-stream"},
+          {"content-length", (uint64_t) ctx->bytes}
+        }};
+
+        Post post;
+        post.id = SSC::rand64();
+        post.body = ctx->getBuffer(0);
+        post.length = ctx->bytes;
+        post.headers = headers.str();
+
+        ctx->cb(ctx->seq, JSON::Object {}, post);
+        delete ctx;
+        return;
+      }
+
+      readFileChunk(ctx);
+    });
+
+    if (err < 0) {
+      auto json = JSON::Object::Entries {
+        {"source", "fs.readFile"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(desc->id)},
+          {"code", err},
+          {"message", String(uv_strerror(err))}
+        }}
+      };
+
+      pool->release(ctx->getBuffer(0));
+      ctx->cb(ctx->seq, json, Post{});
+      delete ctx;
+    }
+  }
+
+  void Core::FS::readFile (
     const String seq,
     uint64_t id,
-    char *bytes,
-    size_t size,
-    size_t offset,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
@@ -966,7 +2377,7 @@ namespace SSC {
 
       if (desc == nullptr) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.write"},
+          {"source", "fs.readFile"},
           {"err", JSON::Object::Entries {
             {"id", std::to_string(id)},
             {"code", "ENOTOPEN"},
@@ -982,38 +2393,38 @@ namespace SSC {
       auto ctx = new RequestContext(desc, seq, cb);
       auto req = &ctx->req;
 
-      ctx->setBuffer(0, (int) size, bytes);
-      auto err = uv_fs_write(loop, req, desc->fd, ctx->iov, 1, offset, [](uv_fs_t* req) {
+      // a single `fstat()` sizes the one allocation the whole file is read into
+      auto err = uv_fs_fstat(loop, req, desc->fd, [](uv_fs_t* req) {
         auto ctx = static_cast<RequestContext*>(req->data);
         auto desc = ctx->desc;
-        auto json = JSON::Object {};
+        auto result = req->result;
 
-        if (req->result < 0) {
-          json = JSON::Object::Entries {
-            {"source", "fs.write"},
+        ctx->size = result < 0 ? 0 : (size_t) req->statbuf.st_size;
+        uv_fs_req_cleanup(req);
+
+        if (result < 0) {
+          auto json = JSON::Object::Entries {
+            {"source", "fs.readFile"},
             {"err", JSON::Object::Entries {
               {"id", std::to_string(desc->id)},
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
-            }}
-          };
-        } else {
-          json = JSON::Object::Entries {
-            {"source", "fs.write"},
-            {"data", JSON::Object::Entries {
-              {"id", std::to_string(desc->id)},
-              {"result", req->result}
+              {"code", result},
+              {"message", String(uv_strerror((int) result))}
             }}
           };
+
+          ctx->cb(ctx->seq, json, Post{});
+          delete ctx;
+          return;
         }
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
+        auto size = ctx->size > 0 ? ctx->size : DEFAULT_READ_FILE_BUFFER_SIZE;
+        ctx->setBuffer(0, size, desc->core->fs.buffers.acquire(size));
+        readFileChunk(ctx);
       });
 
       if (err < 0) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.write"},
+          {"source", "fs.readFile"},
           {"err", JSON::Object::Entries {
             {"id", std::to_string(desc->id)},
             {"code", err},
@@ -1027,62 +2438,241 @@ namespace SSC {
     });
   }
 
-  void Core::FS::stat (
-    const String seq,
-    const String path,
-    Module::Callback cb
+  int Core::FS::WriteBehind::init () {
+    auto err = uv_timer_init(&this->desc->core->eventLoop, &this->timer);
+    this->timer.data = this;
+    return err;
+  }
+
+  int Core::FS::WriteBehind::write (
+    const char *bytes,
+    size_t size,
+    int64_t offset,
+    Waiter waiter
   ) {
-    this->core->dispatchEventLoop([=, this]() {
-      auto filename = path.c_str();
-      auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
-      auto req = &ctx->req;
-      auto err = uv_fs_stat(loop, req, filename, [](uv_fs_t *req) {
-        auto ctx = (RequestContext *) req->data;
-        auto json = JSON::Object {};
+    auto& buffers = this->desc->core->fs.buffers;
 
-        if (req->result < 0) {
-          json = JSON::Object::Entries {
-            {"source", "fs.stat"},
-            {"err", JSON::Object::Entries {
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
-            }}
-          };
-        } else {
-          json = getStatsJSON("fs.stat", uv_fs_get_statbuf(req));
-        }
+    // callers wait for `stop()` and write to the file directly
+    if (this->stopped) {
+      return UV_ECANCELED;
+    }
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
-      });
+    // an earlier batch failed, the write is dropped and the error reported
+    if (this->error < 0) {
+      auto err = this->error;
+      this->error = 0;
+      return err;
+    }
 
-      if (err < 0) {
-        auto json = JSON::Object::Entries {
-          {"source", "fs.stat"},
-          {"err", JSON::Object::Entries {
-            {"code", err},
-            {"message", String(uv_strerror(err))}
-          }}
-        };
+    // a position of -1 appends at the current position of the file
+    auto contiguous = offset < 0
+      ? this->offset < 0
+      : this->offset >= 0 && offset == this->offset + (int64_t) this->pending;
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
+    if (this->pending > 0 && !contiguous) {
+      this->seal();
+    }
+
+    if (this->pending == 0) {
+      this->offset = offset;
+    }
+
+    while (size > 0) {
+      if (this->blocks.size() == 0 || this->used == this->highWaterMark) {
+        this->blocks.push_back(buffers.acquire(this->highWaterMark));
+        this->used = 0;
+      }
+
+      auto length = std::min(size, this->highWaterMark - this->used);
+      memcpy(this->blocks.back() + this->used, bytes, length);
+
+      this->used += length;
+      this->pending += length;
+      this->queued += length;
+      bytes += length;
+      size -= length;
+    }
+
+    if (this->pending >= this->highWaterMark) {
+      this->seal();
+    } else if (!uv_is_active((uv_handle_t *) &this->timer)) {
+      uv_timer_start(&this->timer, [](uv_timer_t *timer) {
+        auto behind = (WriteBehind *) timer->data;
+        behind->seal();
+      }, this->delay, 0);
+    }
+
+    // the writer is held back until the disk catches up
+    if (this->queued > this->highWaterMark * MAX_QUEUED_BATCHES) {
+      this->batches.back()->waiters.push_back(waiter);
+    } else {
+      waiter(0);
+    }
+
+    return 0;
+  }
+
+  void Core::FS::WriteBehind::seal () {
+    uv_timer_stop(&this->timer);
+
+    if (this->pending == 0) {
+      return;
+    }
+
+    auto batch = new Batch();
+    batch->behind = this;
+    batch->offset = this->offset;
+    batch->size = this->pending;
+    batch->blocks.swap(this->blocks);
+    batch->req.data = batch;
+
+    for (size_t i = 0; i < batch->blocks.size(); ++i) {
+      auto last = i == batch->blocks.size() - 1;
+      auto length = last ? this->used : this->highWaterMark;
+      batch->buffers.push_back(uv_buf_init(batch->blocks[i], (unsigned int) length));
+    }
+
+    this->used = 0;
+    this->pending = 0;
+    this->offset = -1;
+    this->batches.push_back(batch);
+
+    if (this->batches.size() == 1) {
+      this->next();
+    }
+  }
+
+  void Core::FS::WriteBehind::flush (Waiter waiter) {
+    this->seal();
+
+    if (this->batches.size() == 0) {
+      return waiter(0);
+    }
+
+    this->batches.back()->waiters.push_back(waiter);
+  }
+
+  void Core::FS::WriteBehind::next () {
+    auto loop = &this->desc->core->eventLoop;
+    auto batch = this->batches.front();
+
+    this->desc->ref();
+
+    // libuv writes every buffer, splitting at `IOV_MAX` and retrying short
+    // writes, before the batch completes
+    auto err = uv_fs_write(
+      loop,
+      &batch->req,
+      this->desc->fd,
+      batch->buffers.data(),
+      (unsigned int) batch->buffers.size(),
+      batch->offset,
+      [](uv_fs_t *req) {
+        auto batch = (Batch *) req->data;
+        batch->behind->complete(batch);
       }
+    );
+
+    if (err < 0) {
+      batch->req.result = err;
+      this->complete(batch);
+    }
+  }
+
+  void Core::FS::WriteBehind::complete (Batch *batch) {
+    auto desc = this->desc;
+    auto result = (int) batch->req.result;
+
+    if (result < 0 && this->error == 0) {
+      this->error = result;
+    }
+
+    this->batches.pop_front();
+    this->queued -= batch->size;
+    invalidateReadAhead(desc);
+
+    for (auto bytes : batch->blocks) {
+      desc->core->fs.buffers.release(bytes);
+    }
+
+    uv_fs_req_cleanup(&batch->req);
+
+    // waiters see the first error of any batch up to and including theirs
+    for (auto& waiter : batch->waiters) {
+      waiter(this->error);
+    }
+
+    delete batch;
+
+    if (this->batches.size() > 0) {
+      this->next();
+    } else if (this->stopped) {
+      this->finish();
+    }
+
+    desc->unref();
+  }
+
+  void Core::FS::WriteBehind::stop (Waiter waiter) {
+    // every caller is notified once the last batch is written
+    this->onstop.push_back(waiter);
+
+    if (this->stopped) {
+      return;
+    }
+
+    this->stopped = true;
+    this->seal();
+
+    if (this->batches.size() == 0) {
+      this->finish();
+    }
+  }
+
+  void Core::FS::WriteBehind::finish () {
+    auto err = this->error;
+    auto onstop = this->onstop;
+
+    for (auto bytes : this->blocks) {
+      this->desc->core->fs.buffers.release(bytes);
+    }
+
+    this->blocks.clear();
+    this->onstop.clear();
+    this->desc->writeBehind = nullptr;
+
+    // deleted once the timer is closed, nothing refers to it past this point
+    uv_close((uv_handle_t *) &this->timer, [](uv_handle_t *timer) {
+      delete (WriteBehind *) timer->data;
     });
+
+    for (const auto& waiter : onstop) {
+      waiter(err);
+    }
   }
 
-  void Core::FS::fstat (
+  JSON::Object Core::FS::WriteBehind::json () {
+    return JSON::Object::Entries {
+      {"id", std::to_string(this->desc->id)},
+      {"highWaterMark", (uint64_t) this->highWaterMark},
+      {"delay", this->delay},
+      {"queued", (uint64_t) this->queued}
+    };
+  }
+
+  void Core::FS::writeBehind (
     const String seq,
     uint64_t id,
+    size_t highWaterMark,
+    uint64_t delay,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
       auto desc = getDescriptor(id);
 
-      if (desc == nullptr) {
+      if (desc == nullptr || !desc->isFile()) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.fstat"},
+          {"source", "fs.writeBehind"},
           {"err", JSON::Object::Entries {
             {"id", std::to_string(id)},
             {"code", "ENOTOPEN"},
@@ -1094,150 +2684,253 @@ namespace SSC {
         return cb(seq, json, Post{});
       }
 
-      auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(desc, seq, cb);
-      auto req = &ctx->req;
-      auto err = uv_fs_fstat(loop, req, desc->fd, [](uv_fs_t *req) {
-        auto ctx = (RequestContext *) req->data;
-        auto desc = ctx->desc;
-        auto json = JSON::Object {};
+      auto behind = desc->writeBehind;
 
-        if (req->result < 0) {
-          json = JSON::Object::Entries {
-            {"source", "fs.fstat"},
-            {"err", JSON::Object::Entries {
-              {"id", std::to_string(desc->id)},
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
+      // a zero `highWaterMark` flushes and stops buffering writes
+      if (highWaterMark == 0) {
+        if (behind == nullptr) {
+          auto json = JSON::Object::Entries {
+            {"source", "fs.writeBehind"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(id)},
+              {"highWaterMark", 0}
             }}
           };
-        } else {
-          json = getStatsJSON("fs.fstat", uv_fs_get_statbuf(req));
-        }
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
-      });
+          return cb(seq, json, Post{});
+        }
 
-      if (err < 0) {
-        auto json = JSON::Object::Entries {
-          {"source", "fs.fstat"},
-          {"err", JSON::Object::Entries {
-            {"id", std::to_string(id)},
-            {"code", err},
-            {"message", String(uv_strerror(err))}
-          }}
-        };
+        return behind->stop([=](int err) {
+          auto json = JSON::Object {};
+
+          if (err < 0) {
+            json = JSON::Object::Entries {
+              {"source", "fs.writeBehind"},
+              {"err", JSON::Object::Entries {
+                {"id", std::to_string(id)},
+                {"code", err},
+                {"message", String(uv_strerror(err))}
+              }}
+            };
+          } else {
+            json = JSON::Object::Entries {
+              {"source", "fs.writeBehind"},
+              {"data", JSON::Object::Entries {
+                {"id", std::to_string(id)},
+                {"highWaterMark", 0}
+              }}
+            };
+          }
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
+          cb(seq, json, Post{});
+        });
       }
-    });
-  }
 
-  void Core::FS::getOpenDescriptors (
-    const String seq,
-    Module::Callback cb
-  ) {
-    Lock lock(this->mutex);
-    auto entries = Vector<JSON::Any> {};
+      if (behind == nullptr) {
+        behind = new WriteBehind();
+        behind->desc = desc;
 
-    for (auto const &tuple : descriptors) {
-      auto desc = tuple.second;
+        auto err = behind->init();
 
-      if (!desc || (desc->isStale() && !desc->isRetained())) {
-        continue;
-      }
+        if (err < 0) {
+          delete behind;
 
-      auto entry = JSON::Object::Entries {
-        {"id",  std::to_string(desc->id)},
-        {"fd", std::to_string(desc->isDirectory() ? desc->id : desc->fd)},
-        {"type", desc->dir ? "directory" : "file"}
-      };
+          auto json = JSON::Object::Entries {
+            {"source", "fs.writeBehind"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(id)},
+              {"code", err},
+              {"message", String(uv_strerror(err))}
+            }}
+          };
 
-      entries.push_back(entry);
-    }
+          return cb(seq, json, Post{});
+        }
 
-    auto json = JSON::Object::Entries {
-      {"source", "fs.getOpenDescriptors"},
-      {"data", entries}
-    };
+        desc->writeBehind = behind;
+      } else if (behind->stopped) {
+        // a stopping write-behind is replaced once its batches are written
+        return behind->stop([=, this](int) {
+          this->writeBehind(seq, id, highWaterMark, delay, cb);
+        });
+      } else {
+        // blocks are sized by the previous `highWaterMark`
+        behind->seal();
+      }
 
-    cb(seq, json, Post{});
+      behind->highWaterMark = highWaterMark;
+      behind->delay = delay;
+
+      auto json = JSON::Object::Entries {
+        {"source", "fs.writeBehind"},
+        {"data", behind->json()}
+      };
+
+      cb(seq, json, Post{});
+    });
   }
 
-  void Core::FS::lstat (
+  void Core::FS::flush (
     const String seq,
-    const String path,
+    uint64_t id,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
-      auto filename = path.c_str();
-      auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
-      auto req = &ctx->req;
-      auto err = uv_fs_lstat(loop, req, filename, [](uv_fs_t* req) {
-        auto ctx = (RequestContext *) req->data;
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.flush"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto reply = [=](int err) {
         auto json = JSON::Object {};
 
-        if (req->result < 0) {
+        if (err < 0) {
           json = JSON::Object::Entries {
-            {"source", "fs.stat"},
+            {"source", "fs.flush"},
             {"err", JSON::Object::Entries {
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
+              {"id", std::to_string(id)},
+              {"code", err},
+              {"message", String(uv_strerror(err))}
             }}
           };
         } else {
-          json = getStatsJSON("fs.lstat", uv_fs_get_statbuf(req));
+          json = JSON::Object::Entries {
+            {"source", "fs.flush"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(id)}
+            }}
+          };
         }
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
-      });
-
-      if (err < 0) {
-        auto json = JSON::Object::Entries {
-          {"source", "fs.stat"},
-          {"err", JSON::Object::Entries {
-            {"code", err},
-            {"message", String(uv_strerror(err))}
-          }}
-        };
+        cb(seq, json, Post{});
+      };
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
+      if (desc->writeBehind == nullptr) {
+        return reply(0);
       }
+
+      auto behind = desc->writeBehind;
+
+      // the error is reported once, to whoever flushes first
+      behind->flush([behind, reply](int err) {
+        behind->error = 0;
+        reply(err);
+      });
     });
   }
 
-  void Core::FS::unlink (
+  void Core::FS::write (
     const String seq,
-    const String path,
+    uint64_t id,
+    char *bytes,
+    size_t size,
+    size_t offset,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
-      auto filename = path.c_str();
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.write"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // writes issued while buffering stops land after the buffered ones
+      if (desc->writeBehind != nullptr && desc->writeBehind->stopped) {
+        return desc->writeBehind->stop([=, this](int) {
+          this->write(seq, id, bytes, size, offset, cb);
+        });
+      }
+
+      // buffered writes are acknowledged once copied, see `WriteBehind`
+      if (desc->writeBehind != nullptr) {
+        auto behind = desc->writeBehind;
+        auto reply = [=](int err) {
+          auto json = JSON::Object {};
+
+          if (err < 0) {
+            behind->error = 0;
+            json = JSON::Object::Entries {
+              {"source", "fs.write"},
+              {"err", JSON::Object::Entries {
+                {"id", std::to_string(id)},
+                {"code", err},
+                {"message", String(uv_strerror(err))}
+              }}
+            };
+          } else {
+            json = JSON::Object::Entries {
+              {"source", "fs.write"},
+              {"data", JSON::Object::Entries {
+                {"id", std::to_string(id)},
+                {"result", (uint64_t) size}
+              }}
+            };
+          }
+
+          cb(seq, json, Post{});
+        };
+
+        auto err = behind->write(bytes, size, (int64_t) offset, reply);
+
+        if (err < 0) {
+          reply(err);
+        } else {
+          auto buffer = uv_buf_init(bytes, (unsigned int) size);
+          desc->hashWritten(&buffer, 1, size, (int64_t) offset);
+        }
+
+        return;
+      }
+
       auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
+      auto ctx = new RequestContext(desc, seq, cb);
       auto req = &ctx->req;
-      auto err = uv_fs_unlink(loop, req, filename, [](uv_fs_t* req) {
-        auto ctx = (RequestContext *) req->data;
+
+      ctx->setBuffer(0, (int) size, bytes);
+      auto err = uv_fs_write(loop, req, desc->fd, ctx->iov, 1, offset, [](uv_fs_t* req) {
+        auto ctx = static_cast<RequestContext*>(req->data);
+        auto desc = ctx->desc;
         auto json = JSON::Object {};
 
+        invalidateReadAhead(desc);
+
         if (req->result < 0) {
           json = JSON::Object::Entries {
-            {"source", "fs.unlink"},
+            {"source", "fs.write"},
             {"err", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
               {"code", req->result},
               {"message", String(uv_strerror((int) req->result))}
             }}
           };
         } else {
+          desc->hashWritten(ctx->iov, 1, (size_t) req->result, req->off);
           json = JSON::Object::Entries {
-            {"source", "fs.unlink"},
+            {"source", "fs.write"},
             {"data", JSON::Object::Entries {
-              {"result", req->result},
+              {"id", std::to_string(desc->id)},
+              {"result", req->result}
             }}
           };
         }
@@ -1248,8 +2941,9 @@ namespace SSC {
 
       if (err < 0) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.unlink"},
+          {"source", "fs.write"},
           {"err", JSON::Object::Entries {
+            {"id", std::to_string(desc->id)},
             {"code", err},
             {"message", String(uv_strerror(err))}
           }}
@@ -1261,201 +2955,500 @@ namespace SSC {
     });
   }
 
-  void Core::FS::rename (
-    const String seq,
-    const String pathA,
-    const String pathB,
-    const Module::Callback cb
-  ) {
-    this->core->dispatchEventLoop([=, this]() {
-      auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
-      auto req = &ctx->req;
-      auto src = pathA.c_str();
-      auto dst = pathB.c_str();
-      auto err = uv_fs_rename(loop, req, src, dst, [](uv_fs_t* req) {
-        auto ctx = (RequestContext *) req->data;
-        auto json = JSON::Object {};
+  static void writeFileChunk (Core::FS::RequestContext *ctx) {
+    auto desc = ctx->desc;
+    auto loop = desc->core->getEventLoop();
 
-        if (req->result < 0) {
-          json = JSON::Object::Entries {
-            {"source", "fs.rename"},
-            {"err", JSON::Object::Entries {
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
-            }}
-          };
-        } else {
-          json = JSON::Object::Entries {
-            {"source", "fs.rename"},
-            {"data", JSON::Object::Entries {
-              {"result", req->result},
-            }}
-          };
-        }
+    if (ctx->bytes >= ctx->size) {
+      auto json = JSON::Object::Entries {
+        {"source", "fs.writeFile"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(desc->id)},
+          {"result", (uint64_t) ctx->bytes}
+        }}
+      };
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
-      });
+      ctx->cb(ctx->seq, json, Post{});
+      delete ctx;
+      return;
+    }
 
-      if (err < 0) {
+    ctx->setBuffer(1, ctx->size - ctx->bytes, ctx->getBuffer(0) + ctx->bytes);
+
+    auto err = uv_fs_write(loop, &ctx->req, desc->fd, &ctx->iov[1], 1, -1, [](uv_fs_t* req) {
+      auto ctx = static_cast<Core::FS::RequestContext*>(req->data);
+      auto desc = ctx->desc;
+      auto result = req->result;
+
+      uv_fs_req_cleanup(req);
+      invalidateReadAhead(desc);
+
+      if (result < 0) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.rename"},
+          {"source", "fs.writeFile"},
           {"err", JSON::Object::Entries {
-            {"code", err},
-            {"message", String(uv_strerror(err))}
+            {"id", std::to_string(desc->id)},
+            {"code", result},
+            {"message", String(uv_strerror((int) result))}
           }}
         };
 
         ctx->cb(ctx->seq, json, Post{});
         delete ctx;
+        return;
       }
+
+      desc->hashWritten(&ctx->iov[1], 1, (size_t) result, -1);
+      ctx->bytes += result;
+      writeFileChunk(ctx);
     });
+
+    if (err < 0) {
+      auto json = JSON::Object::Entries {
+        {"source", "fs.writeFile"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(desc->id)},
+          {"code", err},
+          {"message", String(uv_strerror(err))}
+        }}
+      };
+
+      ctx->cb(ctx->seq, json, Post{});
+      delete ctx;
+    }
   }
 
-  void Core::FS::copyFile (
+  void Core::FS::writeFile (
     const String seq,
-    const String pathA,
-    const String pathB,
-    int flags,
+    uint64_t id,
+    char *bytes,
+    size_t size,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
-      auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
-      auto req = &ctx->req;
-      auto src = pathA.c_str();
-      auto dst = pathB.c_str();
-      auto err = uv_fs_copyfile(loop, req, src, dst, flags, [](uv_fs_t* req) {
-        auto ctx = (RequestContext *) req->data;
-        auto json = JSON::Object {};
-
-        if (req->result < 0) {
-          json = JSON::Object::Entries {
-            {"source", "fs.copyFile"},
-            {"err", JSON::Object::Entries {
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
-            }}
-          };
-        } else {
-          json = JSON::Object::Entries {
-            {"source", "fs.copyFile"},
-            {"data", JSON::Object::Entries {
-              {"result", req->result},
-            }}
-          };
-        }
-
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
-      });
+      auto desc = getDescriptor(id);
 
-      if (err < 0) {
+      if (desc == nullptr) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.copyFile"},
+          {"source", "fs.writeFile"},
           {"err", JSON::Object::Entries {
-            {"code", err},
-            {"message", String(uv_strerror(err))}
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
           }}
         };
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
+        return cb(seq, json, Post{});
       }
+
+      // `bytes` are owned by the caller until `cb` is called with the
+      // single reply for the whole write loop
+      auto ctx = new RequestContext(desc, seq, cb);
+      ctx->setBuffer(0, size, bytes);
+      ctx->size = size;
+      writeFileChunk(ctx);
     });
   }
 
-  void Core::FS::rmdir (
+  /**
+   * Writes `bytes` to a temporary file next to `path`, syncs its data and
+   * renames it over `path`, so readers see either the old or the new file.
+   * Runs synchronously on a threadpool worker.
+   */
+  static int writeFileDurably (
+    const String& path,
+    const String& temporary,
+    char *bytes,
+    size_t size,
+    int mode
+  ) {
+    uv_fs_t req;
+    auto flags = UV_FS_O_WRONLY | UV_FS_O_CREAT | UV_FS_O_EXCL;
+    auto fd = uv_fs_open(nullptr, &req, temporary.c_str(), flags, mode, nullptr);
+    uv_fs_req_cleanup(&req);
+
+    if (fd < 0) {
+      return fd;
+    }
+
+    size_t written = 0;
+    int err = 0;
+
+    while (written < size) {
+      auto buf = uv_buf_init(bytes + written, (unsigned int) (size - written));
+      auto result = uv_fs_write(nullptr, &req, fd, &buf, 1, (int64_t) written, nullptr);
+      uv_fs_req_cleanup(&req);
+
+      if (result < 0) {
+        err = result;
+        break;
+      }
+
+      written += result;
+    }
+
+    if (err == 0) {
+      err = uv_fs_fdatasync(nullptr, &req, fd, nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+
+    auto closed = uv_fs_close(nullptr, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
+
+    if (err == 0) {
+      err = closed;
+    }
+
+    if (err == 0) {
+      err = uv_fs_rename(nullptr, &req, temporary.c_str(), path.c_str(), nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+
+    if (err < 0) {
+      uv_fs_unlink(nullptr, &req, temporary.c_str(), nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+
+    return err;
+  }
+
+  // makes a rename into `directory` durable, see rename(2)
+  static int syncDirectory (const String& directory) {
+  #if defined(_WIN32)
+    // directories cannot be opened for syncing, NTFS journals the rename
+    return 0;
+  #else
+    uv_fs_t req;
+    auto fd = uv_fs_open(nullptr, &req, directory.c_str(), UV_FS_O_RDONLY, 0, nullptr);
+    uv_fs_req_cleanup(&req);
+
+    if (fd < 0) {
+      return fd;
+    }
+
+    auto err = uv_fs_fsync(nullptr, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
+    uv_fs_close(nullptr, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
+    return err;
+  #endif
+  }
+
+  /**
+   * Directory syncs shared by atomic writes into the same directory. Writes
+   * finishing within `window` milliseconds of each other wait for a single
+   * directory sync, started once the window closes.
+   */
+  struct Core::FS::GroupCommit {
+    using Waiter = std::function<void(int)>;
+
+    Core *core = nullptr;
+    String directory;
+    uint64_t window = 0;
+    Vector<Waiter> waiters;
+    Vector<Waiter> syncing;
+    uv_timer_t timer;
+    uv_work_t work;
+    int result = 0;
+    bool running = false;
+
+    void add (uint64_t window, Waiter waiter);
+    void schedule ();
+    void sync ();
+    void release ();
+  };
+
+  void Core::FS::GroupCommit::add (uint64_t window, Waiter waiter) {
+    this->window = window;
+    this->waiters.push_back(waiter);
+    this->schedule();
+  }
+
+  void Core::FS::GroupCommit::schedule () {
+    // writes arriving during a sync wait for the next one
+    if (this->running || uv_is_active((uv_handle_t *) &this->timer)) {
+      return;
+    }
+
+    uv_timer_start(&this->timer, [](uv_timer_t *timer) {
+      auto commit = (GroupCommit *) timer->data;
+      commit->sync();
+    }, this->window, 0);
+  }
+
+  void Core::FS::GroupCommit::sync () {
+    auto loop = &this->core->eventLoop;
+
+    this->running = true;
+    this->syncing.swap(this->waiters);
+
+    auto err = uv_queue_work(loop, &this->work, [](uv_work_t *req) {
+      auto commit = (GroupCommit *) req->data;
+      commit->result = syncDirectory(commit->directory);
+    }, [](uv_work_t *req, int status) {
+      auto commit = (GroupCommit *) req->data;
+      auto result = status < 0 ? status : commit->result;
+      auto syncing = Vector<Waiter> {};
+
+      commit->running = false;
+      syncing.swap(commit->syncing);
+
+      for (auto& waiter : syncing) {
+        waiter(result);
+      }
+
+      if (commit->waiters.size() > 0) {
+        commit->schedule();
+      } else {
+        commit->release();
+      }
+    });
+
+    if (err < 0) {
+      auto syncing = Vector<Waiter> {};
+      this->running = false;
+      syncing.swap(this->syncing);
+
+      for (auto& waiter : syncing) {
+        waiter(err);
+      }
+
+      if (this->waiters.size() > 0) {
+        this->schedule();
+      } else {
+        this->release();
+      }
+    }
+  }
+
+  void Core::FS::GroupCommit::release () {
+    // a later write into the directory starts a new group
+    do {
+      Lock lock(this->core->fs.mutex);
+      this->core->fs.commits.erase(this->directory);
+    } while (0);
+
+    uv_close((uv_handle_t *) &this->timer, [](uv_handle_t *timer) {
+      delete (GroupCommit *) timer->data;
+    });
+  }
+
+  void Core::FS::writeFileAtomic (
     const String seq,
     const String path,
+    char *bytes,
+    size_t size,
+    int mode,
+    uint64_t groupCommit,
     Module::Callback cb
   ) {
+    struct AtomicWrite {
+      uv_work_t req;
+      Core *core = nullptr;
+      String seq;
+      Module::Callback cb;
+      String path;
+      String directory;
+      String temporary;
+      char *bytes = nullptr;
+      size_t size = 0;
+      int mode = 0;
+      uint64_t groupCommit = 0;
+      int result = 0;
+    };
+
     this->core->dispatchEventLoop([=, this]() {
-      auto filename = path.c_str();
       auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
-      auto req = &ctx->req;
-      auto err = uv_fs_rmdir(loop, req, filename, [](uv_fs_t* req) {
-        auto ctx = (RequestContext *) req->data;
-        auto json = JSON::Object {};
+      auto write = new AtomicWrite();
+      auto slash = path.find_last_of("/\\");
+      auto name = slash == String::npos ? path : path.substr(slash + 1);
+
+      write->core = this->core;
+      write->seq = seq;
+      write->cb = cb;
+      write->path = path;
+      write->directory = slash == String::npos
+        ? String(".")
+        : slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+      write->temporary = write->directory + "/." + name + "." + std::to_string(SSC::rand64()) + ".tmp";
+      // `bytes` are owned by the caller until `cb` is called
+      write->bytes = bytes;
+      write->size = size;
+      write->mode = mode;
+      write->groupCommit = groupCommit;
+      write->req.data = write;
+
+      auto err = uv_queue_work(loop, &write->req, [](uv_work_t *req) {
+        auto write = (AtomicWrite *) req->data;
+        write->result = writeFileDurably(
+          write->path,
+          write->temporary,
+          write->bytes,
+          write->size,
+          write->mode
+        );
+
+        if (write->result == 0 && write->groupCommit == 0) {
+          write->result = syncDirectory(write->directory);
+        }
+      }, [](uv_work_t *req, int status) {
+        auto write = (AtomicWrite *) req->data;
+        auto result = status < 0 ? status : write->result;
+        auto core = write->core;
+
+        auto reply = [write](int err) {
+          auto json = JSON::Object {};
+
+          if (err < 0) {
+            json = JSON::Object::Entries {
+              {"source", "fs.writeFileAtomic"},
+              {"err", JSON::Object::Entries {
+                {"code", err},
+                {"message", String(uv_strerror(err))}
+              }}
+            };
+          } else {
+            json = JSON::Object::Entries {
+              {"source", "fs.writeFileAtomic"},
+              {"data", JSON::Object::Entries {
+                {"result", (uint64_t) write->size}
+              }}
+            };
+          }
 
-        if (req->result < 0) {
-          json = JSON::Object::Entries {
-            {"source", "fs.rmdir"},
-            {"err", JSON::Object::Entries {
-              {"code", req->result},
-              {"message", String(uv_strerror((int) req->result))}
-            }}
-          };
-        } else {
-          json = JSON::Object::Entries {
-            {"source", "fs.rmdir"},
-            {"data", JSON::Object::Entries {
-              {"result", req->result},
-            }}
-          };
+          write->cb(write->seq, json, Post{});
+          delete write;
+        };
+
+        if (result < 0 || write->groupCommit == 0) {
+          return reply(result);
         }
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
+        GroupCommit *commit = nullptr;
+
+        do {
+          Lock lock(core->fs.mutex);
+          auto& commits = core->fs.commits;
+
+          if (commits.find(write->directory) == commits.end()) {
+            commit = new GroupCommit();
+            commit->core = core;
+            commit->directory = write->directory;
+            commit->timer.data = commit;
+            commit->work.data = commit;
+            uv_timer_init(&core->eventLoop, &commit->timer);
+            commits.insert_or_assign(write->directory, commit);
+          } else {
+            commit = commits.at(write->directory);
+          }
+        } while (0);
+
+        commit->add(write->groupCommit, reply);
       });
 
       if (err < 0) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.rmdir"},
+          {"source", "fs.writeFileAtomic"},
           {"err", JSON::Object::Entries {
             {"code", err},
             {"message", String(uv_strerror(err))}
           }}
         };
 
-        ctx->cb(ctx->seq, json, Post{});
-        delete ctx;
+        delete write;
+        cb(seq, json, Post{});
       }
     });
   }
 
-  void Core::FS::mkdir (
+  void Core::FS::fsync (
     const String seq,
-    const String path,
-    int mode,
+    uint64_t id,
+    bool datasync,
     Module::Callback cb
   ) {
+    auto source = String(datasync ? "fs.fdatasync" : "fs.fsync");
+
     this->core->dispatchEventLoop([=, this]() {
-      auto filename = path.c_str();
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", source},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // writes buffered on the descriptor are part of what is synced
+      if (desc->writeBehind != nullptr && desc->writeBehind->queued > 0) {
+        auto behind = desc->writeBehind;
+        return behind->flush([=, this](int err) {
+          if (err == 0) {
+            return this->fsync(seq, id, datasync, cb);
+          }
+
+          auto json = JSON::Object::Entries {
+            {"source", source},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(id)},
+              {"code", err},
+              {"message", String(uv_strerror(err))}
+            }}
+          };
+
+          behind->error = 0;
+          cb(seq, json, Post{});
+        });
+      }
+
       auto loop = &this->core->eventLoop;
-      auto ctx = new RequestContext(seq, cb);
+      auto ctx = new RequestContext(desc, seq, cb);
       auto req = &ctx->req;
-      auto err = uv_fs_mkdir(loop, req, filename, mode, [](uv_fs_t* req) {
+      auto callback = [](uv_fs_t *req) {
         auto ctx = (RequestContext *) req->data;
+        auto desc = ctx->desc;
+        auto source = req->fs_type == UV_FS_FDATASYNC ? "fs.fdatasync" : "fs.fsync";
         auto json = JSON::Object {};
 
         if (req->result < 0) {
           json = JSON::Object::Entries {
-            {"source", "fs.mkdir"},
+            {"source", source},
             {"err", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
               {"code", req->result},
               {"message", String(uv_strerror((int) req->result))}
             }}
           };
         } else {
           json = JSON::Object::Entries {
-            {"source", "fs.mkdir"},
+            {"source", source},
             {"data", JSON::Object::Entries {
-              {"result", req->result},
+              {"id", std::to_string(desc->id)}
             }}
           };
         }
 
         ctx->cb(ctx->seq, json, Post{});
         delete ctx;
-      });
+      };
+
+      auto err = datasync
+        ? uv_fs_fdatasync(loop, req, desc->fd, callback)
+        : uv_fs_fsync(loop, req, desc->fd, callback);
 
       if (err < 0) {
         auto json = JSON::Object::Entries {
-          {"source", "fs.mkdir"},
+          {"source", source},
           {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
             {"code", err},
             {"message", String(uv_strerror(err))}
           }}
@@ -1467,24 +3460,2898 @@ namespace SSC {
     });
   }
 
-  void Core::FS::constants (const String seq, Module::Callback cb) {
-    static auto constants = getFSConstantsMap();
+  /**
+   * Allocates or releases disk space for `length` bytes at `offset` of a
+   * file. Runs synchronously on a threadpool worker.
+   *   "allocate"   reserves the range and extends the file to cover it
+   *   "keep-size"  reserves the range without changing the file size
+   *   "punch-hole" releases the range, reads of it return zeros
+   */
+  static int allocateFileSpace (
+    uv_file fd,
+    int64_t offset,
+    int64_t length,
+    const String& mode
+  ) {
+  #if defined(__linux__)
+    int flags = 0;
 
-    this->core->dispatchEventLoop([=] {
-      JSON::Object::Entries data;
+    if (mode == "keep-size") {
+      flags = FALLOC_FL_KEEP_SIZE;
+    } else if (mode == "punch-hole") {
+      flags = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+    }
 
-      for (auto const &tuple : constants) {
-        auto key = tuple.first;
-        auto value = tuple.second;
-        data[key] = value;
+    if (::fallocate(fd, flags, offset, length) == 0) {
+      return 0;
+    }
+
+    // file systems without fallocate(2) still support extending a file
+    if (errno == EOPNOTSUPP && mode == "allocate") {
+      return -posix_fallocate(fd, offset, length);
+    }
+
+    return uv_translate_sys_error(errno);
+  #elif defined(__APPLE__)
+    if (mode == "punch-hole") {
+      fpunchhole_t hole = { 0, 0, offset, length };
+      if (fcntl(fd, F_PUNCHHOLE, &hole) != 0) {
+        return uv_translate_sys_error(errno);
       }
 
+      return 0;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      return uv_translate_sys_error(errno);
+    }
+
+    // space is reserved past the end of the file, contiguous if possible
+    if (offset + length > st.st_size) {
+      fstore_t store = {
+        F_ALLOCATECONTIG | F_ALLOCATEALL,
+        F_PEOFPOSMODE,
+        0,
+        offset + length - st.st_size,
+        0
+      };
+
+      if (fcntl(fd, F_PREALLOCATE, &store) != 0) {
+        store.fst_flags = F_ALLOCATEALL;
+        if (fcntl(fd, F_PREALLOCATE, &store) != 0) {
+          return uv_translate_sys_error(errno);
+        }
+      }
+
+      if (mode == "allocate" && ::ftruncate(fd, offset + length) != 0) {
+        return uv_translate_sys_error(errno);
+      }
+    }
+
+    return 0;
+  #else
+    if (mode != "allocate") {
+      return UV_ENOTSUP;
+    }
+
+    uv_fs_t req;
+    auto err = uv_fs_fstat(nullptr, &req, fd, nullptr);
+    auto size = (int64_t) req.statbuf.st_size;
+    uv_fs_req_cleanup(&req);
+
+    if (err == 0 && offset + length > size) {
+      err = uv_fs_ftruncate(nullptr, &req, fd, offset + length, nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+
+    return err;
+  #endif
+  }
+
+  void Core::FS::fallocate (
+    const String seq,
+    uint64_t id,
+    int64_t offset,
+    int64_t length,
+    const String mode,
+    Module::Callback cb
+  ) {
+    struct Allocation {
+      uv_work_t req;
+      Descriptor *desc = nullptr;
+      String seq;
+      Module::Callback cb;
+      int64_t offset = 0;
+      int64_t length = 0;
+      String mode;
+      int result = 0;
+    };
+
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.fallocate"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // buffered writes land before the range is changed under them
+      if (desc->writeBehind != nullptr && desc->writeBehind->queued > 0) {
+        return desc->writeBehind->flush([=, this](int) {
+          this->fallocate(seq, id, offset, length, mode, cb);
+        });
+      }
+
+      auto loop = &this->core->eventLoop;
+      auto allocation = new Allocation();
+      allocation->desc = desc;
+      allocation->seq = seq;
+      allocation->cb = cb;
+      allocation->offset = offset;
+      allocation->length = length;
+      allocation->mode = mode;
+      allocation->req.data = allocation;
+      desc->ref();
+
+      auto err = uv_queue_work(loop, &allocation->req, [](uv_work_t *req) {
+        auto allocation = (Allocation *) req->data;
+        allocation->result = allocateFileSpace(
+          allocation->desc->fd,
+          allocation->offset,
+          allocation->length,
+          allocation->mode
+        );
+      }, [](uv_work_t *req, int status) {
+        auto allocation = (Allocation *) req->data;
+        auto desc = allocation->desc;
+        auto result = status < 0 ? status : allocation->result;
+        auto json = JSON::Object {};
+
+        invalidateReadAhead(desc);
+
+        if (result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.fallocate"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"code", result},
+              {"message", String(uv_strerror(result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.fallocate"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"mode", allocation->mode}
+            }}
+          };
+        }
+
+        allocation->cb(allocation->seq, json, Post{});
+        delete allocation;
+        desc->unref();
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.fallocate"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        delete allocation;
+        desc->unref();
+        cb(seq, json, Post{});
+      }
+    });
+  }
+
+  void Core::FS::ftruncate (
+    const String seq,
+    uint64_t id,
+    int64_t length,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.ftruncate"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // buffered writes land before the file is truncated under them
+      if (desc->writeBehind != nullptr && desc->writeBehind->queued > 0) {
+        return desc->writeBehind->flush([=, this](int) {
+          this->ftruncate(seq, id, length, cb);
+        });
+      }
+
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(desc, seq, cb);
+      auto req = &ctx->req;
+      auto err = uv_fs_ftruncate(loop, req, desc->fd, length, [](uv_fs_t *req) {
+        auto ctx = (RequestContext *) req->data;
+        auto desc = ctx->desc;
+        auto json = JSON::Object {};
+
+        invalidateReadAhead(desc);
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.ftruncate"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.ftruncate"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)}
+            }}
+          };
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.ftruncate"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::truncate (
+    const String seq,
+    const String path,
+    int64_t length,
+    Module::Callback cb
+  ) {
+    struct Truncation {
+      uv_work_t req;
+      String seq;
+      Module::Callback cb;
+      String path;
+      int64_t length = 0;
+      int result = 0;
+    };
+
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = &this->core->eventLoop;
+      auto truncation = new Truncation();
+      truncation->seq = seq;
+      truncation->cb = cb;
+      truncation->path = path;
+      truncation->length = length;
+      truncation->req.data = truncation;
+
+      // libuv has no truncate(2), the file is opened for the duration
+      auto err = uv_queue_work(loop, &truncation->req, [](uv_work_t *req) {
+        auto truncation = (Truncation *) req->data;
+        uv_fs_t fs;
+        auto fd = uv_fs_open(nullptr, &fs, truncation->path.c_str(), UV_FS_O_WRONLY, 0, nullptr);
+        uv_fs_req_cleanup(&fs);
+
+        if (fd < 0) {
+          truncation->result = fd;
+          return;
+        }
+
+        truncation->result = uv_fs_ftruncate(nullptr, &fs, fd, truncation->length, nullptr);
+        uv_fs_req_cleanup(&fs);
+        uv_fs_close(nullptr, &fs, fd, nullptr);
+        uv_fs_req_cleanup(&fs);
+      }, [](uv_work_t *req, int status) {
+        auto truncation = (Truncation *) req->data;
+        auto result = status < 0 ? status : truncation->result;
+        auto json = JSON::Object {};
+
+        if (result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.truncate"},
+            {"err", JSON::Object::Entries {
+              {"code", result},
+              {"message", String(uv_strerror(result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.truncate"},
+            {"data", JSON::Object::Entries {
+              {"path", truncation->path}
+            }}
+          };
+        }
+
+        truncation->cb(truncation->seq, json, Post{});
+        delete truncation;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.truncate"},
+          {"err", JSON::Object::Entries {
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        delete truncation;
+        cb(seq, json, Post{});
+      }
+    });
+  }
+
+  void Core::FS::writev (
+    const String seq,
+    uint64_t id,
+    char *bytes,
+    const Vector<size_t> sizes,
+    int64_t offset,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.writev"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      if (sizes.size() == 0 || sizes.size() > MAX_IOVECS) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.writev"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", UV_EINVAL},
+            {"message", "Expecting between 1 and 16 buffers"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto loop = &this->core->eventLoop;
+      auto ctx = new VectoredRequestContext(desc, seq, cb);
+      auto req = &ctx->req;
+      size_t position = 0;
+
+      // `bytes` holds every buffer back to back, each one becomes an iovec
+      for (size_t i = 0; i < sizes.size(); ++i) {
+        ctx->setBuffer(i, sizes[i], bytes + position);
+        position += sizes[i];
+      }
+
+      auto err = uv_fs_write(loop, req, desc->fd, ctx->iov, sizes.size(), offset, [](uv_fs_t* req) {
+        auto ctx = static_cast<RequestContext*>(req->data);
+        auto desc = ctx->desc;
+        auto json = JSON::Object {};
+
+        invalidateReadAhead(desc);
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.writev"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else {
+          desc->hashWritten(ctx->iov, MAX_IOVECS, (size_t) req->result, req->off);
+          json = JSON::Object::Entries {
+            {"source", "fs.writev"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"result", req->result}
+            }}
+          };
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.writev"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(desc->id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::stat (
+    const String seq,
+    const String path,
+    bool binary,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto filename = path.c_str();
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(seq, cb);
+      auto req = &ctx->req;
+      ctx->binary = binary;
+      auto err = uv_fs_stat(loop, req, filename, [](uv_fs_t *req) {
+        auto ctx = (RequestContext *) req->data;
+        auto json = JSON::Object {};
+        Post post;
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.stat"},
+            {"err", JSON::Object::Entries {
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else if (ctx->binary) {
+          post = getStatsRecordPost(uv_fs_get_statbuf(req));
+        } else {
+          json = getStatsJSON("fs.stat", uv_fs_get_statbuf(req));
+        }
+
+        ctx->cb(ctx->seq, json, post);
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.stat"},
+          {"err", JSON::Object::Entries {
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::statMany (
+    const String seq,
+    const Vector<String> paths,
+    bool binary,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = &this->core->eventLoop;
+
+      if (paths.size() == 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.statMany"},
+          {"data", JSON::Array::Entries {}}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      statBatch(loop, paths, [=](auto batch) {
+        // one record per path, in order, see `writeStatsRecord()`
+        if (binary) {
+          auto size = batch->paths.size() * STATS_RECORD_SIZE;
+          auto bytes = new char[size]{0};
+
+          for (size_t i = 0; i < batch->paths.size(); ++i) {
+            writeStatsRecord(
+              bytes + i * STATS_RECORD_SIZE,
+              batch->results[i],
+              &batch->stats[i]
+            );
+          }
+
+          return cb(seq, JSON::Object {}, getStatsRecordPost(bytes, size));
+        }
+
+        Vector<JSON::Any> data;
+
+        for (size_t i = 0; i < batch->paths.size(); ++i) {
+          data.push_back(getStatBatchEntryJSON(batch, i));
+        }
+
+        auto json = JSON::Object::Entries {
+          {"source", "fs.statMany"},
+          {"data", data}
+        };
+
+        cb(seq, json, Post{});
+      });
+    });
+  }
+
+  void Core::FS::fstat (
+    const String seq,
+    uint64_t id,
+    bool binary,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.fstat"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(desc, seq, cb);
+      auto req = &ctx->req;
+      ctx->binary = binary;
+      auto err = uv_fs_fstat(loop, req, desc->fd, [](uv_fs_t *req) {
+        auto ctx = (RequestContext *) req->data;
+        auto desc = ctx->desc;
+        auto json = JSON::Object {};
+        Post post;
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.fstat"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(desc->id)},
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else if (ctx->binary) {
+          post = getStatsRecordPost(uv_fs_get_statbuf(req));
+        } else {
+          json = getStatsJSON("fs.fstat", uv_fs_get_statbuf(req));
+        }
+
+        ctx->cb(ctx->seq, json, post);
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.fstat"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::getOpenDescriptors (
+    const String seq,
+    Module::Callback cb
+  ) {
+    Lock lock(this->mutex);
+    auto entries = Vector<JSON::Any> {};
+
+    for (auto const desc : descriptors.snapshot()) {
+      if ( (desc->isStale() && !desc->isRetained())) {
+        continue;
+      }
+
+      auto entry = JSON::Object::Entries {
+        {"id",  std::to_string(desc->id)},
+        {"fd", std::to_string(desc->isDirectory() ? desc->id : desc->fd)},
+        {"type", desc->dir ? "directory" : "file"}
+      };
+
+      entries.push_back(entry);
+    }
+
+    auto json = JSON::Object::Entries {
+      {"source", "fs.getOpenDescriptors"},
+      {"data", entries}
+    };
+
+    cb(seq, json, Post{});
+  }
+
+  void Core::FS::lstat (
+    const String seq,
+    const String path,
+    bool binary,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto filename = path.c_str();
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(seq, cb);
+      auto req = &ctx->req;
+      ctx->binary = binary;
+      auto err = uv_fs_lstat(loop, req, filename, [](uv_fs_t* req) {
+        auto ctx = (RequestContext *) req->data;
+        auto json = JSON::Object {};
+        Post post;
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.stat"},
+            {"err", JSON::Object::Entries {
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else if (ctx->binary) {
+          post = getStatsRecordPost(uv_fs_get_statbuf(req));
+        } else {
+          json = getStatsJSON("fs.lstat", uv_fs_get_statbuf(req));
+        }
+
+        ctx->cb(ctx->seq, json, post);
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.stat"},
+          {"err", JSON::Object::Entries {
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::unlink (
+    const String seq,
+    const String path,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto filename = path.c_str();
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(seq, cb);
+      auto req = &ctx->req;
+      auto err = uv_fs_unlink(loop, req, filename, [](uv_fs_t* req) {
+        auto ctx = (RequestContext *) req->data;
+        auto json = JSON::Object {};
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.unlink"},
+            {"err", JSON::Object::Entries {
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.unlink"},
+            {"data", JSON::Object::Entries {
+              {"result", req->result},
+            }}
+          };
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.unlink"},
+          {"err", JSON::Object::Entries {
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::rename (
+    const String seq,
+    const String pathA,
+    const String pathB,
+    const Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(seq, cb);
+      auto req = &ctx->req;
+      auto src = pathA.c_str();
+      auto dst = pathB.c_str();
+      auto err = uv_fs_rename(loop, req, src, dst, [](uv_fs_t* req) {
+        auto ctx = (RequestContext *) req->data;
+        auto json = JSON::Object {};
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.rename"},
+            {"err", JSON::Object::Entries {
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.rename"},
+            {"data", JSON::Object::Entries {
+              {"result", req->result},
+            }}
+          };
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.rename"},
+          {"err", JSON::Object::Entries {
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::copyFile (
+    const String seq,
+    const String pathA,
+    const String pathB,
+    int flags,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(seq, cb);
+      auto req = &ctx->req;
+      auto src = pathA.c_str();
+      auto dst = pathB.c_str();
+      auto err = uv_fs_copyfile(loop, req, src, dst, flags, [](uv_fs_t* req) {
+        auto ctx = (RequestContext *) req->data;
+        auto json = JSON::Object {};
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.copyFile"},
+            {"err", JSON::Object::Entries {
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.copyFile"},
+            {"data", JSON::Object::Entries {
+              {"result", req->result},
+            }}
+          };
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.copyFile"},
+          {"err", JSON::Object::Entries {
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::rmdir (
+    const String seq,
+    const String path,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto filename = path.c_str();
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(seq, cb);
+      auto req = &ctx->req;
+      auto err = uv_fs_rmdir(loop, req, filename, [](uv_fs_t* req) {
+        auto ctx = (RequestContext *) req->data;
+        auto json = JSON::Object {};
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.rmdir"},
+            {"err", JSON::Object::Entries {
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.rmdir"},
+            {"data", JSON::Object::Entries {
+              {"result", req->result},
+            }}
+          };
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.rmdir"},
+          {"err", JSON::Object::Entries {
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::FS::mkdir (
+    const String seq,
+    const String path,
+    int mode,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto filename = path.c_str();
+      auto loop = &this->core->eventLoop;
+      auto ctx = new RequestContext(seq, cb);
+      auto req = &ctx->req;
+      auto err = uv_fs_mkdir(loop, req, filename, mode, [](uv_fs_t* req) {
+        auto ctx = (RequestContext *) req->data;
+        auto json = JSON::Object {};
+
+        if (req->result < 0) {
+          json = JSON::Object::Entries {
+            {"source", "fs.mkdir"},
+            {"err", JSON::Object::Entries {
+              {"code", req->result},
+              {"message", String(uv_strerror((int) req->result))}
+            }}
+          };
+        } else {
+          json = JSON::Object::Entries {
+            {"source", "fs.mkdir"},
+            {"data", JSON::Object::Entries {
+              {"result", req->result},
+            }}
+          };
+        }
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.mkdir"},
+          {"err", JSON::Object::Entries {
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        ctx->cb(ctx->seq, json, Post{});
+        delete ctx;
+      }
+    });
+  }
+
+  // set once by `configureEngine()` before the loop is initialized
+  static String requestedEngine = "default";
+  static bool didSetEngineEnvironment = false;
+
+  String Core::FS::getRequestedEngine () {
+    return requestedEngine;
+  }
+
+  void Core::FS::configureEngine () {
+  #if defined(__linux__) && !defined(__ANDROID__)
+    // libuv reads `UV_USE_IO_URING` when a loop is initialized. With it set,
+    // open, read, write, stat, fsync and close are queued on the loop's ring
+    // and submitted together once per loop iteration instead of handed to
+    // threadpool workers. Kernels without io_uring keep using the threadpool
+    // and libuv does not report which one it picked
+    auto existing = getEnv("UV_USE_IO_URING");
+
+    // a value set by the user is left alone and wins over `SSC_FS_ENGINE`,
+    // without either libuv keeps its own default
+    if (existing.size() > 0) {
+      requestedEngine = std::atoi(existing.c_str()) > 0 ? "io_uring" : "threadpool";
+    } else if (getEnv("SSC_FS_ENGINE") == "io_uring") {
+      requestedEngine = "io_uring";
+      didSetEngineEnvironment = true;
+      setEnv("UV_USE_IO_URING=1");
+    }
+  #endif
+  }
+
+  void Core::FS::restoreEngineEnvironment () {
+  #if defined(__linux__) && !defined(__ANDROID__)
+    // child processes inherit the environment, so the opt-in is only seen
+    // by the loop it was set for
+    if (didSetEngineEnvironment) {
+      didSetEngineEnvironment = false;
+      unsetenv("UV_USE_IO_URING");
+    }
+  #endif
+  }
+
+  void Core::FS::constants (const String seq, Module::Callback cb) {
+    static auto constants = getFSConstantsMap();
+
+    this->core->dispatchEventLoop([=] {
+      JSON::Object::Entries data;
+
+      for (auto const &tuple : constants) {
+        auto key = tuple.first;
+        auto value = tuple.second;
+        data[key] = value;
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "fs.constants"},
+        {"data", data}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  /**
+   * Hashes a whole file on a threadpool worker, one `HASH_READ_SIZE` read
+   * at a time, so only the digest crosses the bridge.
+   */
+  struct HashRequest {
+    // bytes read per step when hashing a file
+    static constexpr size_t HASH_READ_SIZE = 1024 * 1024;
+
+    uv_work_t req;
+    Core *core = nullptr;
+    Core::FS::Descriptor *desc = nullptr;
+    Hash::Hasher *hasher = nullptr;
+    String seq;
+    Core::Module::Callback cb;
+    String source;
+    String path;
+    uint64_t size = 0;
+    int result = 0;
+
+    ~HashRequest () {
+      delete this->hasher;
+    }
+  };
+
+  static void queueHashRequest (HashRequest *request) {
+    auto loop = &request->core->eventLoop;
+    request->req.data = request;
+
+    auto err = uv_queue_work(loop, &request->req, [](uv_work_t *req) {
+      auto request = (HashRequest *) req->data;
+      auto bytes = request->core->fs.buffers.acquire(HashRequest::HASH_READ_SIZE);
+      auto buffer = uv_buf_init(bytes, (unsigned int) HashRequest::HASH_READ_SIZE);
+      uv_file fd = request->desc != nullptr ? request->desc->fd : -1;
+      uv_fs_t fs;
+
+      if (request->desc == nullptr) {
+        fd = uv_fs_open(nullptr, &fs, request->path.c_str(), UV_FS_O_RDONLY, 0, nullptr);
+        uv_fs_req_cleanup(&fs);
+      }
+
+      if (fd < 0) {
+        request->result = fd;
+      }
+
+      // positional reads leave the position of an open descriptor alone
+      while (fd >= 0) {
+        auto result = uv_fs_read(nullptr, &fs, fd, &buffer, 1, (int64_t) request->size, nullptr);
+        uv_fs_req_cleanup(&fs);
+
+        if (result <= 0) {
+          request->result = result;
+          break;
+        }
+
+        request->hasher->update((const unsigned char *) bytes, (size_t) result);
+        request->size += result;
+      }
+
+      if (request->desc == nullptr && fd >= 0) {
+        uv_fs_close(nullptr, &fs, fd, nullptr);
+        uv_fs_req_cleanup(&fs);
+      }
+
+      request->core->fs.buffers.release(bytes);
+    }, [](uv_work_t *req, int status) {
+      auto request = (HashRequest *) req->data;
+      auto result = status < 0 ? status : request->result;
+      auto target = request->desc != nullptr
+        ? JSON::Object::Entries {{"id", std::to_string(request->desc->id)}}
+        : JSON::Object::Entries {{"path", request->path}};
+      auto json = JSON::Object {};
+
+      if (result < 0) {
+        target["code"] = result;
+        target["message"] = String(uv_strerror(result));
+        json = JSON::Object::Entries {
+          {"source", request->source},
+          {"err", target}
+        };
+      } else {
+        target["algorithm"] = request->hasher->name();
+        target["digest"] = Hash::toHex(request->hasher->digest());
+        target["size"] = request->size;
+        json = JSON::Object::Entries {
+          {"source", request->source},
+          {"data", target}
+        };
+      }
+
+      request->cb(request->seq, json, Post{});
+
+      if (request->desc != nullptr) {
+        request->desc->unref();
+      }
+
+      delete request;
+    });
+
+    if (err < 0) {
+      auto json = JSON::Object::Entries {
+        {"source", request->source},
+        {"err", JSON::Object::Entries {
+          {"code", err},
+          {"message", String(uv_strerror(err))}
+        }}
+      };
+
+      request->cb(request->seq, json, Post{});
+
+      if (request->desc != nullptr) {
+        request->desc->unref();
+      }
+
+      delete request;
+    }
+  }
+
+  static JSON::Object unsupportedHashAlgorithm (
+    const String source,
+    const String algorithm
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"code", "ERR_CRYPTO_INVALID_DIGEST"},
+        {"type", "TypeError"},
+        {"message", "Unsupported hash algorithm: " + algorithm}
+      }}
+    };
+  }
+
+  void Core::FS::hash (
+    const String seq,
+    const String path,
+    const String algorithm,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto hasher = Hash::create(algorithm);
+
+      if (hasher == nullptr) {
+        return cb(seq, unsupportedHashAlgorithm("fs.hash", algorithm), Post{});
+      }
+
+      auto request = new HashRequest();
+      request->core = this->core;
+      request->hasher = hasher;
+      request->seq = seq;
+      request->cb = cb;
+      request->source = "fs.hash";
+      request->path = path;
+
+      queueHashRequest(request);
+    });
+  }
+
+  void Core::FS::fhash (
+    const String seq,
+    uint64_t id,
+    const String algorithm,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.fhash"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // buffered writes land before the file is read back
+      if (desc->writeBehind != nullptr && desc->writeBehind->queued > 0) {
+        return desc->writeBehind->flush([=, this](int) {
+          this->fhash(seq, id, algorithm, cb);
+        });
+      }
+
+      auto hasher = Hash::create(algorithm);
+
+      if (hasher == nullptr) {
+        return cb(seq, unsupportedHashAlgorithm("fs.fhash", algorithm), Post{});
+      }
+
+      auto request = new HashRequest();
+      request->core = this->core;
+      request->desc = desc;
+      request->hasher = hasher;
+      request->seq = seq;
+      request->cb = cb;
+      request->source = "fs.fhash";
+      desc->ref();
+
+      queueHashRequest(request);
+    });
+  }
+
+  void Core::FS::hashWrites (
+    const String seq,
+    uint64_t id,
+    const String algorithm,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.hashWrites"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto hasher = Hash::create(algorithm);
+
+      if (hasher == nullptr) {
+        return cb(seq, unsupportedHashAlgorithm("fs.hashWrites", algorithm), Post{});
+      }
+
+      do {
+        Lock lock(desc->mutex);
+        delete desc->hasher;
+        desc->hasher = hasher;
+        desc->hashedBytes = 0;
+        desc->hashOffset = -1;
+        desc->hashContiguous = true;
+      } while (0);
+
+      auto json = JSON::Object::Entries {
+        {"source", "fs.hashWrites"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"algorithm", hasher->name()}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::FS::digest (const String seq, uint64_t id, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.digest"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      Lock lock(desc->mutex);
+
+      if (desc->hasher == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.digest"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", UV_EINVAL},
+            {"message", "Writes to this file descriptor are not being hashed"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // the digest finalizes the hasher, writes after it are not hashed
+      auto hasher = desc->hasher;
+      desc->hasher = nullptr;
+
+      if (!desc->hashContiguous) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.digest"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", UV_EINVAL},
+            {"message", "Writes to this file descriptor were not contiguous"}
+          }}
+        };
+
+        delete hasher;
+        return cb(seq, json, Post{});
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "fs.digest"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"algorithm", hasher->name()},
+          {"digest", Hash::toHex(hasher->digest())},
+          {"size", desc->hashedBytes}
+        }}
+      };
+
+      delete hasher;
+      cb(seq, json, Post{});
+    });
+  }
+
+  /**
+   * Sends a range of an open file to a peer without the bytes entering the
+   * WebView. UDP peers are sent `chunkSize` datagrams read one at a time
+   * into pooled buffers, with at most `window` datagrams in flight and the
+   * peer's token bucket pacing them. TCP peers are sent with sendfile(2).
+   */
+  struct Core::FS::Transfer {
+    // a datagram read from the file, released once it is sent
+    struct Chunk {
+      Transfer *transfer = nullptr;
+      uv_fs_t req;
+      char *bytes = nullptr;
+    };
+
+    // bytes handed to a single sendfile(2) call, between progress checks
+    static constexpr int64_t SENDFILE_SLICE = 1024 * 1024;
+
+    uint64_t id;
+    String seq;
+    Module::Callback cb;
+    SendToPeerOptions options;
+    Descriptor *desc = nullptr;
+    Core *core = nullptr;
+    uint64_t peerId = 0;
+
+    uv_fs_t req;
+    uv_timer_t *timer = nullptr;
+    int64_t offset = 0;
+    int64_t end = 0;
+    uint64_t bytesSent = 0;
+    uint64_t chunks = 0;
+    uint64_t startedAt = 0;
+    uint64_t progressAt = 0;
+    size_t inflight = 0;
+    bool reading = false;
+    bool sending = false;
+    bool eof = false;
+    bool cancelled = false;
+    int result = 0;
+    // called after the reply, see `cancelTransfers()`
+    Vector<std::function<void()>> onfinish;
+
+    bool done () {
+      return this->eof || this->cancelled || this->result < 0;
+    }
+
+    void next ();
+    void read ();
+    void send (Chunk *chunk, size_t size);
+    void sendfile ();
+    void progress ();
+    void finish ();
+  };
+
+  void Core::FS::Transfer::next () {
+    if (this->reading || this->sending) {
+      return;
+    }
+
+    if (this->done()) {
+      if (this->inflight == 0) {
+        this->finish();
+      }
+
+      return;
+    }
+
+    if (this->inflight < this->options.window) {
+      this->read();
+    }
+  }
+
+  void Core::FS::Transfer::read () {
+    auto size = (size_t) std::min(
+      (int64_t) this->options.chunkSize,
+      this->end - this->offset
+    );
+
+    if (size == 0) {
+      this->eof = true;
+      return this->next();
+    }
+
+    auto loop = &this->core->eventLoop;
+    auto chunk = new Chunk();
+    chunk->transfer = this;
+    chunk->bytes = this->core->fs.buffers.acquire(size);
+    chunk->req.data = chunk;
+
+    auto buffer = uv_buf_init(chunk->bytes, (unsigned int) size);
+    this->reading = true;
+
+    auto err = uv_fs_read(loop, &chunk->req, this->desc->fd, &buffer, 1, this->offset, [](uv_fs_t *req) {
+      auto chunk = (Chunk *) req->data;
+      auto transfer = chunk->transfer;
+      auto result = req->result;
+
+      uv_fs_req_cleanup(req);
+      transfer->reading = false;
+
+      if (result <= 0 || transfer->cancelled) {
+        if (result < 0 && transfer->result == 0) {
+          transfer->result = (int) result;
+        } else if (result == 0) {
+          transfer->eof = true;
+        }
+
+        transfer->core->fs.buffers.release(chunk->bytes);
+        delete chunk;
+        return transfer->next();
+      }
+
+      transfer->offset += result;
+      transfer->send(chunk, (size_t) result);
+      transfer->next();
+    });
+
+    if (err < 0) {
+      this->reading = false;
+      this->result = err;
+      this->core->fs.buffers.release(chunk->bytes);
+      delete chunk;
+      this->next();
+    }
+  }
+
+  void Core::FS::Transfer::send (Chunk *chunk, size_t size) {
+    if (!this->core->hasPeer(this->peerId)) {
+      this->result = UV_ENOTCONN;
+      this->core->fs.buffers.release(chunk->bytes);
+      delete chunk;
+      return;
+    }
+
+    auto peer = this->core->getPeer(this->peerId);
+
+    // a failed send may complete synchronously, `sending` keeps the
+    // completion from finishing the transfer under this call
+    this->inflight++;
+    this->sending = true;
+
+    peer->send(chunk->bytes, size, this->options.port, this->options.address, [=, this](auto status, auto post) {
+      this->inflight--;
+      this->core->fs.buffers.release(chunk->bytes);
+      delete chunk;
+
+      if (status < 0) {
+        if (this->result == 0) {
+          this->result = status;
+        }
+      } else {
+        this->bytesSent += size;
+        this->chunks++;
+        this->progress();
+      }
+
+      this->next();
+    });
+
+    this->sending = false;
+  }
+
+  void Core::FS::Transfer::sendfile () {
+  #if defined(_WIN32)
+    this->result = UV_ENOTSUP;
+    return this->finish();
+  #else
+    if (this->done() || this->offset >= this->end) {
+      return this->finish();
+    }
+
+    if (!this->core->hasPeer(this->peerId)) {
+      this->result = UV_ENOTCONN;
+      return this->finish();
+    }
+
+    auto peer = this->core->getPeer(this->peerId);
+    auto loop = &this->core->eventLoop;
+    auto size = std::min(this->end - this->offset, SENDFILE_SLICE);
+    uv_os_fd_t socket;
+
+    auto err = uv_fileno((uv_handle_t *) &peer->handle.tcp, &socket);
+
+    if (err == 0) {
+      this->req.data = this;
+      err = uv_fs_sendfile(loop, &this->req, socket, this->desc->fd, this->offset, size, [](uv_fs_t *req) {
+        auto transfer = (Transfer *) req->data;
+        auto result = req->result;
+
+        uv_fs_req_cleanup(req);
+
+        // the socket buffer is full, try again once it had time to drain
+        if (result == UV_EAGAIN) {
+          if (transfer->timer == nullptr) {
+            transfer->timer = new uv_timer_t;
+            uv_timer_init(&transfer->core->eventLoop, transfer->timer);
+            transfer->timer->data = transfer;
+          }
+
+          uv_timer_start(transfer->timer, [](uv_timer_t *handle) {
+            ((Transfer *) handle->data)->sendfile();
+          }, 1, 0);
+          return;
+        }
+
+        if (result < 0) {
+          transfer->result = (int) result;
+        } else if (result == 0) {
+          transfer->eof = true;
+        } else {
+          transfer->offset += result;
+          transfer->bytesSent += result;
+          transfer->chunks++;
+          transfer->progress();
+        }
+
+        transfer->sendfile();
+      });
+    }
+
+    if (err < 0) {
+      this->result = err;
+      this->finish();
+    }
+  #endif
+  }
+
+  void Core::FS::Transfer::progress () {
+    auto now = uv_now(&this->core->eventLoop);
+
+    if (
+      this->options.progressInterval == 0 ||
+      now - this->progressAt < this->options.progressInterval
+    ) {
+      return;
+    }
+
+    this->progressAt = now;
+
+    auto json = JSON::Object::Entries {
+      {"source", "fs.sendToPeer"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(this->id)},
+        {"bytesSent", this->bytesSent},
+        {"total", (uint64_t) (this->end - this->options.offset)},
+        {"chunks", this->chunks}
+      }}
+    };
+
+    this->cb("-1", json, Post{});
+  }
+
+  void Core::FS::Transfer::finish () {
+    auto json = JSON::Object {};
+
+    if (this->result < 0) {
+      json = JSON::Object::Entries {
+        {"source", "fs.sendToPeer"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(this->id)},
+          {"code", this->result},
+          {"message", String(uv_strerror(this->result))},
+          {"bytesSent", this->bytesSent}
+        }}
+      };
+    } else {
+      json = JSON::Object::Entries {
+        {"source", "fs.sendToPeer"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(this->id)},
+          {"bytesSent", this->bytesSent},
+          {"total", (uint64_t) (this->end - this->options.offset)},
+          {"chunks", this->chunks},
+          {"elapsed", uv_now(&this->core->eventLoop) - this->startedAt},
+          {"cancelled", this->cancelled}
+        }}
+      };
+    }
+
+    do {
+      Lock lock(this->core->fs.mutex);
+      this->core->fs.transfers.erase(this->id);
+    } while (0);
+
+    if (this->timer != nullptr) {
+      uv_close((uv_handle_t *) this->timer, [](uv_handle_t *handle) {
+        delete reinterpret_cast<uv_timer_t *>(handle);
+      });
+    }
+
+    auto onfinish = this->onfinish;
+
+    this->cb(this->seq, json, Post{});
+    this->desc->unref();
+    delete this;
+
+    for (const auto& callback : onfinish) {
+      callback();
+    }
+  }
+
+  // cancels the first transfer reading from `desc`, `callback` is called
+  // once it has finished
+  static bool cancelTransfers (Core::FS::Descriptor *desc, std::function<void()> callback) {
+    auto& fs = desc->core->fs;
+    Lock lock(fs.mutex);
+
+    for (const auto& entry : fs.transfers) {
+      auto transfer = entry.second;
+
+      if (transfer->desc == desc) {
+        transfer->cancelled = true;
+        transfer->onfinish.push_back(callback);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void Core::FS::sendToPeer (
+    const String seq,
+    uint64_t id,
+    uint64_t transferId,
+    uint64_t peerId,
+    const SendToPeerOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto desc = getDescriptor(id);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.sendToPeer"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      if (!this->core->hasPeer(peerId)) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.sendToPeer"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(transferId)},
+            {"code", "ENOTCONN"},
+            {"type", "NotFoundError"},
+            {"message", "No peer found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // buffered writes land before the file is read back
+      if (desc->writeBehind != nullptr && desc->writeBehind->queued > 0) {
+        return desc->writeBehind->flush([=, this](int) {
+          this->sendToPeer(seq, id, transferId, peerId, options, cb);
+        });
+      }
+
+      Lock lock(this->mutex);
+
+      if (this->transfers.find(transferId) != this->transfers.end()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.sendToPeer"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(transferId)},
+            {"code", UV_EEXIST},
+            {"message", "A transfer with that id is already in progress"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto end = options.offset + options.length;
+
+      // fstat(2) of an open descriptor does not block on the disk
+      if (options.length < 0) {
+        uv_fs_t req;
+        auto err = uv_fs_fstat(nullptr, &req, desc->fd, nullptr);
+        end = err < 0 ? options.offset : (int64_t) req.statbuf.st_size;
+        uv_fs_req_cleanup(&req);
+      }
+
+      auto transfer = new Transfer();
+      transfer->id = transferId;
+      transfer->seq = seq;
+      transfer->cb = cb;
+      transfer->options = options;
+      transfer->options.chunkSize = std::max(options.chunkSize, (size_t) 1);
+      transfer->options.window = std::max(options.window, (size_t) 1);
+      transfer->desc = desc;
+      transfer->core = this->core;
+      transfer->peerId = peerId;
+      transfer->offset = options.offset;
+      transfer->end = std::max(end, options.offset);
+      transfer->startedAt = uv_now(&this->core->eventLoop);
+      transfer->progressAt = transfer->startedAt;
+      desc->ref();
+
+      this->transfers.insert_or_assign(transferId, transfer);
+
+      if (this->core->getPeer(peerId)->isTCP()) {
+        transfer->sendfile();
+      } else {
+        transfer->next();
+      }
+    });
+  }
+
+  void Core::FS::cancelSendToPeer (
+    const String seq,
+    uint64_t transferId,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      Lock lock(this->mutex);
+
+      if (this->transfers.find(transferId) == this->transfers.end()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.cancelSendToPeer"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(transferId)},
+            {"type", "NotFoundError"},
+            {"message", "No transfer found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // the transfer replies to its own request once in-flight sends are done
+      this->transfers.at(transferId)->cancelled = true;
+
+      auto json = JSON::Object::Entries {
+        {"source", "fs.cancelSendToPeer"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(transferId)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  /**
+   * Matches `path` against a glob `pattern`. `*` and `?` never match a '/',
+   * `**` matches across path segments and `[...]` matches a character class.
+   */
+  static bool globMatch (const char *pattern, const char *path) {
+    while (*pattern != '\0') {
+      if (pattern[0] == '*' && pattern[1] == '*') {
+        pattern += 2;
+
+        // '**/' also matches zero segments
+        if (*pattern == '/' && globMatch(pattern + 1, path)) {
+          return true;
+        }
+
+        for (auto p = path; ; ++p) {
+          if (globMatch(pattern, p)) return true;
+          if (*p == '\0') return false;
+        }
+      }
+
+      if (*pattern == '*') {
+        pattern++;
+
+        for (auto p = path; ; ++p) {
+          if (globMatch(pattern, p)) return true;
+          if (*p == '\0' || *p == '/') return false;
+        }
+      }
+
+      if (*path == '\0') {
+        return false;
+      }
+
+      if (*pattern == '?') {
+        if (*path == '/') return false;
+        pattern++;
+        path++;
+        continue;
+      }
+
+      if (*pattern == '[') {
+        auto p = pattern + 1;
+        auto negate = *p == '!' || *p == '^';
+        auto matched = false;
+
+        if (negate) p++;
+
+        // a ']' right after the opening '[' is literal
+        for (auto first = true; *p != '\0' && (first || *p != ']'); first = false) {
+          if (p[1] == '-' && p[2] != '\0' && p[2] != ']') {
+            matched = matched || (*path >= p[0] && *path <= p[2]);
+            p += 3;
+          } else {
+            matched = matched || *path == *p;
+            p++;
+          }
+        }
+
+        // an unterminated class is a literal '['
+        if (*p != ']') {
+          if (*path != '[') return false;
+          pattern++;
+          path++;
+          continue;
+        }
+
+        if (matched == negate || *path == '/') {
+          return false;
+        }
+
+        pattern = p + 1;
+        path++;
+        continue;
+      }
+
+      if (*pattern == '\\' && pattern[1] != '\0') {
+        pattern++;
+      }
+
+      if (*pattern != *path) {
+        return false;
+      }
+
+      pattern++;
+      path++;
+    }
+
+    return *path == '\0';
+  }
+
+  static bool globMatchAny (
+    const Vector<String>& patterns,
+    const String& relative,
+    const String& name
+  ) {
+    for (const auto& pattern : patterns) {
+      auto target = pattern.find('/') == String::npos ? name : relative;
+      if (globMatch(pattern.c_str(), target.c_str())) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  struct Core::FS::Walker {
+    struct Directory {
+      String path;
+      String relative;
+      int depth = 0;
+      uint64_t dev = 0;
+      uint64_t ino = 0;
+    };
+
+    struct Entry {
+      String name;
+      String relative;
+      int type = UV_DIRENT_UNKNOWN;
+      int depth = 0;
+      bool hasStats = false;
+      uv_stat_t stats;
+    };
+
+    // a single directory scanned synchronously on a threadpool worker
+    struct Work {
+      Walker *walker = nullptr;
+      uv_work_t req;
+      Directory dir;
+      Vector<Entry> entries;
+      Vector<Directory> children;
+      int result = 0;
+    };
+
+    uint64_t id;
+    String seq;
+    Module::Callback cb;
+    WalkOptions options;
+    Core *core = nullptr;
+
+    Queue<Directory> queue;
+    std::set<std::pair<uint64_t, uint64_t>> visited;
+    Vector<JSON::Any> entries;
+    Vector<JSON::Any> errors;
+    size_t active = 0;
+    size_t count = 0;
+    size_t batches = 0;
+    bool cancelled = false;
+    int result = 0;
+
+    bool follows () {
+      return this->options.symlinks == "follow";
+    }
+
+    void scan (Work *work);
+    void next ();
+    void flush ();
+    void finish (int err);
+  };
+
+  void Core::FS::Walker::scan (Work *work) {
+    auto& dir = work->dir;
+    auto& options = this->options;
+    uv_fs_t req;
+    uv_dirent_t dirent;
+
+    if (this->follows()) {
+      uv_fs_t stat;
+      if (uv_fs_stat(nullptr, &stat, dir.path.c_str(), nullptr) == 0) {
+        dir.dev = stat.statbuf.st_dev;
+        dir.ino = stat.statbuf.st_ino;
+      }
+      uv_fs_req_cleanup(&stat);
+    }
+
+    auto result = uv_fs_scandir(nullptr, &req, dir.path.c_str(), 0, nullptr);
+
+    if (result < 0) {
+      work->result = result;
+      uv_fs_req_cleanup(&req);
+      return;
+    }
+
+    while (uv_fs_scandir_next(&req, &dirent) != UV_EOF) {
+      Entry entry;
+      entry.name = dirent.name;
+      entry.relative = dir.relative.size() > 0
+        ? dir.relative + "/" + entry.name
+        : entry.name;
+      entry.type = dirent.type;
+      entry.depth = dir.depth + 1;
+
+      auto path = dir.path + "/" + entry.name;
+
+      if (globMatchAny(options.exclude, entry.relative, entry.name)) {
+        continue;
+      }
+
+      // some file systems do not report entry types
+      if (entry.type == UV_DIRENT_UNKNOWN || options.withStats) {
+        uv_fs_t stat;
+        if (uv_fs_lstat(nullptr, &stat, path.c_str(), nullptr) == 0) {
+          entry.stats = stat.statbuf;
+          entry.hasStats = options.withStats;
+
+          if (entry.type == UV_DIRENT_UNKNOWN) {
+            auto mode = stat.statbuf.st_mode & S_IFMT;
+            if (mode == S_IFDIR) entry.type = UV_DIRENT_DIR;
+            else if (mode == S_IFREG) entry.type = UV_DIRENT_FILE;
+            #if defined(S_IFLNK)
+            else if (mode == S_IFLNK) entry.type = UV_DIRENT_LINK;
+            #endif
+          }
+        }
+        uv_fs_req_cleanup(&stat);
+      }
+
+      auto descend = entry.type == UV_DIRENT_DIR;
+      auto child = Directory { path, entry.relative, entry.depth };
+
+      if (entry.type == UV_DIRENT_LINK) {
+        if (options.symlinks == "skip") {
+          continue;
+        }
+
+        if (this->follows()) {
+          uv_fs_t stat;
+          if (uv_fs_stat(nullptr, &stat, path.c_str(), nullptr) == 0) {
+            descend = (stat.statbuf.st_mode & S_IFMT) == S_IFDIR;
+            child.dev = stat.statbuf.st_dev;
+            child.ino = stat.statbuf.st_ino;
+          }
+          uv_fs_req_cleanup(&stat);
+        }
+      } else if (descend && this->follows()) {
+        if (entry.hasStats || dirent.type == UV_DIRENT_UNKNOWN) {
+          child.dev = entry.stats.st_dev;
+          child.ino = entry.stats.st_ino;
+        } else {
+          uv_fs_t stat;
+          if (uv_fs_lstat(nullptr, &stat, path.c_str(), nullptr) == 0) {
+            child.dev = stat.statbuf.st_dev;
+            child.ino = stat.statbuf.st_ino;
+          }
+          uv_fs_req_cleanup(&stat);
+        }
+      }
+
+      if (descend && (options.maxDepth < 0 || entry.depth < options.maxDepth)) {
+        work->children.push_back(child);
+      }
+
+      if (
+        options.include.size() == 0 ||
+        globMatchAny(options.include, entry.relative, entry.name)
+      ) {
+        work->entries.push_back(entry);
+      }
+    }
+
+    uv_fs_req_cleanup(&req);
+  }
+
+  void Core::FS::Walker::next () {
+    auto loop = &this->core->eventLoop;
+
+    while (
+      !this->cancelled &&
+      this->queue.size() > 0 &&
+      this->active < this->options.concurrency
+    ) {
+      auto work = new Work();
+      work->walker = this;
+      work->dir = this->queue.front();
+      work->req.data = work;
+      this->queue.pop();
+      this->active++;
+
+      auto err = uv_queue_work(loop, &work->req, [](uv_work_t *req) {
+        auto work = (Work *) req->data;
+        work->walker->scan(work);
+      }, [](uv_work_t *req, int status) {
+        auto work = (Work *) req->data;
+        auto walker = work->walker;
+        auto& dir = work->dir;
+        auto result = status < 0 ? status : work->result;
+
+        walker->active--;
+
+        if (result < 0 && dir.depth == 0) {
+          delete work;
+          return walker->finish(result);
+        }
+
+        if (result < 0) {
+          walker->errors.push_back(JSON::Object::Entries {
+            {"path", dir.relative},
+            {"code", result},
+            {"message", String(uv_strerror(result))}
+          });
+        }
+
+        if (walker->follows() && dir.depth == 0) {
+          walker->visited.insert({ dir.dev, dir.ino });
+        }
+
+        for (auto& entry : work->entries) {
+          auto json = JSON::Object::Entries {
+            {"name", entry.name},
+            {"path", entry.relative},
+            {"type", entry.type},
+            {"depth", entry.depth}
+          };
+
+          if (entry.hasStats) {
+            json["stats"] = getStatsDataJSON(&entry.stats);
+          }
+
+          walker->entries.push_back(json);
+          walker->count++;
+
+          if (walker->entries.size() >= walker->options.batchSize) {
+            walker->flush();
+          }
+        }
+
+        for (auto& child : work->children) {
+          // followed links may lead back into a directory already walked
+          if (walker->follows() && !walker->visited.insert({ child.dev, child.ino }).second) {
+            continue;
+          }
+
+          walker->queue.push(child);
+        }
+
+        delete work;
+
+        if (walker->active == 0 && (walker->cancelled || walker->queue.size() == 0)) {
+          return walker->finish(0);
+        }
+
+        walker->next();
+      });
+
+      if (err < 0) {
+        this->active--;
+        delete work;
+        return this->finish(err);
+      }
+    }
+  }
+
+  void Core::FS::Walker::flush () {
+    auto json = JSON::Object::Entries {
+      {"source", "fs.walk"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(this->id)},
+        {"batch", this->batches++},
+        {"entries", this->entries},
+        {"errors", this->errors}
+      }}
+    };
+
+    this->entries.clear();
+    this->errors.clear();
+    this->cb("-1", json, Post{});
+  }
+
+  void Core::FS::Walker::finish (int err) {
+    if (err < 0 && this->result == 0) {
+      this->result = err;
+    }
+
+    // wait for scans still running on the threadpool
+    if (this->active > 0) {
+      this->cancelled = true;
+      return;
+    }
+
+    auto json = JSON::Object {};
+    err = this->result;
+
+    if (err < 0) {
+      json = JSON::Object::Entries {
+        {"source", "fs.walk"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(this->id)},
+          {"code", err},
+          {"message", String(uv_strerror(err))}
+        }}
+      };
+    } else {
+      // entries of the last batch are in the reply, `batches` is the number
+      // of batches that were emitted before it
+      json = JSON::Object::Entries {
+        {"source", "fs.walk"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(this->id)},
+          {"entries", this->entries},
+          {"errors", this->errors},
+          {"count", this->count},
+          {"batches", this->batches},
+          {"cancelled", this->cancelled}
+        }}
+      };
+    }
+
+    do {
+      Lock lock(this->core->fs.mutex);
+      this->core->fs.walkers.erase(this->id);
+    } while (0);
+
+    this->cb(this->seq, json, Post{});
+    delete this;
+  }
+
+  void Core::FS::walk (
+    const String seq,
+    uint64_t id,
+    const String path,
+    const WalkOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      Lock lock(this->mutex);
+
+      if (this->walkers.find(id) != this->walkers.end()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.walk"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", UV_EEXIST},
+            {"message", "A walk with that id is already in progress"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto walker = new Walker();
+      walker->id = id;
+      walker->seq = seq;
+      walker->cb = cb;
+      walker->core = this->core;
+      walker->options = options;
+      walker->options.batchSize = std::max(options.batchSize, (size_t) 1);
+      walker->options.concurrency = std::max(options.concurrency, (size_t) 1);
+      walker->queue.push(Walker::Directory { path, "", 0 });
+
+      this->walkers.insert_or_assign(id, walker);
+      walker->next();
+    });
+  }
+
+  void Core::FS::cancelWalk (
+    const String seq,
+    uint64_t id,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      Lock lock(this->mutex);
+
+      if (this->walkers.find(id) == this->walkers.end()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.cancelWalk"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"type", "NotFoundError"},
+            {"message", "No walk found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // the walk replies to its own request once in-flight scans are done
+      this->walkers.at(id)->cancelled = true;
+
       auto json = JSON::Object::Entries {
-        {"source", "fs.constants"},
-        {"data", data}
+        {"source", "fs.cancelWalk"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+}
+
+namespace SSC {
+  // `UV_FS_EVENT_RECURSIVE` is only implemented by the FSEvents and
+  // ReadDirectoryChangesW backends, inotify watches a single directory
+  #if defined(__APPLE__) || defined(_WIN32)
+    static constexpr bool HAS_NATIVE_RECURSIVE_WATCH = true;
+  #else
+    static constexpr bool HAS_NATIVE_RECURSIVE_WATCH = false;
+  #endif
+
+  static String joinWatchPath (const String& parent, const String& name) {
+    if (parent.size() == 0) return name;
+    if (name.size() == 0) return parent;
+    return parent + "/" + name;
+  }
+
+  struct Core::FS::Watcher {
+    // a single `uv_fs_event_t`, one per watched directory when inotify
+    // backs a recursive watch
+    struct Handle {
+      uv_fs_event_t event;
+      Watcher *watcher = nullptr;
+      // relative to the watch root
+      String path;
+    };
+
+    // an entry renamed within a recursive watch, stat'd off the loop thread
+    struct Probe {
+      Watcher *watcher = nullptr;
+      uv_fs_t req;
+      String path;
+      uint64_t generation = 0;
+    };
+
+    // directories of a subtree collected on a threadpool worker
+    struct Scan {
+      Watcher *watcher = nullptr;
+      uv_work_t req;
+      String path;
+      Vector<String> directories;
+      int result = 0;
+    };
+
+    uint64_t id;
+    String seq;
+    Module::Callback cb;
+    String root;
+    WatchOptions options;
+    Core *core = nullptr;
+
+    std::map<String, Handle*> handles;
+    // (path, type) of changes within the debounce window, coalesced per path
+    Vector<std::pair<String, String>> changes;
+    std::map<String, size_t> pending;
+    // latest probe of each path, results of earlier probes are ignored
+    std::map<String, uint64_t> probing;
+    Vector<JSON::Any> errors;
+    // `timer.data` is only set once the timer is initialized
+    uv_timer_t timer = {};
+
+    size_t scans = 0;
+    size_t probes = 0;
+    uint64_t generation = 0;
+    size_t closing = 0;
+    bool started = false;
+    bool closed = false;
+
+    bool watchesSubdirectories () {
+      return this->options.recursive && !HAS_NATIVE_RECURSIVE_WATCH;
+    }
+
+    int start ();
+    int scan (const String path);
+    void probe (const String path);
+    int add (const String path);
+    void remove (const String path);
+    void record (const String path, const String type);
+    void error (const String path, int err);
+    void flush ();
+    void close ();
+    void release ();
+  };
+
+  int Core::FS::Watcher::start () {
+    auto loop = &this->core->eventLoop;
+    auto err = uv_timer_init(loop, &this->timer);
+
+    if (err < 0) {
+      return err;
+    }
+
+    this->timer.data = this;
+
+    if (this->watchesSubdirectories()) {
+      return this->scan("");
+    }
+
+    err = this->add("");
+
+    if (err == 0) {
+      this->started = true;
+    }
+
+    return err;
+  }
+
+  int Core::FS::Watcher::scan (const String path) {
+    auto loop = &this->core->eventLoop;
+    auto scan = new Scan();
+    scan->watcher = this;
+    scan->path = path;
+    scan->req.data = scan;
+    this->scans++;
+
+    // the tree is listed off the loop thread, symbolic links are not followed
+    auto err = uv_queue_work(loop, &scan->req, [](uv_work_t *req) {
+      auto scan = (Scan *) req->data;
+      auto root = scan->watcher->root;
+      auto queue = Queue<String> {};
+      uv_fs_t stat;
+
+      scan->result = uv_fs_lstat(nullptr, &stat, joinWatchPath(root, scan->path).c_str(), nullptr);
+      auto isDirectory = (stat.statbuf.st_mode & S_IFMT) == S_IFDIR;
+      uv_fs_req_cleanup(&stat);
+
+      if (scan->result < 0) {
+        return;
+      }
+
+      scan->directories.push_back(scan->path);
+
+      if (!isDirectory) {
+        return;
+      }
+
+      queue.push(scan->path);
+
+      while (queue.size() > 0) {
+        auto path = queue.front();
+        auto filename = joinWatchPath(root, path);
+        uv_fs_t req;
+        uv_dirent_t dirent;
+        queue.pop();
+
+        if (uv_fs_scandir(nullptr, &req, filename.c_str(), 0, nullptr) < 0) {
+          uv_fs_req_cleanup(&req);
+          continue;
+        }
+
+        while (uv_fs_scandir_next(&req, &dirent) != UV_EOF) {
+          auto type = dirent.type;
+          auto relative = joinWatchPath(path, dirent.name);
+
+          if (type == UV_DIRENT_UNKNOWN) {
+            uv_fs_t stat;
+            auto child = joinWatchPath(root, relative);
+            if (uv_fs_lstat(nullptr, &stat, child.c_str(), nullptr) == 0) {
+              type = (stat.statbuf.st_mode & S_IFMT) == S_IFDIR ? UV_DIRENT_DIR : UV_DIRENT_FILE;
+            }
+            uv_fs_req_cleanup(&stat);
+          }
+
+          if (type == UV_DIRENT_DIR) {
+            scan->directories.push_back(relative);
+            queue.push(relative);
+          }
+        }
+
+        uv_fs_req_cleanup(&req);
+      }
+    }, [](uv_work_t *req, int status) {
+      auto scan = (Scan *) req->data;
+      auto watcher = scan->watcher;
+      auto result = status < 0 ? status : scan->result;
+
+      watcher->scans--;
+
+      if (watcher->closed) {
+        delete scan;
+        return watcher->release();
+      }
+
+      // the root of the watch could not be listed
+      if (!watcher->started && result < 0) {
+        delete scan;
+        auto json = JSON::Object::Entries {
+          {"source", "fs.watch"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(watcher->id)},
+            {"code", result},
+            {"message", String(uv_strerror(result))}
+          }}
+        };
+
+        watcher->cb(watcher->seq, json, Post{});
+        return watcher->close();
+      }
+
+      for (const auto& path : scan->directories) {
+        auto err = watcher->add(path);
+
+        if (err < 0 && !watcher->started && path.size() == 0) {
+          delete scan;
+          auto json = JSON::Object::Entries {
+            {"source", "fs.watch"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(watcher->id)},
+              {"code", err},
+              {"message", String(uv_strerror(err))}
+            }}
+          };
+
+          watcher->cb(watcher->seq, json, Post{});
+          return watcher->close();
+        }
+
+        // most likely out of inotify watches, the rest of the tree is
+        // still watched
+        if (err < 0) {
+          watcher->error(path, err);
+        }
+      }
+
+      delete scan;
+
+      if (!watcher->started) {
+        watcher->started = true;
+
+        auto json = JSON::Object::Entries {
+          {"source", "fs.watch"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(watcher->id)},
+            {"handles", watcher->handles.size()}
+          }}
+        };
+
+        watcher->cb(watcher->seq, json, Post{});
+      }
+    });
+
+    if (err < 0) {
+      this->scans--;
+      delete scan;
+      this->error(path, err);
+    }
+
+    return err;
+  }
+
+  void Core::FS::Watcher::probe (const String path) {
+    auto loop = &this->core->eventLoop;
+    auto filename = joinWatchPath(this->root, path);
+    auto probe = new Probe();
+    probe->watcher = this;
+    probe->path = path;
+    probe->generation = ++this->generation;
+    probe->req.data = probe;
+    this->probing.insert_or_assign(path, probe->generation);
+    this->probes++;
+
+    // a new directory is scanned and watched, a missing one is unwatched
+    auto err = uv_fs_lstat(loop, &probe->req, filename.c_str(), [](uv_fs_t *req) {
+      auto probe = (Probe *) req->data;
+      auto watcher = probe->watcher;
+      auto path = probe->path;
+      auto result = req->result;
+      auto isDirectory = result == 0 && (req->statbuf.st_mode & S_IFMT) == S_IFDIR;
+      auto latest = watcher->probing[path] == probe->generation;
+
+      uv_fs_req_cleanup(req);
+      delete probe;
+      watcher->probes--;
+
+      if (watcher->closed) {
+        return watcher->release();
+      }
+
+      // the path was renamed again while this probe was running
+      if (!latest) {
+        return;
+      }
+
+      watcher->probing.erase(path);
+
+      if (isDirectory && watcher->handles.find(path) == watcher->handles.end()) {
+        watcher->scan(path);
+      } else if (result < 0) {
+        watcher->remove(path);
+      }
+    });
+
+    if (err < 0) {
+      this->probes--;
+      this->probing.erase(path);
+      uv_fs_req_cleanup(&probe->req);
+      delete probe;
+      this->error(path, err);
+    }
+  }
+
+  int Core::FS::Watcher::add (const String path) {
+    auto loop = &this->core->eventLoop;
+    auto filename = joinWatchPath(this->root, path);
+    unsigned int flags = 0;
+
+    if (this->handles.find(path) != this->handles.end()) {
+      return 0;
+    }
+
+    if (this->options.recursive && HAS_NATIVE_RECURSIVE_WATCH) {
+      flags |= UV_FS_EVENT_RECURSIVE;
+    }
+
+    auto handle = new Handle();
+    handle->watcher = this;
+    handle->path = path;
+    handle->event.data = handle;
+
+    auto err = uv_fs_event_init(loop, &handle->event);
+
+    if (err < 0) {
+      delete handle;
+      return err;
+    }
+
+    err = uv_fs_event_start(&handle->event, [](
+      uv_fs_event_t *event,
+      const char *filename,
+      int events,
+      int status
+    ) {
+      auto handle = (Handle *) event->data;
+      auto watcher = handle->watcher;
+      auto path = joinWatchPath(handle->path, filename ? filename : "");
+
+      if (watcher->closed) {
+        return;
+      }
+
+      if (status < 0) {
+        return watcher->error(handle->path, status);
+      }
+
+      // a rename is reported for both sides of a move, as well as for
+      // created and deleted entries
+      auto type = (events & UV_RENAME) ? "rename" : "change";
+      watcher->record(path, type);
+
+      if (watcher->watchesSubdirectories() && (events & UV_RENAME)) {
+        watcher->probe(path);
+      }
+    }, filename.c_str(), flags);
+
+    if (err < 0) {
+      this->closing++;
+      uv_close((uv_handle_t *) &handle->event, [](uv_handle_t *event) {
+        auto handle = (Handle *) event->data;
+        auto watcher = handle->watcher;
+        delete handle;
+        watcher->closing--;
+        watcher->release();
+      });
+
+      return err;
+    }
+
+    this->handles.insert_or_assign(path, handle);
+    return 0;
+  }
+
+  void Core::FS::Watcher::remove (const String path) {
+    auto prefix = path + "/";
+
+    for (auto it = this->handles.begin(); it != this->handles.end();) {
+      auto& key = it->first;
+
+      if (path.size() > 0 && key != path && key.rfind(prefix, 0) != 0) {
+        ++it;
+        continue;
+      }
+
+      this->closing++;
+      uv_close((uv_handle_t *) &it->second->event, [](uv_handle_t *event) {
+        auto handle = (Handle *) event->data;
+        auto watcher = handle->watcher;
+        delete handle;
+        watcher->closing--;
+        watcher->release();
+      });
+
+      it = this->handles.erase(it);
+    }
+  }
+
+  void Core::FS::Watcher::record (const String path, const String type) {
+    auto it = this->pending.find(path);
+
+    if (it != this->pending.end()) {
+      // a rename within the window takes precedence over content changes
+      if (type == "rename") {
+        this->changes[it->second].second = type;
+      }
+    } else {
+      this->pending.insert_or_assign(path, this->changes.size());
+      this->changes.push_back({ path, type });
+    }
+
+    if (!uv_is_active((uv_handle_t *) &this->timer)) {
+      uv_timer_start(&this->timer, [](uv_timer_t *timer) {
+        auto watcher = (Watcher *) timer->data;
+        watcher->flush();
+      }, this->options.debounce, 0);
+    }
+  }
+
+  void Core::FS::Watcher::error (const String path, int err) {
+    this->errors.push_back(JSON::Object::Entries {
+      {"path", path},
+      {"code", err},
+      {"message", String(uv_strerror(err))}
+    });
+
+    if (!uv_is_active((uv_handle_t *) &this->timer)) {
+      uv_timer_start(&this->timer, [](uv_timer_t *timer) {
+        auto watcher = (Watcher *) timer->data;
+        watcher->flush();
+      }, this->options.debounce, 0);
+    }
+  }
+
+  void Core::FS::Watcher::flush () {
+    if (this->closed || (this->changes.size() == 0 && this->errors.size() == 0)) {
+      return;
+    }
+
+    auto events = Vector<JSON::Any> {};
+
+    for (const auto& change : this->changes) {
+      events.push_back(JSON::Object::Entries {
+        {"type", change.second},
+        {"path", change.first}
+      });
+    }
+
+    auto json = JSON::Object::Entries {
+      {"source", "fs.watch"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(this->id)},
+        {"events", events},
+        {"errors", this->errors}
+      }}
+    };
+
+    this->changes.clear();
+    this->pending.clear();
+    this->errors.clear();
+    this->cb("-1", json, Post{});
+  }
+
+  void Core::FS::Watcher::close () {
+    if (this->closed) {
+      return;
+    }
+
+    this->closed = true;
+
+    do {
+      Lock lock(this->core->fs.mutex);
+      this->core->fs.watchers.erase(this->id);
+    } while (0);
+
+    this->remove("");
+
+    if (this->timer.data == this) {
+      this->closing++;
+      uv_close((uv_handle_t *) &this->timer, [](uv_handle_t *timer) {
+        auto watcher = (Watcher *) timer->data;
+        watcher->closing--;
+        watcher->release();
+      });
+    }
+
+    this->release();
+  }
+
+  void Core::FS::Watcher::release () {
+    // scans and probes still running on the threadpool hold on to the watcher
+    if (this->closed && this->closing == 0 && this->scans == 0 && this->probes == 0) {
+      delete this;
+    }
+  }
+
+  void Core::FS::watch (
+    const String seq,
+    uint64_t id,
+    const String path,
+    const WatchOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      Lock lock(this->mutex);
+
+      if (this->watchers.find(id) != this->watchers.end()) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.watch"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", UV_EEXIST},
+            {"message", "A watcher with that id already exists"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto watcher = new Watcher();
+      watcher->id = id;
+      watcher->seq = seq;
+      watcher->cb = cb;
+      watcher->root = path;
+      watcher->core = this->core;
+      watcher->options = options;
+
+      this->watchers.insert_or_assign(id, watcher);
+
+      auto err = watcher->start();
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.watch"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", err},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        cb(seq, json, Post{});
+        return watcher->close();
+      }
+
+      // a recursive inotify watch replies once the tree has been listed
+      if (watcher->started) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.watch"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"handles", watcher->handles.size()}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      }
+    });
+  }
+
+  void Core::FS::unwatch (
+    const String seq,
+    uint64_t id,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      Watcher *watcher = nullptr;
+
+      do {
+        Lock lock(this->mutex);
+        if (this->watchers.find(id) != this->watchers.end()) {
+          watcher = this->watchers.at(id);
+        }
+      } while (0);
+
+      if (watcher == nullptr) {
+        auto json = JSON::Object::Entries {
+          {"source", "fs.unwatch"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"type", "NotFoundError"},
+            {"message", "No watcher found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // changes still in the debounce window are delivered first
+      watcher->flush();
+      watcher->close();
+
+      auto json = JSON::Object::Entries {
+        {"source", "fs.unwatch"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)}
+        }}
       };
 
       cb(seq, json, Post{});
     });
   }
+
+  void Core::FS::closeWatchers () {
+    Vector<Watcher*> watchers;
+
+    do {
+      Lock lock(this->mutex);
+      for (const auto& tuple : this->watchers) {
+        watchers.push_back(tuple.second);
+      }
+    } while (0);
+
+    for (auto watcher : watchers) {
+      watcher->close();
+    }
+  }
 }
@@ -0,0 +1,410 @@
+#include "hash.hh"
+#include <cstring>
+
+namespace SSC::Hash {
+  static inline uint32_t rotr32 (uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+  }
+
+  static inline uint64_t rotr64 (uint64_t x, int n) {
+    return (x >> n) | (x << (64 - n));
+  }
+
+  static inline uint64_t rotl64 (uint64_t x, int n) {
+    return (x << n) | (x >> (64 - n));
+  }
+
+  static inline uint32_t load32be (const unsigned char *p) {
+    return
+      ((uint32_t) p[0] << 24) |
+      ((uint32_t) p[1] << 16) |
+      ((uint32_t) p[2] << 8) |
+      ((uint32_t) p[3]);
+  }
+
+  static inline uint32_t load32le (const unsigned char *p) {
+    return
+      ((uint32_t) p[0]) |
+      ((uint32_t) p[1] << 8) |
+      ((uint32_t) p[2] << 16) |
+      ((uint32_t) p[3] << 24);
+  }
+
+  static inline uint64_t load64le (const unsigned char *p) {
+    return (uint64_t) load32le(p) | ((uint64_t) load32le(p + 4) << 32);
+  }
+
+  static constexpr uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+  SHA256::SHA256 () {
+    static constexpr uint32_t iv[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(this->state, iv, sizeof(iv));
+  }
+
+  void SHA256::compress (const unsigned char *block) {
+    uint32_t w[64];
+
+    for (int i = 0; i < 16; ++i) {
+      w[i] = load32be(block + i * 4);
+    }
+
+    for (int i = 16; i < 64; ++i) {
+      auto s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      auto s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto a = this->state[0];
+    auto b = this->state[1];
+    auto c = this->state[2];
+    auto d = this->state[3];
+    auto e = this->state[4];
+    auto f = this->state[5];
+    auto g = this->state[6];
+    auto h = this->state[7];
+
+    for (int i = 0; i < 64; ++i) {
+      auto s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+      auto ch = (e & f) ^ (~e & g);
+      auto t1 = h + s1 + ch + SHA256_K[i] + w[i];
+      auto s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+      auto maj = (a & b) ^ (a & c) ^ (b & c);
+      auto t2 = s0 + maj;
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+
+    this->state[0] += a;
+    this->state[1] += b;
+    this->state[2] += c;
+    this->state[3] += d;
+    this->state[4] += e;
+    this->state[5] += f;
+    this->state[6] += g;
+    this->state[7] += h;
+  }
+
+  void SHA256::update (const unsigned char *bytes, size_t size) {
+    this->length += size;
+
+    if (this->blockSize > 0) {
+      auto n = std::min(size, sizeof(this->block) - this->blockSize);
+      memcpy(this->block + this->blockSize, bytes, n);
+      this->blockSize += n;
+      bytes += n;
+      size -= n;
+
+      if (this->blockSize < sizeof(this->block)) {
+        return;
+      }
+
+      this->compress(this->block);
+      this->blockSize = 0;
+    }
+
+    // whole blocks are compressed straight from the caller's buffer
+    for (; size >= sizeof(this->block); size -= sizeof(this->block)) {
+      this->compress(bytes);
+      bytes += sizeof(this->block);
+    }
+
+    memcpy(this->block, bytes, size);
+    this->blockSize = size;
+  }
+
+  Digest SHA256::digest () {
+    auto bits = this->length * 8;
+    unsigned char padding[72] = { 0x80 };
+    auto n = (this->blockSize < 56 ? 56 : 120) - this->blockSize;
+
+    for (int i = 0; i < 8; ++i) {
+      padding[n + i] = (unsigned char) (bits >> (56 - i * 8));
+    }
+
+    this->update(padding, n + 8);
+
+    Digest digest(32);
+    for (int i = 0; i < 8; ++i) {
+      digest[i * 4 + 0] = (unsigned char) (this->state[i] >> 24);
+      digest[i * 4 + 1] = (unsigned char) (this->state[i] >> 16);
+      digest[i * 4 + 2] = (unsigned char) (this->state[i] >> 8);
+      digest[i * 4 + 3] = (unsigned char) (this->state[i]);
+    }
+
+    return digest;
+  }
+
+  static constexpr uint64_t BLAKE2B_IV[8] = {
+    0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b,
+    0xa54ff53a5f1d36f1, 0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+    0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+  };
+
+  static constexpr unsigned char BLAKE2B_SIGMA[12][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+    { 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+    { 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+    { 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+    { 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+    { 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+    { 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+    { 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+    { 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 },
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 }
+  };
+
+  BLAKE2b::BLAKE2b (size_t outputSize) {
+    this->outputSize = std::min(std::max(outputSize, (size_t) 1), (size_t) 64);
+    memcpy(this->state, BLAKE2B_IV, sizeof(BLAKE2B_IV));
+    this->state[0] ^= 0x01010000 ^ this->outputSize;
+  }
+
+  const char* BLAKE2b::name () const {
+    return this->outputSize == 32 ? "blake2b256" : "blake2b";
+  }
+
+  void BLAKE2b::compress (bool last) {
+    uint64_t v[16];
+    uint64_t m[16];
+
+    for (int i = 0; i < 16; ++i) {
+      m[i] = load64le(this->block + i * 8);
+    }
+
+    for (int i = 0; i < 8; ++i) {
+      v[i] = this->state[i];
+      v[i + 8] = BLAKE2B_IV[i];
+    }
+
+    v[12] ^= this->counter[0];
+    v[13] ^= this->counter[1];
+
+    if (last) {
+      v[14] = ~v[14];
+    }
+
+    auto mix = [&](int a, int b, int c, int d, uint64_t x, uint64_t y) {
+      v[a] = v[a] + v[b] + x;
+      v[d] = rotr64(v[d] ^ v[a], 32);
+      v[c] = v[c] + v[d];
+      v[b] = rotr64(v[b] ^ v[c], 24);
+      v[a] = v[a] + v[b] + y;
+      v[d] = rotr64(v[d] ^ v[a], 16);
+      v[c] = v[c] + v[d];
+      v[b] = rotr64(v[b] ^ v[c], 63);
+    };
+
+    for (int i = 0; i < 12; ++i) {
+      auto s = BLAKE2B_SIGMA[i];
+      mix(0, 4, 8, 12, m[s[0]], m[s[1]]);
+      mix(1, 5, 9, 13, m[s[2]], m[s[3]]);
+      mix(2, 6, 10, 14, m[s[4]], m[s[5]]);
+      mix(3, 7, 11, 15, m[s[6]], m[s[7]]);
+      mix(0, 5, 10, 15, m[s[8]], m[s[9]]);
+      mix(1, 6, 11, 12, m[s[10]], m[s[11]]);
+      mix(2, 7, 8, 13, m[s[12]], m[s[13]]);
+      mix(3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+
+    for (int i = 0; i < 8; ++i) {
+      this->state[i] ^= v[i] ^ v[i + 8];
+    }
+  }
+
+  void BLAKE2b::update (const unsigned char *bytes, size_t size) {
+    while (size > 0) {
+      // the last block is only compressed in `digest()` with the final flag
+      if (this->blockSize == sizeof(this->block)) {
+        this->counter[0] += sizeof(this->block);
+        if (this->counter[0] < sizeof(this->block)) {
+          this->counter[1]++;
+        }
+
+        this->compress(false);
+        this->blockSize = 0;
+      }
+
+      auto n = std::min(size, sizeof(this->block) - this->blockSize);
+      memcpy(this->block + this->blockSize, bytes, n);
+      this->blockSize += n;
+      bytes += n;
+      size -= n;
+    }
+  }
+
+  Digest BLAKE2b::digest () {
+    this->counter[0] += this->blockSize;
+    if (this->counter[0] < this->blockSize) {
+      this->counter[1]++;
+    }
+
+    memset(this->block + this->blockSize, 0, sizeof(this->block) - this->blockSize);
+    this->compress(true);
+
+    Digest digest(this->outputSize);
+    for (size_t i = 0; i < this->outputSize; ++i) {
+      digest[i] = (unsigned char) (this->state[i / 8] >> (8 * (i % 8)));
+    }
+
+    return digest;
+  }
+
+  static constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+  static constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+  static constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+  static constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+  static constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+  static inline uint64_t xxh64Round (uint64_t lane, uint64_t input) {
+    lane += input * XXH_PRIME64_2;
+    lane = rotl64(lane, 31);
+    return lane * XXH_PRIME64_1;
+  }
+
+  static inline uint64_t xxh64Merge (uint64_t hash, uint64_t lane) {
+    hash ^= xxh64Round(0, lane);
+    return hash * XXH_PRIME64_1 + XXH_PRIME64_4;
+  }
+
+  XXH64::XXH64 (uint64_t seed) {
+    this->seed = seed;
+    this->lanes[0] = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+    this->lanes[1] = seed + XXH_PRIME64_2;
+    this->lanes[2] = seed;
+    this->lanes[3] = seed - XXH_PRIME64_1;
+  }
+
+  void XXH64::update (const unsigned char *bytes, size_t size) {
+    this->length += size;
+
+    if (this->blockSize > 0) {
+      auto n = std::min(size, sizeof(this->block) - this->blockSize);
+      memcpy(this->block + this->blockSize, bytes, n);
+      this->blockSize += n;
+      bytes += n;
+      size -= n;
+
+      if (this->blockSize < sizeof(this->block)) {
+        return;
+      }
+
+      for (int i = 0; i < 4; ++i) {
+        this->lanes[i] = xxh64Round(this->lanes[i], load64le(this->block + i * 8));
+      }
+
+      this->blockSize = 0;
+    }
+
+    // four independent lanes keep the multipliers of the CPU busy
+    for (; size >= sizeof(this->block); size -= sizeof(this->block)) {
+      this->lanes[0] = xxh64Round(this->lanes[0], load64le(bytes));
+      this->lanes[1] = xxh64Round(this->lanes[1], load64le(bytes + 8));
+      this->lanes[2] = xxh64Round(this->lanes[2], load64le(bytes + 16));
+      this->lanes[3] = xxh64Round(this->lanes[3], load64le(bytes + 24));
+      bytes += sizeof(this->block);
+    }
+
+    memcpy(this->block, bytes, size);
+    this->blockSize = size;
+  }
+
+  Digest XXH64::digest () {
+    uint64_t hash = 0;
+
+    if (this->length >= sizeof(this->block)) {
+      hash =
+        rotl64(this->lanes[0], 1) +
+        rotl64(this->lanes[1], 7) +
+        rotl64(this->lanes[2], 12) +
+        rotl64(this->lanes[3], 18);
+
+      for (int i = 0; i < 4; ++i) {
+        hash = xxh64Merge(hash, this->lanes[i]);
+      }
+    } else {
+      hash = this->seed + XXH_PRIME64_5;
+    }
+
+    hash += this->length;
+
+    auto p = this->block;
+    auto end = this->block + this->blockSize;
+
+    for (; p + 8 <= end; p += 8) {
+      hash ^= xxh64Round(0, load64le(p));
+      hash = rotl64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+
+    if (p + 4 <= end) {
+      hash ^= (uint64_t) load32le(p) * XXH_PRIME64_1;
+      hash = rotl64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+      p += 4;
+    }
+
+    for (; p < end; ++p) {
+      hash ^= (uint64_t) *p * XXH_PRIME64_5;
+      hash = rotl64(hash, 11) * XXH_PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+
+    // canonical representation is big endian
+    Digest digest(8);
+    for (int i = 0; i < 8; ++i) {
+      digest[i] = (unsigned char) (hash >> (56 - i * 8));
+    }
+
+    return digest;
+  }
+
+  Hasher* create (const std::string& algorithm) {
+    if (algorithm == "sha256") return new SHA256();
+    if (algorithm == "blake2b") return new BLAKE2b(64);
+    if (algorithm == "blake2b256") return new BLAKE2b(32);
+    if (algorithm == "xxh64") return new XXH64();
+    return nullptr;
+  }
+
+  std::string toHex (const Digest& digest) {
+    static constexpr char alphabet[] = "0123456789abcdef";
+    std::string hex;
+
+    hex.reserve(digest.size() * 2);
+
+    for (auto byte : digest) {
+      hex += alphabet[byte >> 4];
+      hex += alphabet[byte & 0x0f];
+    }
+
+    return hex;
+  }
+}
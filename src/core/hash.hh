@@ -0,0 +1,76 @@
+#ifndef SSC_SOCKET_HASH_HH
+#define SSC_SOCKET_HASH_HH
+
+#include "../common.hh"
+
+namespace SSC::Hash {
+  using Digest = std::vector<unsigned char>;
+
+  /**
+   * A streaming hash function. `update()` may be called any number of times
+   * before `digest()`, which finalizes the hasher.
+   */
+  class Hasher {
+    public:
+      virtual ~Hasher () = default;
+      virtual const char* name () const = 0;
+      virtual void update (const unsigned char *bytes, size_t size) = 0;
+      virtual Digest digest () = 0;
+  };
+
+  // FIPS 180-4
+  class SHA256 : public Hasher {
+    uint32_t state[8];
+    unsigned char block[64];
+    size_t blockSize = 0;
+    uint64_t length = 0;
+
+    void compress (const unsigned char *block);
+
+    public:
+      SHA256 ();
+      const char* name () const override { return "sha256"; }
+      void update (const unsigned char *bytes, size_t size) override;
+      Digest digest () override;
+  };
+
+  // RFC 7693, unkeyed
+  class BLAKE2b : public Hasher {
+    uint64_t state[8];
+    uint64_t counter[2] = { 0, 0 };
+    unsigned char block[128];
+    size_t blockSize = 0;
+    size_t outputSize = 64;
+
+    void compress (bool last);
+
+    public:
+      BLAKE2b (size_t outputSize = 64);
+      const char* name () const override;
+      void update (const unsigned char *bytes, size_t size) override;
+      Digest digest () override;
+  };
+
+  // XXH64, not cryptographic, for checksums where speed matters most
+  class XXH64 : public Hasher {
+    uint64_t lanes[4];
+    uint64_t seed = 0;
+    uint64_t length = 0;
+    unsigned char block[32];
+    size_t blockSize = 0;
+
+    public:
+      XXH64 (uint64_t seed = 0);
+      const char* name () const override { return "xxh64"; }
+      void update (const unsigned char *bytes, size_t size) override;
+      Digest digest () override;
+  };
+
+  /**
+   * Creates a hasher for `algorithm`: "sha256", "blake2b" (512 bit digest),
+   * "blake2b256" or "xxh64". Returns `nullptr` for anything else.
+   */
+  Hasher* create (const std::string& algorithm);
+  std::string toHex (const Digest& digest);
+}
+#endif
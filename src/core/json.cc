@@ -1,4 +1,19 @@
 #include "json.hh"
+#include <clocale>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SSC_JSON_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SSC_JSON_NEON 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace SSC::JSON {
   Number::Number (const String& string) {
@@ -6,181 +21,1013 @@ namespace SSC::JSON {
   }
 
   std::string Number::str () const {
-    if (this->data == 0) {
-      return "0";
+    Writer writer(32);
+    writer.writeNumber(this->data);
+    return writer.output;
+  }
+
+  std::string Object::str () const {
+    Writer writer;
+    writer.write(*this);
+    return writer.output;
+  }
+
+  std::string Array::str () const {
+    Writer writer;
+    writer.write(*this);
+    return writer.output;
+  }
+
+  std::string String::str () const {
+    Writer writer(this->data.size() + 2);
+    writer.writeString(this->data.data(), this->data.size());
+    return writer.output;
+  }
+
+  String::String (const Number& number) {
+    this->data = number.str();
+  }
+
+  static thread_local Arena::Scope *currentScope = nullptr;
+
+  Arena::Scope::Scope () {
+    this->previous = currentScope;
+    currentScope = this;
+  }
+
+  Arena::Scope::~Scope () {
+    currentScope = this->previous;
+  }
+
+  Arena * Arena::current () {
+    auto scope = currentScope;
+
+    if (scope == nullptr) {
+      return nullptr;
     }
 
-    auto value = this->data;
-    auto output = std::to_string(value);
-    auto decimal = output.find(".");
+    if (scope->arena == nullptr) {
+      scope->arena = std::make_shared<Arena>();
+    }
 
-    // trim trailing zeros
-    if (decimal >= 0) {
-      auto i = output.size() - 1;
-      while (output[i] != '0') {
-        i--;
-      }
+    return scope->arena.get();
+  }
 
-      return output.substr(0, i + 1);
+  Arena::~Arena () {
+    auto finalizer = this->finalizers;
+
+    while (finalizer != nullptr) {
+      auto next = finalizer->next;
+      finalizer->destroy(finalizer->pointer);
+      finalizer = next;
     }
 
-    return output;
+    for (auto pointer : this->allocations) {
+      delete [] static_cast<char *>(pointer);
+    }
+
+    for (const auto& block : this->blocks) {
+      delete [] block.first;
+    }
   }
 
-  std::string Object::str () const {
-    std::stringstream stream;
-    auto count = this->data.size();
-    stream << std::string("{");
+  void * Arena::allocate (size_t size, size_t alignment) {
+    if (size > MAX_ALLOCATION_SIZE && alignment <= alignof(std::max_align_t)) {
+      auto pointer = new char[size];
+      this->allocations.insert(pointer);
+      return pointer;
+    }
 
-    for (const auto& tuple : this->data) {
-      auto key = replace(tuple.first, "\"","\\\"");
-      auto value = tuple.second.str();
+    auto chunk = this->chunks.find(size);
 
-      stream << std::string("\"");
-      stream << key;
-      stream << std::string("\":");
-      stream << value;
+    if (chunk != this->chunks.end()) {
+      auto address = reinterpret_cast<uintptr_t>(chunk->second);
 
-      if (--count > 0) {
-        stream << std::string(",");
+      if ((address & (alignment - 1)) == 0) {
+        auto pointer = chunk->second;
+
+        if (pointer->next != nullptr) {
+          chunk->second = pointer->next;
+        } else {
+          this->chunks.erase(chunk);
+        }
+
+        return pointer;
       }
     }
 
-    stream << std::string("}");
-    return stream.str();
-  }
+    auto address = reinterpret_cast<uintptr_t>(this->cursor);
+    auto aligned = (address + alignment - 1) & ~(uintptr_t) (alignment - 1);
 
-  std::string Array::str () const {
-    std::stringstream stream;
-    auto count = this->data.size();
-    stream << std::string("[");
+    if (this->cursor == nullptr || aligned + size > reinterpret_cast<uintptr_t>(this->end)) {
+      // blocks double in size up to `MAX_BLOCK_SIZE`, or fit `size`
+      auto previous = this->blocks.size() > 0 ? this->blocks.back().second : 0;
+      auto blockSize = std::min(std::max(previous * 2, MIN_BLOCK_SIZE), MAX_BLOCK_SIZE);
+      blockSize = std::max(blockSize, size + alignment);
 
-    for (const auto value : this->data) {
-      stream << value.str();
+      auto block = new char[blockSize];
+      this->blocks.emplace_back(block, blockSize);
+      this->cursor = block;
+      this->end = block + blockSize;
 
-      if (--count > 0) {
-        stream << std::string(",");
+      address = reinterpret_cast<uintptr_t>(this->cursor);
+      aligned = (address + alignment - 1) & ~(uintptr_t) (alignment - 1);
+    }
+
+    this->cursor = reinterpret_cast<char *>(aligned + size);
+    return reinterpret_cast<void *>(aligned);
+  }
+
+  void Arena::deallocate (void *pointer, size_t size, size_t alignment) {
+    if (size > MAX_ALLOCATION_SIZE && alignment <= alignof(std::max_align_t)) {
+      if (this->allocations.erase(pointer) > 0) {
+        delete [] static_cast<char *>(pointer);
       }
+
+      return;
     }
 
-    stream << std::string("]");
-    return stream.str();
+    // the newest allocation is given back to its block
+    if (static_cast<char *>(pointer) + size == this->cursor) {
+      this->cursor = static_cast<char *>(pointer);
+      return;
+    }
+
+    if (size >= sizeof(Chunk)) {
+      auto chunk = static_cast<Chunk *>(pointer);
+      auto& head = this->chunks[size];
+      chunk->next = head;
+      head = chunk;
+    }
   }
 
-  String::String (const Number& number) {
-    this->data = number.str();
+  void Any::copy (const Any& any) {
+    this->type = any.type;
+    this->data = any.data;
+    this->arena = any.arena;
+
+    if (any.type == Type::Boolean) {
+      new (&this->boolean) Boolean(any.boolean);
+    } else if (any.type == Type::Number) {
+      new (&this->number) Number(any.number);
+    }
+
+    // a value inside a node of the arena holding its own node must not
+    // keep that arena alive, or the arena would never be freed
+    if (this->arena == nullptr) {
+      this->pointer = any.pointer;
+    } else if (this->arena == this->owner) {
+      this->pointer = nullptr;
+    } else if (any.pointer != nullptr) {
+      this->pointer = any.pointer;
+    } else {
+      this->pointer = this->arena->shared_from_this();
+    }
   }
 
-  Any::Any (const Null null) {
-    this->pointer = std::shared_ptr<void>(new Null());
-    this->type = Type::Null;
+  void Any::move (Any& any) {
+    this->type = any.type;
+    this->data = any.data;
+    this->arena = any.arena;
+
+    if (any.type == Type::Boolean) {
+      new (&this->boolean) Boolean(any.boolean);
+    } else if (any.type == Type::Number) {
+      new (&this->number) Number(any.number);
+    }
+
+    if (this->arena == nullptr) {
+      this->pointer = std::move(any.pointer);
+    } else if (this->arena == this->owner) {
+      this->pointer = nullptr;
+    } else if (any.pointer != nullptr) {
+      this->pointer = std::move(any.pointer);
+    } else {
+      this->pointer = this->arena->shared_from_this();
+    }
+
+    any.type = Type::Null;
+    any.data = nullptr;
+    any.arena = nullptr;
+    any.pointer = nullptr;
   }
 
-  Any::Any (std::nullptr_t) {
-    this->pointer = std::shared_ptr<void>(new Null());
-    this->type = Type::Null;
+  // nodes are created in the arena of the current scope, if there is one,
+  // or on the heap along with their reference count
+  template <typename T, typename... Args>
+  void Any::create (Type type, Args&&... args) {
+    auto arena = Arena::current();
+
+    this->type = type;
+    this->arena = arena;
+
+    if (arena == nullptr) {
+      auto node = std::make_shared<T>(std::forward<Args>(args)...);
+      this->data = node.get();
+      this->pointer = node;
+      return;
+    }
+
+    if constexpr (std::is_same<T, String>::value) {
+      this->data = arena->make<T>(std::forward<Args>(args)...);
+    } else {
+      this->data = arena->make<T>(std::forward<Args>(args)..., arena);
+    }
+
+    this->pointer = arena == this->owner ? nullptr : arena->shared_from_this();
   }
 
+  Any::Any (const Null null) : Any() {}
+  Any::Any (std::nullptr_t) : Any() {}
+
   Any::Any (const char *string) {
-    this->pointer = std::shared_ptr<void>(new String(string));
-    this->type = Type::String;
+    this->create<String>(Type::String, string);
   }
 
   Any::Any (const char string) {
-    this->pointer = std::shared_ptr<void>(new String(string));
-    this->type = Type::String;
+    this->create<String>(Type::String, string);
   }
 
-  Any::Any (const std::string string) {
-    this->pointer = std::shared_ptr<void>(new String(string));
-    this->type = Type::String;
+  Any::Any (const std::string& string) {
+    this->create<String>(Type::String, string);
   }
 
-  Any::Any (const String string) {
-    this->pointer = std::shared_ptr<void>(new String(string));
-    this->type = Type::String;
+  Any::Any (const String& string) {
+    this->create<String>(Type::String, string);
   }
 
   Any::Any (bool boolean) {
-    this->pointer = std::shared_ptr<void>(new Boolean(boolean));
+    this->data = nullptr;
     this->type = Type::Boolean;
+    new (&this->boolean) Boolean(boolean);
   }
 
   Any::Any (const Boolean boolean) {
-    this->pointer = std::shared_ptr<void>(new Boolean(boolean));
+    this->data = nullptr;
     this->type = Type::Boolean;
+    new (&this->boolean) Boolean(boolean);
   }
 
   Any::Any (int32_t number) {
-    this->pointer = std::shared_ptr<void>(new Number((double) number));
+    this->data = nullptr;
     this->type = Type::Number;
+    new (&this->number) Number((double) number);
   }
 
   Any::Any (uint32_t number) {
-    this->pointer = std::shared_ptr<void>(new Number((double) number));
+    this->data = nullptr;
     this->type = Type::Number;
+    new (&this->number) Number((double) number);
   }
 
   Any::Any (int64_t number) {
-    this->pointer = std::shared_ptr<void>(new Number((double) number));
+    this->data = nullptr;
     this->type = Type::Number;
+    new (&this->number) Number((double) number);
   }
 
   Any::Any (uint64_t number) {
-    this->pointer = std::shared_ptr<void>(new Number((double) number));
+    this->data = nullptr;
     this->type = Type::Number;
+    new (&this->number) Number((double) number);
   }
 
   Any::Any (double number) {
-    this->pointer = std::shared_ptr<void>(new Number((double) number));
+    this->data = nullptr;
     this->type = Type::Number;
+    new (&this->number) Number(number);
   }
 
   #if defined(__APPLE__)
   Any::Any (ssize_t  number) {
-    this->pointer = std::shared_ptr<void>(new Number((double) number));
+    this->data = nullptr;
     this->type = Type::Number;
+    new (&this->number) Number((double) number);
   }
   #endif
 
   Any::Any (const Number number) {
-    this->pointer = std::shared_ptr<void>(new Number(number));
+    this->data = nullptr;
     this->type = Type::Number;
+    new (&this->number) Number(number);
   }
 
-  Any::Any (const Object object) {
-    this->pointer = std::shared_ptr<void>(new Object(object));
-    this->type = Type::Object;
+  Any::Any (const Object& object) {
+    this->create<Object>(Type::Object, object);
   }
 
-  Any::Any (const Object::Entries entries) {
-    this->pointer = std::shared_ptr<void>(new Object(entries));
-    this->type = Type::Object;
+  Any::Any (const Object::Entries& entries) {
+    this->create<Object>(Type::Object, entries);
   }
 
-  Any::Any (const Array array) {
-    this->pointer = std::shared_ptr<void>(new Array(array));
-    this->type = Type::Array;
+  Any::Any (const Array& array) {
+    this->create<Array>(Type::Array, array);
   }
 
-  Any::Any (const Array::Entries entries) {
-    this->pointer = std::shared_ptr<void>(new Array(entries));
-    this->type = Type::Array;
+  Any::Any (const Array::Entries& entries) {
+    this->create<Array>(Type::Array, entries);
   }
 
   std::string Any::str () const {
-    auto ptr = this->pointer.get();
+    if (this->type == Type::Any) {
+      return "";
+    }
+
+    Writer writer;
+    writer.write(*this);
+    return writer.output;
+  }
+
+  // control characters, quote and backslash need escaping, nothing else
+  static constexpr auto ESCAPES = [] {
+    std::array<char, 256> table {};
+
+    for (int i = 0; i < 0x20; ++i) {
+      table[i] = 'u';
+    }
+
+    table['\b'] = 'b';
+    table['\f'] = 'f';
+    table['\n'] = 'n';
+    table['\r'] = 'r';
+    table['\t'] = 't';
+    table['"'] = '"';
+    table['\\'] = '\\';
+    return table;
+  }();
+
+  void Writer::reserve (size_t size) {
+    auto capacity = this->output.capacity();
+
+    if (capacity - this->output.size() < size) {
+      this->output.reserve(std::max(capacity * 2, this->output.size() + size));
+    }
+  }
+
+  void Writer::separate () {
+    if (this->afterKey) {
+      this->afterKey = false;
+      return;
+    }
+
+    if (this->first.size() > 0) {
+      if (!this->first.back()) {
+        this->output.push_back(',');
+      }
+
+      this->first.back() = false;
+    }
+  }
+
+  void Writer::writeString (const char *bytes, size_t size) {
+    static constexpr char hex[] = "0123456789abcdef";
+    auto end = bytes + size;
+    auto run = bytes;
+
+    // most strings need no escaping and are appended in one run
+    this->reserve(size + 2);
+    this->output.push_back('"');
+
+    for (auto cursor = bytes; cursor < end; ++cursor) {
+      auto escape = ESCAPES[(unsigned char) *cursor];
+
+      if (escape == 0) {
+        continue;
+      }
+
+      this->output.append(run, cursor - run);
+      run = cursor + 1;
+
+      if (escape == 'u') {
+        char sequence[6] = { '\\', 'u', '0', '0', hex[*cursor >> 4], hex[*cursor & 0xf] };
+        this->output.append(sequence, sizeof(sequence));
+      } else {
+        char sequence[2] = { '\\', escape };
+        this->output.append(sequence, sizeof(sequence));
+      }
+    }
+
+    this->output.append(run, end - run);
+    this->output.push_back('"');
+  }
+
+  void Writer::writeNumber (double number) {
+    char buffer[32];
+    int length = 0;
+
+    // JSON has no representation for these
+    if (!std::isfinite(number)) {
+      this->output.append("null", 4);
+      return;
+    }
+
+    if (number == std::trunc(number) && std::fabs(number) < 9007199254740992.0) {
+      auto integer = (int64_t) number;
+      auto value = (uint64_t) (integer < 0 ? -integer : integer);
+      auto cursor = buffer + sizeof(buffer);
+
+      do {
+        *--cursor = (char) ('0' + value % 10);
+        value /= 10;
+      } while (value > 0);
+
+      if (integer < 0) {
+        *--cursor = '-';
+      }
+
+      this->output.append(cursor, buffer + sizeof(buffer) - cursor);
+      return;
+    }
+
+    // the shortest of 15 or 17 significant digits that reads back exactly
+    length = snprintf(buffer, sizeof(buffer), "%.15g", number);
+
+    if (std::strtod(buffer, nullptr) != number) {
+      length = snprintf(buffer, sizeof(buffer), "%.17g", number);
+    }
+
+    // the decimal separator depends on the locale
+    for (int i = 0; i < length; ++i) {
+      if (buffer[i] == ',') {
+        buffer[i] = '.';
+      }
+    }
+
+    this->output.append(buffer, length);
+  }
+
+  void Writer::writeObject (const Object& object) {
+    auto first = true;
+    this->output.push_back('{');
+
+    for (const auto& tuple : object.data) {
+      if (!first) {
+        this->output.push_back(',');
+      }
+
+      first = false;
+      this->writeString(tuple.first.data(), tuple.first.size());
+      this->output.push_back(':');
+      this->writeValue(tuple.second);
+    }
+
+    this->output.push_back('}');
+  }
+
+  void Writer::writeArray (const Array& array) {
+    auto first = true;
+    this->output.push_back('[');
+
+    for (const auto& value : array.data) {
+      if (!first) {
+        this->output.push_back(',');
+      }
+
+      first = false;
+      this->writeValue(value);
+    }
+
+    this->output.push_back(']');
+  }
+
+  void Writer::writeValue (const Any& any) {
+    switch (any.type) {
+      case Type::Any:
+      case Type::Null:
+        this->output.append("null", 4);
+        break;
+
+      case Type::Object:
+        this->writeObject(*reinterpret_cast<Object *>(any.data));
+        break;
+
+      case Type::Array:
+        this->writeArray(*reinterpret_cast<Array *>(any.data));
+        break;
+
+      case Type::Boolean:
+        if (any.boolean.data) {
+          this->output.append("true", 4);
+        } else {
+          this->output.append("false", 5);
+        }
+        break;
+
+      case Type::Number:
+        this->writeNumber(any.number.data);
+        break;
+
+      case Type::String: {
+        const auto& string = reinterpret_cast<String *>(any.data)->data;
+        this->writeString(string.data(), string.size());
+        break;
+      }
+    }
+  }
+
+  void Writer::write (const Any& any) {
+    this->separate();
+    this->writeValue(any);
+  }
+
+  void Writer::write (const std::string& string) {
+    this->separate();
+    this->writeString(string.data(), string.size());
+  }
+
+  void Writer::write (const char *string) {
+    this->separate();
+    this->writeString(string, strlen(string));
+  }
+
+  void Writer::write (bool boolean) {
+    this->separate();
+    this->output.append(boolean ? "true" : "false");
+  }
+
+  void Writer::write (double number) {
+    this->separate();
+    this->writeNumber(number);
+  }
 
-    switch (this->type) {
-      case Type::Any: return "";
-      case Type::Null: return Null().str();
-      case Type::Object: return reinterpret_cast<Object *>(ptr)->str();
-      case Type::Array: return reinterpret_cast<Array *>(ptr)->str();
-      case Type::Boolean: return reinterpret_cast<Boolean *>(ptr)->str();
-      case Type::Number: return reinterpret_cast<Number *>(ptr)->str();
-      case Type::String: return reinterpret_cast<String *>(ptr)->str();
+  void Writer::write (std::nullptr_t) {
+    this->separate();
+    this->output.append("null", 4);
+  }
+
+  void Writer::beginObject () {
+    this->separate();
+    this->output.push_back('{');
+    this->first.push_back(true);
+  }
+
+  void Writer::endObject () {
+    this->first.pop_back();
+    this->output.push_back('}');
+  }
+
+  void Writer::beginArray () {
+    this->separate();
+    this->output.push_back('[');
+    this->first.push_back(true);
+  }
+
+  void Writer::endArray () {
+    this->first.pop_back();
+    this->output.push_back(']');
+  }
+
+  void Writer::key (const std::string& key) {
+    this->separate();
+    this->writeString(key.data(), key.size());
+    this->output.push_back(':');
+    this->afterKey = true;
+  }
+
+  // the number of bytes from `cursor` that may be copied into a string
+  // value as is, stopping at a quote, a backslash or a control character
+  static inline size_t scanStringBytes (const char *cursor, const char *end) {
+    const auto start = cursor;
+
+  #if defined(SSC_JSON_SSE2)
+    const auto quote = _mm_set1_epi8('"');
+    const auto backslash = _mm_set1_epi8('\\');
+    const auto control = _mm_set1_epi8(0x1f);
+
+    while (end - cursor >= 16) {
+      const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+      const auto matches = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+        // `max(byte, 0x1f) == 0x1f` for every unsigned byte below 0x20
+        _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control)
+      );
+
+      const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+
+      if (mask != 0) {
+      #if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return (cursor - start) + index;
+      #else
+        return (cursor - start) + __builtin_ctz(mask);
+      #endif
+      }
+
+      cursor += 16;
+    }
+  #elif defined(SSC_JSON_NEON)
+    const auto quote = vdupq_n_u8('"');
+    const auto backslash = vdupq_n_u8('\\');
+    const auto control = vdupq_n_u8(0x1f);
+
+    while (end - cursor >= 16) {
+      const auto chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(cursor));
+      const auto matches = vorrq_u8(
+        vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+        vcleq_u8(chunk, control)
+      );
+
+      if (vmaxvq_u8(matches) != 0) {
+        break;
+      }
+
+      cursor += 16;
+    }
+  #endif
+
+    while (cursor < end) {
+      const auto byte = static_cast<unsigned char>(*cursor);
+      if (byte == '"' || byte == '\\' || byte < 0x20) {
+        break;
+      }
+
+      cursor++;
+    }
+
+    return cursor - start;
+  }
+
+  class Parser {
+    static constexpr int MAX_DEPTH = 512;
+
+    const char *begin = nullptr;
+    const char *cursor = nullptr;
+    const char *end = nullptr;
+    int depth = 0;
+
+    [[noreturn]] void fail (const std::string& message) const {
+      throw Error(
+        "SyntaxError",
+        message + " at position " + std::to_string(this->cursor - this->begin),
+        "JSON::parse"
+      );
+    }
+
+    [[noreturn]] void unexpected () const {
+      if (this->cursor >= this->end) {
+        this->fail("Unexpected end of JSON input");
+      }
+
+      this->fail(std::string("Unexpected token '") + *this->cursor + "'");
+    }
+
+    void skipWhitespace () {
+      while (this->cursor < this->end) {
+        const auto byte = *this->cursor;
+        if (byte != ' ' && byte != '\n' && byte != '\r' && byte != '\t') {
+          break;
+        }
+
+        this->cursor++;
+      }
+    }
+
+    void expect (const char *literal, size_t size) {
+      if (
+        static_cast<size_t>(this->end - this->cursor) < size ||
+        std::memcmp(this->cursor, literal, size) != 0
+      ) {
+        this->unexpected();
+      }
+
+      this->cursor += size;
+    }
+
+    uint32_t parseHex () {
+      uint32_t code = 0;
+
+      if (this->end - this->cursor < 4) {
+        this->unexpected();
+      }
+
+      for (int i = 0; i < 4; ++i) {
+        const auto byte = *this->cursor;
+        code <<= 4;
+
+        if (byte >= '0' && byte <= '9') {
+          code |= byte - '0';
+        } else if (byte >= 'a' && byte <= 'f') {
+          code |= byte - 'a' + 10;
+        } else if (byte >= 'A' && byte <= 'F') {
+          code |= byte - 'A' + 10;
+        } else {
+          this->fail("Bad Unicode escape");
+        }
+
+        this->cursor++;
+      }
+
+      return code;
+    }
+
+    static void appendCodePoint (std::string& output, uint32_t code) {
+      if (code < 0x80) {
+        output.push_back(static_cast<char>(code));
+      } else if (code < 0x800) {
+        output.push_back(static_cast<char>(0xc0 | (code >> 6)));
+        output.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+      } else if (code < 0x10000) {
+        output.push_back(static_cast<char>(0xe0 | (code >> 12)));
+        output.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        output.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+      } else {
+        output.push_back(static_cast<char>(0xf0 | (code >> 18)));
+        output.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+        output.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        output.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+      }
+    }
+
+    // expects `cursor` just past the opening quote
+    void parseString (std::string& output) {
+      while (true) {
+        const auto run = scanStringBytes(this->cursor, this->end);
+        output.append(this->cursor, run);
+        this->cursor += run;
+
+        if (this->cursor >= this->end) {
+          this->fail("Unterminated string in JSON");
+        }
+
+        const auto byte = *this->cursor++;
+
+        if (byte == '"') {
+          return;
+        }
+
+        if (byte != '\\') {
+          this->cursor--;
+          this->fail("Bad control character in string literal");
+        }
+
+        if (this->cursor >= this->end) {
+          this->fail("Unterminated string in JSON");
+        }
+
+        switch (*this->cursor++) {
+          case '"': output.push_back('"'); break;
+          case '\\': output.push_back('\\'); break;
+          case '/': output.push_back('/'); break;
+          case 'b': output.push_back('\b'); break;
+          case 'f': output.push_back('\f'); break;
+          case 'n': output.push_back('\n'); break;
+          case 'r': output.push_back('\r'); break;
+          case 't': output.push_back('\t'); break;
+          case 'u': {
+            auto code = this->parseHex();
+
+            // a high surrogate followed by an escaped low surrogate is one
+            // code point, a lone surrogate is kept as is like `JSON.parse()`
+            if (
+              code >= 0xd800 && code <= 0xdbff &&
+              this->end - this->cursor >= 6 &&
+              this->cursor[0] == '\\' && this->cursor[1] == 'u'
+            ) {
+              const auto position = this->cursor;
+              this->cursor += 2;
+              const auto low = this->parseHex();
+
+              if (low >= 0xdc00 && low <= 0xdfff) {
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+              } else {
+                this->cursor = position;
+              }
+            }
+
+            appendCodePoint(output, code);
+            break;
+          }
+
+          default:
+            this->cursor--;
+            this->fail("Bad escaped character in JSON");
+        }
+      }
+    }
+
+    Any parseNumber () {
+      const auto start = this->cursor;
+      auto integral = true;
+
+      if (this->cursor < this->end && *this->cursor == '-') {
+        this->cursor++;
+      }
+
+      if (this->cursor < this->end && *this->cursor == '0') {
+        this->cursor++;
+      } else if (this->cursor < this->end && *this->cursor >= '1' && *this->cursor <= '9') {
+        while (this->cursor < this->end && *this->cursor >= '0' && *this->cursor <= '9') {
+          this->cursor++;
+        }
+      } else {
+        this->unexpected();
+      }
+
+      if (this->cursor < this->end && *this->cursor == '.') {
+        integral = false;
+        this->cursor++;
+
+        if (this->cursor >= this->end || *this->cursor < '0' || *this->cursor > '9') {
+          this->unexpected();
+        }
+
+        while (this->cursor < this->end && *this->cursor >= '0' && *this->cursor <= '9') {
+          this->cursor++;
+        }
+      }
+
+      if (this->cursor < this->end && (*this->cursor == 'e' || *this->cursor == 'E')) {
+        integral = false;
+        this->cursor++;
+
+        if (this->cursor < this->end && (*this->cursor == '+' || *this->cursor == '-')) {
+          this->cursor++;
+        }
+
+        if (this->cursor >= this->end || *this->cursor < '0' || *this->cursor > '9') {
+          this->unexpected();
+        }
+
+        while (this->cursor < this->end && *this->cursor >= '0' && *this->cursor <= '9') {
+          this->cursor++;
+        }
+      }
+
+      const auto size = static_cast<size_t>(this->cursor - start);
+      const auto negative = *start == '-';
+
+      // at most 15 digits always fit a double exactly
+      if (integral && size - negative <= 15) {
+        int64_t value = 0;
+
+        for (auto digit = start + negative; digit < this->cursor; ++digit) {
+          value = value * 10 + (*digit - '0');
+        }
+
+        // negate as a double so "-0" stays negative zero
+        return Any(negative ? -static_cast<double>(value) : static_cast<double>(value));
+      }
+
+      // `strtod()` reads the decimal point of the current locale
+      std::string token(start, size);
+      const auto point = std::localeconv()->decimal_point;
+
+      if (point != nullptr && point[0] != '.' && point[0] != '\0') {
+        for (auto& byte : token) {
+          if (byte == '.') {
+            byte = point[0];
+          }
+        }
+      }
+
+      return Any(std::strtod(token.c_str(), nullptr));
+    }
+
+    Any parseObject () {
+      Any result = Object();
+      auto& object = result.as<Object>();
+
+      this->cursor++;
+      this->skipWhitespace();
+
+      if (this->cursor < this->end && *this->cursor == '}') {
+        this->cursor++;
+        return result;
+      }
+
+      std::string key;
+
+      while (true) {
+        if (this->cursor >= this->end || *this->cursor != '"') {
+          this->unexpected();
+        }
+
+        this->cursor++;
+        key.clear();
+        this->parseString(key);
+        this->skipWhitespace();
+
+        if (this->cursor >= this->end || *this->cursor != ':') {
+          this->unexpected();
+        }
+
+        this->cursor++;
+        // a repeated key keeps the last value, like `JSON.parse()`
+        object[key] = this->parseValue();
+        this->skipWhitespace();
+
+        if (this->cursor < this->end && *this->cursor == ',') {
+          this->cursor++;
+          this->skipWhitespace();
+          continue;
+        }
+
+        if (this->cursor < this->end && *this->cursor == '}') {
+          this->cursor++;
+          return result;
+        }
+
+        this->unexpected();
+      }
+    }
+
+    Any parseArray () {
+      Any result = Array();
+      auto& array = result.as<Array>();
+
+      this->cursor++;
+      this->skipWhitespace();
+
+      if (this->cursor < this->end && *this->cursor == ']') {
+        this->cursor++;
+        return result;
+      }
+
+      while (true) {
+        array.set(array.size(), this->parseValue());
+        this->skipWhitespace();
+
+        if (this->cursor < this->end && *this->cursor == ',') {
+          this->cursor++;
+          continue;
+        }
+
+        if (this->cursor < this->end && *this->cursor == ']') {
+          this->cursor++;
+          return result;
+        }
+
+        this->unexpected();
+      }
     }
 
-    return "";
+    Any parseValue () {
+      this->skipWhitespace();
+
+      if (this->cursor >= this->end) {
+        this->unexpected();
+      }
+
+      switch (*this->cursor) {
+        case '{':
+        case '[': {
+          if (++this->depth > MAX_DEPTH) {
+            this->fail("Maximum nesting depth exceeded");
+          }
+
+          auto value = *this->cursor == '{' ? this->parseObject() : this->parseArray();
+          this->depth--;
+          return value;
+        }
+
+        case '"': {
+          std::string string;
+          this->cursor++;
+          this->parseString(string);
+          return Any(string);
+        }
+
+        case 't': this->expect("true", 4); return Any(true);
+        case 'f': this->expect("false", 5); return Any(false);
+        case 'n': this->expect("null", 4); return Any(nullptr);
+
+        default:
+          return this->parseNumber();
+      }
+    }
+
+    public:
+      Parser (const char *bytes, size_t size) {
+        this->begin = bytes;
+        this->cursor = bytes;
+        this->end = bytes + size;
+      }
+
+      Any parse () {
+        auto value = this->parseValue();
+        this->skipWhitespace();
+
+        if (this->cursor < this->end) {
+          this->unexpected();
+        }
+
+        return value;
+      }
+  };
+
+  Any parse (const char *bytes, size_t size) {
+    // the whole document is freed at once, along with its last value
+    Arena::Scope scope;
+
+    if (bytes == nullptr) {
+      size = 0;
+    }
+
+    return Parser(bytes, size).parse();
+  }
+
+  Any parse (const std::string& string) {
+    return parse(string.data(), string.size());
   }
 }
@@ -12,18 +12,12 @@ namespace SSC::JSON {
   class Boolean;
   class Number;
   class String;
+  class Writer;
+  class Arena;
+  class ObjectEntries;
 
-  using ObjectEntries = std::map<std::string, Any>;
   using ArrayEntries = std::vector<Any>;
 
-  inline auto replace (
-    const std::string &source,
-    const std::string &pattern,
-    const std::string &value
-  ) {
-    return std::regex_replace(source, std::regex(pattern), value);
-  }
-
   class Error : public std::invalid_argument {
     public:
       std::string name;
@@ -108,12 +102,250 @@ namespace SSC::JSON {
 
   const Null null;
 
+  /**
+   * Allocates the objects, arrays and strings of a value in blocks that are
+   * freed all at once, with the last `Any` referring to any of them. A value
+   * inside a node of the same arena does not keep the arena alive, so a
+   * reply built in one is released in one shot after it is serialized.
+   * Nodes are created in the arena of the innermost `Arena::Scope` on the
+   * calling thread, and an arena should only be grown from one thread.
+   */
+  class Arena : public std::enable_shared_from_this<Arena> {
+    struct Finalizer {
+      void (*destroy)(void *);
+      void *pointer;
+      Finalizer *next;
+    };
+
+    // storage given back by a container that grew, reused for the next
+    // allocation of the same size
+    struct Chunk {
+      Chunk *next;
+    };
+
+    std::vector<std::pair<char *, size_t>> blocks;
+    std::map<size_t, Chunk *> chunks;
+    std::set<void *> allocations;
+    Finalizer *finalizers = nullptr;
+    char *cursor = nullptr;
+    char *end = nullptr;
+
+    public:
+      static constexpr size_t MIN_BLOCK_SIZE = 4 * 1024;
+      static constexpr size_t MAX_BLOCK_SIZE = 256 * 1024;
+      // larger allocations are made on the heap and freed when a container
+      // grows out of them, instead of taking up blocks until the arena ends
+      static constexpr size_t MAX_ALLOCATION_SIZE = 16 * 1024;
+
+      // the arena of the container an element is being constructed in on
+      // this thread, see `Allocator::construct()`
+      static inline thread_local Arena *constructing = nullptr;
+
+      /**
+       * Makes a new arena current for the nodes created on this thread
+       * until the scope ends. The arena is only allocated once used.
+       */
+      class Scope {
+        friend Arena;
+        Scope *previous = nullptr;
+        std::shared_ptr<Arena> arena = nullptr;
+
+        public:
+          Scope ();
+          ~Scope ();
+          Scope (const Scope&) = delete;
+          Scope& operator = (const Scope&) = delete;
+      };
+
+      Arena () = default;
+      Arena (const Arena&) = delete;
+      Arena& operator = (const Arena&) = delete;
+      ~Arena ();
+
+      // the arena of the innermost scope on this thread, if any
+      static Arena * current ();
+
+      void * allocate (size_t size, size_t alignment);
+      void deallocate (void *pointer, size_t size, size_t alignment);
+
+      template <typename T, typename... Args> T * make (Args&&... args) {
+        auto pointer = new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        auto finalizer = static_cast<Finalizer *>(
+          this->allocate(sizeof(Finalizer), alignof(Finalizer))
+        );
+
+        finalizer->destroy = [](void *pointer) {
+          static_cast<T *>(pointer)->~T();
+        };
+
+        finalizer->pointer = pointer;
+        finalizer->next = this->finalizers;
+        this->finalizers = finalizer;
+        return pointer;
+      }
+  };
+
+  // allocates from `arena` when set and from the heap otherwise, and is not
+  // carried over to copies, so only the containers of nodes use an arena
+  template <typename T> class Allocator {
+    public:
+      using value_type = T;
+      using propagate_on_container_copy_assignment = std::false_type;
+      using propagate_on_container_move_assignment = std::true_type;
+      using propagate_on_container_swap = std::true_type;
+
+      Arena *arena = nullptr;
+
+      Allocator () = default;
+      Allocator (Arena *arena) : arena(arena) {}
+      template <typename U> Allocator (const Allocator<U>& allocator)
+        : arena(allocator.arena)
+      {}
+
+      T * allocate (size_t size) {
+        if (this->arena != nullptr) {
+          return static_cast<T *>(this->arena->allocate(size * sizeof(T), alignof(T)));
+        }
+
+        return std::allocator<T>().allocate(size);
+      }
+
+      void deallocate (T *pointer, size_t size) {
+        if (this->arena != nullptr) {
+          this->arena->deallocate(pointer, size * sizeof(T), alignof(T));
+        } else {
+          std::allocator<T>().deallocate(pointer, size);
+        }
+      }
+
+      // elements note the arena they are stored in, see `Any::owner`
+      template <typename U, typename... Args> void construct (U *pointer, Args&&... args) {
+        struct Restore {
+          Arena *previous = Arena::constructing;
+          ~Restore () { Arena::constructing = this->previous; }
+        } restore;
+
+        Arena::constructing = this->arena;
+        new (pointer) U(std::forward<Args>(args)...);
+      }
+
+      Allocator select_on_container_copy_construction () const {
+        return Allocator();
+      }
+
+      template <typename U> bool operator == (const Allocator<U>& allocator) const {
+        return this->arena == allocator.arena;
+      }
+
+      template <typename U> bool operator != (const Allocator<U>& allocator) const {
+        return this->arena != allocator.arena;
+      }
+  };
+
+  class Boolean : Value<bool, Type::Boolean> {
+    friend Writer;
+
+    public:
+      Boolean () = default;
+      Boolean (const Boolean& boolean) {
+        this->data = boolean.value();
+      }
+
+      Boolean (bool boolean) {
+        this->data = boolean;
+      }
+
+      Boolean (int data) {
+        this->data = data != 0;
+      }
+
+      Boolean (int64_t data) {
+        this->data = data != 0;
+      }
+
+      Boolean (double data) {
+        this->data = data != 0;
+      }
+
+      Boolean (void *data) {
+        this->data = data != nullptr;
+      }
+
+      Boolean (std::string string) {
+        this->data = string.size() > 0;
+      }
+
+      bool value () const {
+        return this->data;
+      }
+
+      std::string str () const {
+        return this->data ? "true" : "false";
+      }
+  };
+
+  class Number : Value<double, Type::Number> {
+    friend Writer;
+
+    public:
+      Number () = default;
+      Number (const Number& number) {
+        this->data = number.value();
+      }
+
+      Number (double number) {
+        this->data = number;
+      }
+
+      Number (char number) {
+        this->data = (double) number;
+      }
+
+      Number (int number) {
+        this->data = (double) number;
+      }
+
+      Number (int64_t number) {
+        this->data = (double) number;
+      }
+
+      Number (bool number) {
+        this->data = (double) number;
+      }
+
+      Number (const String& string);
+
+      double value () const {
+        return this->data;
+      }
+
+      std::string str () const;
+  };
+
   class Any : public Value<void *, Type::Any> {
+    friend Writer;
+
+    // booleans and numbers are stored inline, `data` points at the node of
+    // an object, array or string
+    union {
+      Boolean boolean;
+      Number number;
+    };
+
+    void copy (const Any& any);
+    void move (Any& any);
+    template <typename T, typename... Args> void create (Type type, Args&&... args);
+
     public:
+      // keeps the node or its arena alive, unset for inline values and for
+      // values inside a node of the arena their own node is in
       std::shared_ptr<void> pointer;
+      Arena *arena = nullptr;
+      // the arena of the node this value is stored in, kept on assignment
+      Arena *owner = Arena::constructing;
 
       Any () {
-        this->pointer = nullptr;
+        this->data = nullptr;
         this->type = Type::Null;
       }
 
@@ -122,9 +354,28 @@ namespace SSC::JSON {
         this->type = Type::Any;
       }
 
-      Any (const Any &any) {
-        this->pointer = any.pointer;
-        this->type = any.type;
+      Any (const Any& any) {
+        this->copy(any);
+      }
+
+      Any (Any&& any) noexcept {
+        this->move(any);
+      }
+
+      Any& operator = (const Any& any) {
+        if (this != &any) {
+          this->copy(any);
+        }
+
+        return *this;
+      }
+
+      Any& operator = (Any&& any) noexcept {
+        if (this != &any) {
+          this->move(any);
+        }
+
+        return *this;
       }
 
       Any (std::nullptr_t);
@@ -142,20 +393,26 @@ namespace SSC::JSON {
       Any (const Number);
       Any (const char);
       Any (const char *);
-      Any (const std::string);
-      Any (const String);
-      Any (const Object);
-      Any (const ObjectEntries);
-      Any (const Array);
-      Any (const ArrayEntries);
+      Any (const std::string&);
+      Any (const String&);
+      Any (const Object&);
+      Any (const ObjectEntries&);
+      Any (const Array&);
+      Any (const ArrayEntries&);
 
       std::string str () const;
 
       template <typename T> T& as () const {
-        auto ptr = this->pointer.get();
+        if (this->type == Type::Boolean) {
+          return *reinterpret_cast<T *>(const_cast<Boolean *>(&this->boolean));
+        }
 
-        if (ptr != nullptr && this->type != Type::Null) {
-          return *reinterpret_cast<T *>(ptr);
+        if (this->type == Type::Number) {
+          return *reinterpret_cast<T *>(const_cast<Number *>(&this->number));
+        }
+
+        if (this->data != nullptr && this->type != Type::Null) {
+          return *reinterpret_cast<T *>(this->data);
         }
 
         throw Error("BadCastError", "cannot cast to null value", __PRETTY_FUNCTION__);
@@ -166,27 +423,133 @@ namespace SSC::JSON {
     return any.typeof();
   }
 
+  /**
+   * The entries of an object in insertion order. Lookups scan the entries,
+   * which is faster than a tree for the few keys of most values.
+   */
+  class ObjectEntries {
+    public:
+      using value_type = std::pair<std::string, Any>;
+      using Storage = std::vector<value_type, Allocator<value_type>>;
+      using iterator = Storage::iterator;
+      using const_iterator = Storage::const_iterator;
+
+      Storage items;
+
+      ObjectEntries () = default;
+      ObjectEntries (const ObjectEntries&) = default;
+      ObjectEntries (ObjectEntries&&) = default;
+      ObjectEntries& operator = (const ObjectEntries&) = default;
+      ObjectEntries& operator = (ObjectEntries&&) = default;
+
+      // a repeated key keeps its first value, like `std::map`
+      ObjectEntries (std::initializer_list<value_type> entries) {
+        this->items.reserve(entries.size());
+
+        for (const auto& entry : entries) {
+          if (this->find(entry.first) == this->end()) {
+            this->items.push_back(entry);
+          }
+        }
+      }
+
+      ObjectEntries (const ObjectEntries& entries, Arena *arena)
+        : items(entries.items.begin(), entries.items.end(), Allocator<value_type>(arena))
+      {}
+
+      iterator begin () { return this->items.begin(); }
+      iterator end () { return this->items.end(); }
+      const_iterator begin () const { return this->items.begin(); }
+      const_iterator end () const { return this->items.end(); }
+
+      auto size () const { return this->items.size(); }
+      auto empty () const { return this->items.empty(); }
+      void reserve (size_t size) { this->items.reserve(size); }
+
+      iterator find (const std::string& key) {
+        auto it = this->items.begin();
+        while (it != this->items.end() && it->first != key) ++it;
+        return it;
+      }
+
+      const_iterator find (const std::string& key) const {
+        auto it = this->items.begin();
+        while (it != this->items.end() && it->first != key) ++it;
+        return it;
+      }
+
+      size_t count (const std::string& key) const {
+        return this->find(key) != this->end() ? 1 : 0;
+      }
+
+      const Any& at (const std::string& key) const {
+        auto it = this->find(key);
+
+        if (it == this->end()) {
+          throw std::out_of_range("JSON::ObjectEntries::at");
+        }
+
+        return it->second;
+      }
+
+      Any& operator [] (const std::string& key) {
+        auto it = this->find(key);
+
+        if (it != this->end()) {
+          return it->second;
+        }
+
+        this->items.emplace_back(key, Any());
+        return this->items.back().second;
+      }
+
+      void insert_or_assign (const std::string& key, const Any& value) {
+        (*this)[key] = value;
+      }
+
+      size_t erase (const std::string& key) {
+        auto it = this->find(key);
+
+        if (it == this->end()) {
+          return 0;
+        }
+
+        this->items.erase(it);
+        return 1;
+      }
+  };
+
   class Object : Value<ObjectEntries, Type::Object> {
+    friend Writer;
+    friend Arena;
+
+    // a node in `arena`, see `Any::create()`
+    Object (const ObjectEntries& entries, Arena *arena) {
+      this->data = ObjectEntries(entries, arena);
+    }
+
+    Object (const Object& object, Arena *arena) {
+      this->data = ObjectEntries(object.data, arena);
+    }
+
     public:
       using Entries = ObjectEntries;
       Object () = default;
-      Object (const Object::Entries entries) {
-        for (const auto& tuple : entries) {
-          auto key = tuple.first;
-          auto value = tuple.second;
-          this->data.insert_or_assign(key, value);
-        }
+      Object (const Object::Entries& entries) {
+        this->data = entries;
       }
 
       Object (const Object& object) {
-        this->data = object.value();
+        this->data = object.data;
       }
 
+      Object& operator = (const Object&) = default;
+
       Object (const std::map<std::string, std::string> map) {
+        this->data.reserve(map.size());
+
         for (const auto& tuple : map) {
-          auto key = tuple.first;
-          auto value = Any(tuple.second);
-          this->data.insert_or_assign(key, value);
+          this->data.items.emplace_back(tuple.first, Any(tuple.second));
         }
       }
 
@@ -196,9 +559,16 @@ namespace SSC::JSON {
         return this->data;
       }
 
+      // the entries without a copy, valid as long as the object is
+      const Object::Entries& entries () const {
+        return this->data;
+      }
+
       Any get (const std::string key) const {
-        if (this->data.find(key) != this->data.end()) {
-          return this->data.at(key);
+        auto it = this->data.find(key);
+
+        if (it != this->data.end()) {
+          return it->second;
         }
 
         return null;
@@ -213,8 +583,10 @@ namespace SSC::JSON {
       }
 
       Any operator [] (const std::string& key) const {
-        if (this->data.find(key) != this->data.end()) {
-          return this->data.at(key);
+        auto it = this->data.find(key);
+
+        if (it != this->data.end()) {
+          return it->second;
         }
 
         return nullptr;
@@ -229,24 +601,44 @@ namespace SSC::JSON {
       }
   };
 
-  class Array : Value<ArrayEntries, Type::Array> {
+  class Array : Value<std::vector<Any, Allocator<Any>>, Type::Array> {
+    friend Writer;
+    friend Arena;
+
+    // a node in `arena`, see `Any::create()`
+    Array (const ArrayEntries& entries, Arena *arena) {
+      this->data = std::vector<Any, Allocator<Any>>(
+        entries.begin(),
+        entries.end(),
+        Allocator<Any>(arena)
+      );
+    }
+
+    Array (const Array& array, Arena *arena) {
+      this->data = std::vector<Any, Allocator<Any>>(
+        array.data.begin(),
+        array.data.end(),
+        Allocator<Any>(arena)
+      );
+    }
+
     public:
       using Entries = ArrayEntries;
       Array () = default;
       Array (const Array& array) {
-        this->data = array.value();
+        this->data = array.data;
       }
 
-      Array (const Array::Entries entries) {
-        for (const auto& value : entries) {
-          this->data.push_back(value);
-        }
+      Array& operator = (const Array&) = default;
+
+      Array (const Array::Entries& entries) {
+        this->data.assign(entries.begin(), entries.end());
       }
 
       std::string str () const;
 
       Array::Entries value () const {
-        return this->data;
+        return Array::Entries(this->data.begin(), this->data.end());
       }
 
       Any get (const unsigned int index) const {
@@ -286,83 +678,9 @@ namespace SSC::JSON {
       }
   };
 
-  class Boolean : Value<bool, Type::Boolean> {
-    public:
-      Boolean () = default;
-      Boolean (const Boolean& boolean) {
-        this->data = boolean.value();
-      }
-
-      Boolean (bool boolean) {
-        this->data = boolean;
-      }
-
-      Boolean (int data) {
-        this->data = data != 0;
-      }
-
-      Boolean (int64_t data) {
-        this->data = data != 0;
-      }
-
-      Boolean (double data) {
-        this->data = data != 0;
-      }
-
-      Boolean (void *data) {
-        this->data = data != nullptr;
-      }
-
-      Boolean (std::string string) {
-        this->data = string.size() > 0;
-      }
-
-      bool value () const {
-        return this->data;
-      }
-
-      std::string str () const {
-        return this->data ? "true" : "false";
-      }
-  };
-
-  class Number : Value<double, Type::Number> {
-    public:
-      Number () = default;
-      Number (const Number& number) {
-        this->data = number.value();
-      }
-
-      Number (double number) {
-        this->data = number;
-      }
-
-      Number (char number) {
-        this->data = (double) number;
-      }
-
-      Number (int number) {
-        this->data = (double) number;
-      }
-
-      Number (int64_t number) {
-        this->data = (double) number;
-      }
-
-      Number (bool number) {
-        this->data = (double) number;
-      }
-
-      Number (const String& string);
-
-      float value () const {
-        return this->data;
-      }
-
-      std::string str () const;
-  };
-
   class String : Value<std::string, Type::Number> {
+    friend Writer;
+
     public:
       String () = default;
       String (const String& data) {
@@ -391,10 +709,7 @@ namespace SSC::JSON {
         this->data = boolean.str();
       }
 
-      std::string str () const {
-        auto escaped = replace(this->data, "\"", "\\\"");
-        return "\"" + replace(escaped, "\n", "\\n") + "\"";
-      }
+      std::string str () const;
 
       std::string value () const {
         return this->data;
@@ -404,6 +719,64 @@ namespace SSC::JSON {
         return this->data.size();
       }
   };
+
+  /**
+   * Serializes values into a single buffer, growing it ahead of what is
+   * written. Values are written whole with `write()`, or streamed with the
+   * `begin*()`, `key()` and `end*()` calls, which insert separators.
+   */
+  class Writer {
+    // one entry per open object or array, `true` until a value is written
+    std::vector<bool> first;
+    bool afterKey = false;
+
+    void separate ();
+    void writeValue (const Any& any);
+    void writeObject (const Object& object);
+    void writeArray (const Array& array);
+
+    public:
+      std::string output;
+
+      Writer (size_t capacity = 256) {
+        this->output.reserve(capacity);
+      }
+
+      void reserve (size_t size);
+
+      void write (const Any& any);
+      void write (const std::string& string);
+      void write (const char *string);
+      void write (bool boolean);
+      void write (double number);
+      void write (int32_t number) { this->write((double) number); }
+      void write (uint32_t number) { this->write((double) number); }
+      void write (int64_t number) { this->write((double) number); }
+      void write (uint64_t number) { this->write((double) number); }
+      void write (std::nullptr_t);
+
+      void beginObject ();
+      void endObject ();
+      void beginArray ();
+      void endArray ();
+      void key (const std::string& key);
+
+      // raw writes, without separators
+      void writeString (const char *bytes, size_t size);
+      void writeNumber (double number);
+
+      const std::string& str () const {
+        return this->output;
+      }
+  };
+
+  /**
+   * Parses `size` bytes of JSON text. Runs of string bytes are scanned 16
+   * at a time where SSE2 or NEON is available. Throws a "SyntaxError"
+   * `JSON::Error` with the byte offset of the first invalid character.
+   */
+  Any parse (const char *bytes, size_t size);
+  Any parse (const std::string& string);
 }
 
 #endif
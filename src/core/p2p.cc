@@ -0,0 +1,716 @@
+#include "core.hh"
+
+namespace SSC {
+  // Wire format (big endian):
+  //   DATA: [version:1][type:1][flags:1][reserved:1][seq:8][payload:N]
+  //   ACK:  [version:1][type:1][flags:1][reserved:1][ack:8][sack:8]
+  // `ack` is the next expected sequence and bit `i` of `sack` is set if
+  // sequence `ack + 1 + i` has been received out of order.
+  static constexpr uint8_t P2P_PROTOCOL_VERSION = 1;
+  static constexpr uint8_t P2P_PACKET_TYPE_DATA = 1;
+  static constexpr uint8_t P2P_PACKET_TYPE_ACK = 2;
+  static constexpr uint8_t P2P_FLAG_MORE_FRAGMENTS = 1 << 0;
+  static constexpr size_t P2P_DATA_HEADER_SIZE = 12;
+  static constexpr size_t P2P_ACK_PACKET_SIZE = 20;
+  static constexpr int P2P_FAST_RETRANSMIT_THRESHOLD = 3;
+
+  static inline void writeUInt64BE (char *bytes, uint64_t value) {
+    for (int i = 7; i >= 0; --i) {
+      bytes[i] = (char) (value & 0xFF);
+      value >>= 8;
+    }
+  }
+
+  static inline uint64_t readUInt64BE (const char *bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+      value = (value << 8) | (uint8_t) bytes[i];
+    }
+    return value;
+  }
+
+  static JSON::Object::Entries ERR_P2P_CHANNEL_NOT_FOUND (
+    const String& source,
+    uint64_t id
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"code", "NOT_FOUND_ERR"},
+        {"type", "NotFoundError"},
+        {"message", "No channel with specified id"}
+      }}
+    };
+  }
+
+  Core::P2P::Channel::Channel (Core *core, uint64_t id, Peer *peer) {
+    this->core = core;
+    this->peer = peer;
+    this->id = id;
+
+    uv_timer_init(core->getEventLoop(), &this->timer);
+    this->timer.data = (void *) this;
+  }
+
+  int Core::P2P::Channel::enqueue (const char *bytes, size_t size) {
+    auto fragments = std::max((size_t) 1, (size + MAX_PAYLOAD_SIZE - 1) / MAX_PAYLOAD_SIZE);
+    size_t offset = 0;
+
+    // callers wait for the queue to drain instead of growing it without bound
+    if (this->pending.size() + fragments > MAX_PENDING_PACKETS) {
+      return UV_ENOBUFS;
+    }
+
+    // messages larger than `MAX_PAYLOAD_SIZE` are split into fragments that
+    // are reassembled in order by the receiver, empty messages are a single
+    // empty fragment
+    do {
+      auto length = std::min(size - offset, MAX_PAYLOAD_SIZE);
+      auto packet = std::make_shared<Vector<char>>(P2P_DATA_HEADER_SIZE + length);
+      auto data = packet->data();
+
+      data[0] = P2P_PROTOCOL_VERSION;
+      data[1] = P2P_PACKET_TYPE_DATA;
+      data[2] = offset + length < size ? P2P_FLAG_MORE_FRAGMENTS : 0;
+      data[3] = 0;
+      writeUInt64BE(data + 4, this->nextSeq++);
+
+      if (length > 0) {
+        memcpy(data + P2P_DATA_HEADER_SIZE, bytes + offset, length);
+      }
+
+      this->pending.push(packet);
+      offset += length;
+    } while (offset < size);
+
+    this->flush();
+    return 0;
+  }
+
+  void Core::P2P::Channel::receive (const char *bytes, size_t size) {
+    if (size < P2P_DATA_HEADER_SIZE || bytes[0] != P2P_PROTOCOL_VERSION) {
+      return;
+    }
+
+    if (bytes[1] == P2P_PACKET_TYPE_ACK) {
+      if (size >= P2P_ACK_PACKET_SIZE) {
+        this->onack(readUInt64BE(bytes + 4), readUInt64BE(bytes + 12));
+      }
+
+      return;
+    }
+
+    if (bytes[1] != P2P_PACKET_TYPE_DATA) {
+      return;
+    }
+
+    auto seq = readUInt64BE(bytes + 4);
+    this->packetsReceived++;
+
+    // duplicates and packets too far ahead are only acknowledged
+    if (
+      seq >= this->recvNext &&
+      seq < this->recvNext + MAX_RECEIVE_WINDOW &&
+      this->reorder.find(seq) == this->reorder.end()
+    ) {
+      this->reorder.emplace(seq, Vector<char>(bytes, bytes + size));
+    }
+
+    while (true) {
+      auto entry = this->reorder.find(this->recvNext);
+
+      if (entry == this->reorder.end()) {
+        break;
+      }
+
+      auto& packet = entry->second;
+      auto final = (packet[2] & P2P_FLAG_MORE_FRAGMENTS) == 0;
+      auto payloadSize = packet.size() - P2P_DATA_HEADER_SIZE;
+      auto deliver = final;
+
+      if (this->discarding) {
+        // the rest of a message that was dropped for growing too large
+        this->discarding = !final;
+        deliver = false;
+      } else if (this->message.size() + payloadSize > MAX_MESSAGE_SIZE) {
+        // no sender can enqueue a message this large, so drop it and skip
+        // its remaining fragments rather than buffering without bound
+        this->message.clear();
+        this->message.shrink_to_fit();
+        this->dropped++;
+        this->discarding = !final;
+        deliver = false;
+      } else {
+        this->message.insert(
+          this->message.end(),
+          packet.begin() + P2P_DATA_HEADER_SIZE,
+          packet.end()
+        );
+      }
+
+      if (deliver) {
+        auto length = this->message.size();
+        char *body = nullptr;
+
+        if (length > 0) {
+          body = new char[length];
+          memcpy(body, this->message.data(), length);
+        }
+
+        this->message.clear();
+        this->delivered++;
+
+        if (this->onmessage != nullptr) {
+          this->onmessage(body, length);
+        } else if (body != nullptr) {
+          delete [] body;
+        }
+      }
+
+      this->reorder.erase(entry);
+      this->recvNext++;
+    }
+
+    this->sendAck();
+  }
+
+  void Core::P2P::Channel::sendAck () {
+    auto packet = std::make_shared<Vector<char>>(P2P_ACK_PACKET_SIZE);
+    auto data = packet->data();
+    uint64_t sack = 0;
+
+    for (const auto& tuple : this->reorder) {
+      auto distance = tuple.first - this->recvNext - 1;
+      if (distance >= 64) break;
+      sack |= (uint64_t) 1 << distance;
+    }
+
+    data[0] = P2P_PROTOCOL_VERSION;
+    data[1] = P2P_PACKET_TYPE_ACK;
+    data[2] = 0;
+    data[3] = 0;
+    writeUInt64BE(data + 4, this->recvNext);
+    writeUInt64BE(data + 12, sack);
+
+    if (this->peer != nullptr) {
+      this->peer->send(data, packet->size(), 0, "", [packet](auto status, auto post) {});
+    }
+  }
+
+  void Core::P2P::Channel::transmit (uint64_t seq, Segment& segment) {
+    auto packet = segment.packet;
+
+    segment.sentAt = uv_now(this->core->getEventLoop());
+    segment.missed = 0;
+    segment.lost = false;
+
+    if (segment.transmissions++ > 0) {
+      this->retransmits++;
+    }
+
+    this->packetsSent++;
+
+    if (this->peer == nullptr) {
+      return;
+    }
+
+    this->peer->send(packet->data(), packet->size(), 0, "", [packet](auto status, auto post) {
+      // lost sends are recovered by the retransmission timer
+    });
+  }
+
+  void Core::P2P::Channel::sample (uint64_t rtt) {
+    // @see https://www.rfc-editor.org/rfc/rfc6298
+    if (this->srtt == 0) {
+      this->srtt = (double) rtt;
+      this->rttvar = (double) rtt / 2;
+    } else {
+      this->rttvar = 0.75 * this->rttvar + 0.25 * std::abs(this->srtt - (double) rtt);
+      this->srtt = 0.875 * this->srtt + 0.125 * (double) rtt;
+    }
+
+    auto rto = (uint64_t) (this->srtt + std::max(1.0, 4 * this->rttvar));
+    this->rto = std::clamp(rto, MIN_RTO, MAX_RTO);
+  }
+
+  void Core::P2P::Channel::onack (uint64_t ack, uint64_t sack) {
+    auto now = uv_now(this->core->getEventLoop());
+    uint64_t highest = 0;
+    int acked = 0;
+
+    // cumulative acknowledgement
+    while (!this->inflight.empty() && this->inflight.begin()->first < ack) {
+      auto& segment = this->inflight.begin()->second;
+
+      if (!segment.sacked) {
+        // Karn's algorithm: never sample retransmitted segments
+        if (segment.transmissions == 1) {
+          this->sample(now - segment.sentAt);
+        }
+
+        acked++;
+      }
+
+      this->inflight.erase(this->inflight.begin());
+    }
+
+    // selective acknowledgements
+    for (int i = 0; i < 64; ++i) {
+      if ((sack & ((uint64_t) 1 << i)) == 0) {
+        continue;
+      }
+
+      auto seq = ack + 1 + i;
+      auto entry = this->inflight.find(seq);
+      highest = seq;
+
+      if (entry == this->inflight.end() || entry->second.sacked) {
+        continue;
+      }
+
+      if (entry->second.transmissions == 1) {
+        this->sample(now - entry->second.sentAt);
+      }
+
+      entry->second.sacked = true;
+      acked++;
+    }
+
+    // unacknowledged segments below the highest selectively acknowledged
+    // one are presumed lost after enough acks have skipped over them
+    for (auto& tuple : this->inflight) {
+      auto seq = tuple.first;
+      auto& segment = tuple.second;
+
+      if (seq >= highest) {
+        break;
+      }
+
+      if (segment.sacked || segment.lost) {
+        continue;
+      }
+
+      if (++segment.missed == P2P_FAST_RETRANSMIT_THRESHOLD) {
+        // only back off once per window of data
+        if (seq >= this->recoverySeq) {
+          this->ssthresh = std::max(this->cwnd / 2, 2.0);
+          this->cwnd = this->ssthresh;
+          this->recoverySeq = this->nextSeq;
+        }
+
+        // retransmitted by `flush()` within the window
+        segment.lost = true;
+      }
+    }
+
+    for (int i = 0; i < acked; ++i) {
+      if (this->cwnd < this->ssthresh) {
+        this->cwnd += 1; // slow start
+      } else {
+        this->cwnd += 1 / this->cwnd; // congestion avoidance
+      }
+    }
+
+    this->cwnd = std::min(this->cwnd, MAX_CWND);
+    this->flush();
+  }
+
+  void Core::P2P::Channel::ontimeout () {
+    auto now = uv_now(this->core->getEventLoop());
+    auto expired = false;
+
+    // expired segments are only marked lost here, `flush()` retransmits
+    // them oldest first as the collapsed window and the pacer allow
+    for (auto& tuple : this->inflight) {
+      auto& segment = tuple.second;
+
+      if (!segment.sacked && !segment.lost && now - segment.sentAt >= this->rto) {
+        segment.lost = true;
+        expired = true;
+      }
+    }
+
+    if (expired) {
+      this->ssthresh = std::max(this->cwnd / 2, 2.0);
+      this->cwnd = 1;
+      this->rto = std::min(this->rto * 2, MAX_RTO);
+      this->recoverySeq = this->nextSeq;
+    }
+
+    this->flush();
+  }
+
+  // segments sent and neither acknowledged nor presumed lost
+  size_t Core::P2P::Channel::outstanding () const {
+    size_t count = 0;
+
+    for (const auto& tuple : this->inflight) {
+      if (!tuple.second.sacked && !tuple.second.lost) {
+        count++;
+      }
+    }
+
+    return count;
+  }
+
+  void Core::P2P::Channel::flush () {
+    auto now = (double) uv_now(this->core->getEventLoop());
+    // pacing spreads a congestion window of packets over one round trip
+    auto interval = this->srtt > 0 ? this->srtt / this->cwnd : 0;
+    auto outstanding = this->outstanding();
+
+    if (this->nextSendTime < now) {
+      this->nextSendTime = now;
+    }
+
+    // retransmissions go first and take the same window and pacing as
+    // new data, so a loss never turns into a burst
+    for (auto& tuple : this->inflight) {
+      if (outstanding >= (size_t) this->cwnd || this->nextSendTime >= now + 1) {
+        break;
+      }
+
+      if (tuple.second.lost) {
+        this->transmit(tuple.first, tuple.second);
+        this->nextSendTime += interval;
+        outstanding++;
+      }
+    }
+
+    while (
+      !this->pending.empty() &&
+      outstanding < (size_t) this->cwnd &&
+      this->nextSendTime < now + 1
+    ) {
+      auto packet = this->pending.front();
+      auto seq = readUInt64BE(packet->data() + 4);
+      auto& segment = this->inflight[seq];
+
+      this->pending.pop();
+      segment.packet = packet;
+      this->transmit(seq, segment);
+      this->nextSendTime += interval;
+      outstanding++;
+    }
+
+    this->schedule();
+  }
+
+  void Core::P2P::Channel::schedule () {
+    auto now = uv_now(this->core->getEventLoop());
+    auto armed = false;
+    auto waiting = !this->pending.empty();
+    uint64_t timeout = MAX_RTO;
+
+    for (const auto& tuple : this->inflight) {
+      const auto& segment = tuple.second;
+
+      if (segment.lost) {
+        waiting = true;
+      } else if (!segment.sacked) {
+        auto deadline = segment.sentAt + this->rto;
+        timeout = std::min(timeout, deadline > now ? deadline - now : 0);
+        armed = true;
+      }
+    }
+
+    if (waiting && this->outstanding() < (size_t) this->cwnd) {
+      auto delay = this->nextSendTime > now ? this->nextSendTime - now : 0;
+      timeout = std::min(timeout, (uint64_t) std::ceil(delay));
+      armed = true;
+    }
+
+    if (!armed) {
+      uv_timer_stop(&this->timer);
+      return;
+    }
+
+    uv_timer_start(&this->timer, [](uv_timer_t *handle) {
+      auto channel = reinterpret_cast<Channel *>(handle->data);
+      channel->ontimeout();
+    }, timeout, 0);
+  }
+
+  void Core::P2P::Channel::close (std::function<void()> onclose) {
+    auto peer = this->peer;
+    this->destroy();
+
+    peer->close([onclose]() {
+      if (onclose != nullptr) {
+        onclose();
+      }
+    });
+  }
+
+  // stops the channel without closing its peer, which may already be gone
+  void Core::P2P::Channel::destroy () {
+    this->onmessage = nullptr;
+    this->peer = nullptr;
+    uv_timer_stop(&this->timer);
+
+    uv_close((uv_handle_t *) &this->timer, [](uv_handle_t *handle) {
+      auto channel = reinterpret_cast<Channel *>(handle->data);
+      delete channel;
+    });
+  }
+
+  Core::P2P::Channel* Core::P2P::getChannel (uint64_t id) {
+    Lock lock(this->mutex);
+    if (this->channels.find(id) != this->channels.end()) {
+      return this->channels.at(id);
+    }
+    return nullptr;
+  }
+
+  bool Core::P2P::hasChannel (uint64_t id) {
+    Lock lock(this->mutex);
+    return this->channels.find(id) != this->channels.end();
+  }
+
+  void Core::P2P::removeChannel (uint64_t id) {
+    Lock lock(this->mutex);
+    if (this->channels.find(id) != this->channels.end()) {
+      this->channels.erase(id);
+    }
+  }
+
+  // a channel goes away with its peer, however the peer was closed
+  void Core::P2P::destroyChannel (uint64_t id) {
+    Channel *channel = nullptr;
+
+    {
+      Lock lock(this->mutex);
+      auto entry = this->channels.find(id);
+
+      if (entry == this->channels.end()) {
+        return;
+      }
+
+      channel = entry->second;
+      this->channels.erase(entry);
+    }
+
+    channel->destroy();
+  }
+
+  void Core::P2P::open (
+    const String seq,
+    uint64_t id,
+    P2P::OpenOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      if (this->hasChannel(id) || this->core->hasPeer(id)) {
+        auto json = JSON::Object::Entries {
+          {"source", "p2p.open"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ERR_SOCKET_ALREADY_BOUND"},
+            {"type", "InternalError"},
+            {"message", "Channel is already open"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto peer = this->core->createPeer(PEER_TYPE_UDP, id);
+      auto err = peer->bind(options.address, options.port, false);
+
+      if (err >= 0) {
+        err = peer->connect(options.remoteAddress, options.remotePort);
+      }
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "p2p.open"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        peer->close();
+        return cb(seq, json, Post{});
+      }
+
+      auto channel = new Channel(this->core, id, peer);
+
+      channel->onmessage = [=](char *bytes, size_t size) {
+        Post post;
+
+        auto headers = Headers {{
+          {"content-type" ,"application/octet-stream"},
+          {"content-length", (int) size}
+        }};
+
+        post.id = rand64();
+        post.body = bytes;
+        post.length = size;
+        post.headers = headers.str();
+
+        auto json = JSON::Object::Entries {
+          {"source", "p2p.message"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"bytes", std::to_string(size)}
+          }}
+        };
+
+        cb("-1", json, post);
+      };
+
+      err = peer->recvstart([channel](auto nread, auto buf, auto addr) {
+        if (nread > 0) {
+          channel->receive(buf->base, (size_t) nread);
+        }
+
+        if (buf != nullptr && buf->base != nullptr) {
+          delete [] buf->base;
+        }
+      });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "p2p.open"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"message", String(uv_strerror(err))}
+          }}
+        };
+
+        channel->close(nullptr);
+        return cb(seq, json, Post{});
+      }
+
+      {
+        Lock lock(this->mutex);
+        this->channels[id] = channel;
+      }
+
+      auto local = peer->getLocalPeerInfo();
+      auto remote = peer->getRemotePeerInfo();
+      auto json = JSON::Object::Entries {
+        {"source", "p2p.open"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"address", local->address},
+          {"port", local->port},
+          {"remoteAddress", remote->address},
+          {"remotePort", remote->port}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::P2P::send (
+    const String seq,
+    uint64_t id,
+    char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto channel = this->getChannel(id);
+
+      if (channel == nullptr) {
+        auto json = ERR_P2P_CHANNEL_NOT_FOUND("p2p.send", id);
+        return cb(seq, json, Post{});
+      }
+
+      // `bytes` are owned by the caller and are copied into the send queue
+      auto err = channel->enqueue(bytes, size);
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "p2p.send"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"code", "ENOBUFS"},
+            {"type", "InternalError"},
+            {"queued", (uint64_t) channel->pending.size()},
+            {"message", "Channel send queue is full"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "p2p.send"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"queued", (uint64_t) channel->pending.size()},
+          {"inflight", (uint64_t) channel->inflight.size()}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::P2P::getState (
+    const String seq,
+    uint64_t id,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto channel = this->getChannel(id);
+
+      if (channel == nullptr) {
+        auto json = ERR_P2P_CHANNEL_NOT_FOUND("p2p.getState", id);
+        return cb(seq, json, Post{});
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "p2p.getState"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"cwnd", channel->cwnd},
+          {"ssthresh", channel->ssthresh},
+          {"srtt", channel->srtt},
+          {"rto", channel->rto},
+          {"queued", (uint64_t) channel->pending.size()},
+          {"inflight", (uint64_t) channel->inflight.size()},
+          {"packetsSent", channel->packetsSent},
+          {"packetsReceived", channel->packetsReceived},
+          {"retransmits", channel->retransmits},
+          {"delivered", channel->delivered},
+          {"dropped", channel->dropped}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::P2P::close (
+    const String seq,
+    uint64_t id,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto channel = this->getChannel(id);
+
+      if (channel == nullptr) {
+        auto json = ERR_P2P_CHANNEL_NOT_FOUND("p2p.close", id);
+        return cb(seq, json, Post{});
+      }
+
+      this->removeChannel(id);
+      channel->close([=]() {
+        auto json = JSON::Object::Entries {
+          {"source", "p2p.close"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(id)}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      });
+    });
+  }
+}
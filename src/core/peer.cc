@@ -311,6 +311,323 @@ namespace SSC {
     );
   }
 
+  // datagrams are compressed one at a time as raw deflate, which has no
+  // header or checksum overhead and relies on the UDP checksum instead
+  static const Core::Compression::Options COMPRESSION_OPTIONS = { "raw", 6 };
+  static constexpr size_t MAX_INFLATED_DATAGRAM_SIZE = 1024 * 1024;
+  static constexpr size_t SEALED_DATAGRAM_OVERHEAD = Secretbox::NONCE_SIZE + Secretbox::MAC_SIZE;
+
+  static bool shouldEncodeDatagrams (Peer *peer) {
+    return peer->options.udp.compress || peer->encryption.enabled;
+  }
+
+  /**
+   * Appends `size` bytes of `bytes` to `output` compressed, then sealed
+   * with `nonce` when the peer has a key.
+   */
+  static int encodeDatagram (
+    Peer *peer,
+    const char *bytes,
+    size_t size,
+    const unsigned char *nonce,
+    Vector<char>& output
+  ) {
+    Vector<char> compressed;
+
+    if (peer->options.udp.compress) {
+      Lock lock(peer->mutex);
+      auto err = Core::Compression::deflate(
+        peer->compression.deflate,
+        bytes,
+        size,
+        COMPRESSION_OPTIONS,
+        compressed
+      );
+
+      if (err < 0) {
+        return err;
+      }
+
+      bytes = compressed.data();
+      size = compressed.size();
+    }
+
+    if (!peer->encryption.enabled) {
+      output.insert(output.end(), bytes, bytes + size);
+      return 0;
+    }
+
+    auto offset = output.size();
+    output.resize(offset + SEALED_DATAGRAM_OVERHEAD + size);
+
+    auto box = (unsigned char *) output.data() + offset;
+    memcpy(box, nonce, Secretbox::NONCE_SIZE);
+    Secretbox::seal(
+      box + Secretbox::NONCE_SIZE,
+      (const unsigned char *) bytes,
+      size,
+      nonce,
+      peer->encryption.key
+    );
+
+    return 0;
+  }
+
+  // opens, then inflates a received datagram, counting what is dropped
+  static int decodeDatagram (
+    Peer *peer,
+    const char *bytes,
+    size_t size,
+    Vector<char>& output
+  ) {
+    Vector<char> opened;
+
+    if (peer->encryption.enabled) {
+      if (size < SEALED_DATAGRAM_OVERHEAD) {
+        peer->stats.decryptErrors++;
+        return UV_EILSEQ;
+      }
+
+      auto nonce = (const unsigned char *) bytes;
+      auto box = nonce + Secretbox::NONCE_SIZE;
+      auto boxSize = size - Secretbox::NONCE_SIZE;
+      opened.resize(boxSize - Secretbox::MAC_SIZE);
+
+      if (!Secretbox::open((unsigned char *) opened.data(), box, boxSize, nonce, peer->encryption.key)) {
+        peer->stats.decryptErrors++;
+        return UV_EILSEQ;
+      }
+
+      bytes = opened.data();
+      size = opened.size();
+    }
+
+    if (peer->options.udp.compress) {
+      Lock lock(peer->mutex);
+      auto err = Core::Compression::inflate(
+        peer->compression.inflate,
+        bytes,
+        size,
+        COMPRESSION_OPTIONS,
+        output,
+        MAX_INFLATED_DATAGRAM_SIZE
+      );
+
+      if (err < 0) {
+        peer->stats.inflateErrors++;
+      }
+
+      return err;
+    }
+
+    output.assign(bytes, bytes + size);
+    return 0;
+  }
+
+  static void sendDatagram (
+    Peer *peer,
+    char *buf,
+    size_t size,
+    int port,
+    const String address,
+    Peer::RequestContext::Callback cb
+  ) {
+    Lock lock(peer->mutex);
+    int err = 0;
+
+    struct sockaddr *sockaddr = nullptr;
+
+    if (!peer->isConnected()) {
+      sockaddr = (struct sockaddr *) &peer->addr;
+      err = uv_ip4_addr((char *) address.c_str(), port, &peer->addr);
+
+      if (err) {
+        return cb(err, Post{});
+      }
+    }
+
+    auto buffer = uv_buf_init(buf, (int) size);
+    auto ctx = new Peer::RequestContext(cb);
+    auto req = new uv_udp_send_t;
+
+    req->data = (void *) ctx;
+    ctx->peer = peer;
+    ctx->size = size;
+
+    err = uv_udp_send(req, (uv_udp_t *) &peer->handle, &buffer, 1, sockaddr, [](uv_udp_send_t *req, int status) {
+      auto ctx = reinterpret_cast<Peer::RequestContext*>(req->data);
+      auto peer = ctx->peer;
+
+      if (status < 0) {
+        peer->stats.sendErrors++;
+        if (status == UV_EAGAIN) peer->stats.eagain++;
+      } else {
+        peer->stats.packetsOut++;
+        peer->stats.bytesOut += ctx->size;
+      }
+
+      ctx->cb(status, Post{});
+
+      if (peer->isEphemeral()) {
+        peer->close();
+      }
+
+      delete ctx;
+      delete req;
+    });
+
+    if (err < 0) {
+      peer->stats.sendErrors++;
+      if (err == UV_EAGAIN) peer->stats.eagain++;
+
+      ctx->cb(err, Post{});
+
+      if (peer->isEphemeral()) {
+        peer->close();
+      }
+
+      delete ctx;
+      delete req;
+    }
+  }
+
+  bool Peer::isPaced () {
+    Lock lock(this->mutex);
+    return this->pacing.rate > 0;
+  }
+
+  bool Peer::isWritable () {
+    Lock lock(this->mutex);
+    return this->pacing.queuedBytes < this->pacing.highWaterMark;
+  }
+
+  void Peer::setPacing (uint64_t rate, uint64_t burst, size_t highWaterMark) {
+    Lock lock(this->mutex);
+
+    // callers reject bursts below `MIN_PACING_BURST`, zero selects it
+    this->pacing.rate = rate;
+    this->pacing.burst = burst > 0 ? burst : MIN_PACING_BURST;
+    this->pacing.tokens = (double) this->pacing.burst;
+    this->pacing.refilledAt = uv_now(this->core->getEventLoop());
+    this->pacing.highWaterMark = highWaterMark > 0
+      ? highWaterMark
+      : DEFAULT_HIGH_WATER_MARK;
+
+    if (rate > 0 && this->pacing.timer == nullptr) {
+      this->pacing.timer = new uv_timer_t;
+      uv_timer_init(this->core->getEventLoop(), this->pacing.timer);
+      this->pacing.timer->data = (void *) this;
+    }
+
+    this->flush();
+  }
+
+  void Peer::flush () {
+    Lock lock(this->mutex);
+    auto now = uv_now(this->core->getEventLoop());
+    auto elapsed = (double) (now - this->pacing.refilledAt);
+
+    this->pacing.refilledAt = now;
+    this->pacing.tokens = std::min(
+      (double) this->pacing.burst,
+      this->pacing.tokens + elapsed * this->pacing.rate / 1000
+    );
+
+    while (!this->pacing.queue.empty()) {
+      auto entry = this->pacing.queue.front();
+      auto size = entry.bytes->size();
+
+      if (this->pacing.rate > 0 && this->pacing.tokens < (double) size) {
+        auto deficit = (double) size - this->pacing.tokens;
+        auto timeout = (uint64_t) std::ceil(deficit * 1000 / this->pacing.rate);
+
+        uv_timer_start(this->pacing.timer, [](uv_timer_t *handle) {
+          auto peer = reinterpret_cast<Peer *>(handle->data);
+          if (peer != nullptr) {
+            peer->flush();
+          }
+        }, std::max(timeout, (uint64_t) 1), 0);
+        break;
+      }
+
+      this->pacing.queue.pop();
+      this->pacing.queuedBytes -= size;
+      this->pacing.tokens -= (double) size;
+
+      sendDatagram(this, entry.bytes->data(), size, entry.port, entry.address, [entry](auto status, auto post) {
+        if (entry.cb != nullptr) {
+          entry.cb(status, post);
+        }
+      });
+    }
+
+    if (this->pacing.ondrain != nullptr && this->isWritable()) {
+      auto ondrain = this->pacing.ondrain;
+      this->pacing.ondrain = nullptr;
+      ondrain();
+    }
+  }
+
+  Peer::ReceiveQueueDrops Peer::readReceiveQueueDrops () {
+    ReceiveQueueDrops drops;
+  #if defined(__linux__)
+    // libuv does not surface `SO_RXQ_OVFL` ancillary data from `recvmsg()`
+    // so read the kernel's per socket drop counters from procfs instead
+    for (const auto path : { "/proc/net/udp", "/proc/net/udp6" }) {
+      std::ifstream stream(path);
+      String line;
+
+      // skip header
+      std::getline(stream, line);
+
+      while (std::getline(stream, line)) {
+        std::istringstream fields(line);
+        Vector<String> columns;
+        String column;
+
+        while (fields >> column) {
+          columns.push_back(column);
+        }
+
+        // sl local rem st tx:rx tr:when retrnsmt uid timeout inode ref pointer drops
+        if (columns.size() >= 13) {
+          try {
+            drops[std::stoull(columns[9])] = std::stoull(columns[12]);
+          } catch (...) {}
+        }
+      }
+    }
+  #endif
+
+    return drops;
+  }
+
+  uint64_t Peer::getReceiveQueueDrops (const ReceiveQueueDrops& drops) {
+  #if defined(__linux__)
+    uv_os_fd_t fd;
+    struct stat st;
+
+    {
+      Lock lock(this->mutex);
+      if (uv_fileno((uv_handle_t *) &this->handle, &fd) != 0) {
+        return 0;
+      }
+    }
+
+    if (fstat(fd, &st) != 0) {
+      return 0;
+    }
+
+    auto entry = drops.find((uint64_t) st.st_ino);
+
+    if (entry != drops.end()) {
+      return entry->second;
+    }
+  #endif
+
+    return 0;
+  }
+
   int Peer::bind () {
     auto info = this->getLocalPeerInfo();
 
@@ -428,50 +745,164 @@ namespace SSC {
     const String address,
     Peer::RequestContext::Callback cb
   ) {
-    Lock lock(this->mutex);
-    int err = 0;
+    if (shouldEncodeDatagrams(this)) {
+      auto bytes = std::make_shared<Vector<char>>();
+      unsigned char nonce[Secretbox::NONCE_SIZE];
+      int err = 0;
 
-    struct sockaddr *sockaddr = nullptr;
+      if (this->encryption.enabled) {
+        err = uv_random(nullptr, nullptr, nonce, sizeof(nonce), 0, nullptr);
+      }
 
-    if (!this->isConnected()) {
-      sockaddr = (struct sockaddr *) &this->addr;
-      err = uv_ip4_addr((char *) address.c_str(), port, &this->addr);
+      if (err == 0) {
+        err = encodeDatagram(this, buf, size, nonce, *bytes);
+      }
 
-      if (err) {
-        return cb(err, Post{});
+      if (err < 0) {
+        if (cb != nullptr) cb(err, Post{});
+        return;
       }
+
+      if (this->isPaced()) {
+        Lock lock(this->mutex);
+        this->pacing.queue.push(QueuedSend { bytes, port, address, cb });
+        this->pacing.queuedBytes += bytes->size();
+        return this->flush();
+      }
+
+      // the encoded bytes must outlive the send request
+      return sendDatagram(this, bytes->data(), bytes->size(), port, address, [bytes, cb](auto status, auto post) {
+        if (cb != nullptr) cb(status, post);
+      });
     }
 
-    auto buffer = uv_buf_init(buf, (int) size);
-    auto ctx = new Peer::RequestContext(cb);
-    auto req = new uv_udp_send_t;
+    if (this->isPaced()) {
+      Lock lock(this->mutex);
+      // `buf` is owned by the caller so it is copied into the queue
+      auto bytes = std::make_shared<Vector<char>>(buf, buf + size);
+      this->pacing.queue.push(QueuedSend { bytes, port, address, cb });
+      this->pacing.queuedBytes += size;
+      return this->flush();
+    }
 
-    req->data = (void *) ctx;
-    ctx->peer = this;
+    return sendDatagram(this, buf, size, port, address, cb);
+  }
 
-    err = uv_udp_send(req, (uv_udp_t *) &this->handle, &buffer, 1, sockaddr, [](uv_udp_send_t *req, int status) {
-      auto ctx = reinterpret_cast<Peer::RequestContext*>(req->data);
-      auto peer = ctx->peer;
+  /**
+   * Sends `buf` split into datagrams of `sizes` bytes. Every datagram is
+   * encoded into one buffer in a single pass, with one call for all of the
+   * nonces, and `cb` is called once with the first error, if any.
+   */
+  void Peer::sendBatch (
+    const char *buf,
+    const Vector<size_t>& sizes,
+    int port,
+    const String address,
+    Peer::RequestContext::Callback cb
+  ) {
+    struct Batch {
+      std::shared_ptr<Vector<char>> bytes;
+      Vector<size_t> sizes;
+      size_t pending = 0;
+      int status = 0;
+    };
 
-      ctx->cb(status, Post{});
+    auto batch = std::make_shared<Batch>();
+    batch->bytes = std::make_shared<Vector<char>>();
 
-      if (peer->isEphemeral()) {
-        peer->close();
+    if (shouldEncodeDatagrams(this)) {
+      Vector<unsigned char> nonces;
+      size_t total = 0;
+      int err = 0;
+
+      for (auto size : sizes) {
+        total += size;
       }
 
-      delete ctx;
-      delete req;
-    });
+      if (this->encryption.enabled) {
+        nonces.resize(sizes.size() * Secretbox::NONCE_SIZE);
+        err = uv_random(nullptr, nullptr, nonces.data(), nonces.size(), 0, nullptr);
+      }
 
-    if (err < 0) {
-      ctx->cb(err, Post{});
+      batch->bytes->reserve(total + sizes.size() * SEALED_DATAGRAM_OVERHEAD);
 
-      if (this->isEphemeral()) {
-        this->close();
+      for (size_t i = 0, offset = 0; err == 0 && i < sizes.size(); offset += sizes[i++]) {
+        auto before = batch->bytes->size();
+        auto nonce = nonces.size() > 0 ? nonces.data() + i * Secretbox::NONCE_SIZE : nullptr;
+        err = encodeDatagram(this, buf + offset, sizes[i], nonce, *batch->bytes);
+        batch->sizes.push_back(batch->bytes->size() - before);
       }
 
-      delete ctx;
-      delete req;
+      if (err < 0) {
+        if (cb != nullptr) cb(err, Post{});
+        return;
+      }
+    } else {
+      size_t total = 0;
+
+      for (auto size : sizes) {
+        total += size;
+      }
+
+      // `buf` is owned by the caller and may be gone before the sends complete
+      batch->bytes->assign(buf, buf + total);
+      batch->sizes = sizes;
+    }
+
+    if (batch->sizes.size() == 0) {
+      if (cb != nullptr) cb(0, Post{});
+      return;
+    }
+
+    // the callback sees the first failed datagram, paced or not
+    auto onsend = [batch, cb](auto status, auto post) {
+      if (status < 0 && batch->status == 0) {
+        batch->status = status;
+      }
+
+      if (--batch->pending == 0 && cb != nullptr) {
+        cb(batch->status, Post{});
+      }
+    };
+
+    batch->pending = batch->sizes.size();
+
+    if (this->isPaced()) {
+      Lock lock(this->mutex);
+      size_t offset = 0;
+
+      for (auto size : batch->sizes) {
+        auto bytes = batch->bytes->data() + offset;
+        this->pacing.queue.push(QueuedSend {
+          std::make_shared<Vector<char>>(bytes, bytes + size),
+          port,
+          address,
+          onsend
+        });
+        this->pacing.queuedBytes += size;
+        offset += size;
+      }
+
+      return this->flush();
+    }
+
+    size_t offset = 0;
+    for (auto size : batch->sizes) {
+      auto bytes = batch->bytes->data() + offset;
+      offset += size;
+      sendDatagram(this, bytes, size, port, address, onsend);
+    }
+  }
+
+  void Peer::setKey (const unsigned char *key) {
+    Lock lock(this->mutex);
+
+    if (key == nullptr) {
+      memset(this->encryption.key, 0, sizeof(this->encryption.key));
+      this->encryption.enabled = false;
+    } else {
+      memcpy(this->encryption.key, key, sizeof(this->encryption.key));
+      this->encryption.enabled = true;
     }
   }
 
@@ -514,6 +945,27 @@ namespace SSC {
         return;
       }
 
+      if (nread > 0) {
+        peer->stats.packetsIn++;
+        peer->stats.bytesIn += nread;
+      }
+
+      if (nread > 0 && shouldEncodeDatagrams(peer)) {
+        Vector<char> output;
+        auto err = decodeDatagram(peer, buf->base, nread, output);
+
+        delete [] buf->base;
+
+        // a datagram that is not ours, was modified or was truncated is dropped
+        if (err < 0 || output.size() == 0) {
+          return;
+        }
+
+        auto decoded = uv_buf_init(new char[output.size()], (unsigned int) output.size());
+        memcpy(decoded.base, output.data(), output.size());
+        return peer->receiveCallback((ssize_t) output.size(), &decoded, addr);
+      }
+
       peer->receiveCallback(nread, buf, addr);
     };
 
@@ -579,6 +1031,9 @@ namespace SSC {
   }
 
   void Peer::close (std::function<void()> onclose) {
+    // a reliable channel over this peer cannot outlive it
+    this->core->p2p.destroyChannel(this->id);
+
     if (this->isClosed()) {
       this->core->removePeer(this->id);
       onclose();
@@ -596,6 +1051,28 @@ namespace SSC {
 
     if (this->type == PEER_TYPE_UDP) {
       Lock lock(this->mutex);
+
+      // queued datagrams are never sent once the socket closes
+      while (!this->pacing.queue.empty()) {
+        auto entry = this->pacing.queue.front();
+        this->pacing.queue.pop();
+        if (entry.cb != nullptr) {
+          entry.cb(UV_ECANCELED, Post{});
+        }
+      }
+
+      this->pacing.queuedBytes = 0;
+      this->pacing.ondrain = nullptr;
+
+      if (this->pacing.timer != nullptr) {
+        this->pacing.timer->data = nullptr;
+        uv_timer_stop(this->pacing.timer);
+        uv_close((uv_handle_t *) this->pacing.timer, [](uv_handle_t *handle) {
+          delete reinterpret_cast<uv_timer_t *>(handle);
+        });
+        this->pacing.timer = nullptr;
+      }
+
       // reset state and set to CLOSED
       uv_close((uv_handle_t*) &this->handle, [](uv_handle_t *handle) {
         auto peer = (Peer *) handle->data;
@@ -0,0 +1,288 @@
+#include "secretbox.hh"
+#include <cstring>
+
+namespace SSC::Secretbox {
+  static inline uint32_t rotl32 (uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+  }
+
+  static inline uint32_t load32le (const unsigned char *p) {
+    return
+      ((uint32_t) p[0]) |
+      ((uint32_t) p[1] << 8) |
+      ((uint32_t) p[2] << 16) |
+      ((uint32_t) p[3] << 24);
+  }
+
+  static inline void store32le (unsigned char *p, uint32_t x) {
+    p[0] = (unsigned char) x;
+    p[1] = (unsigned char) (x >> 8);
+    p[2] = (unsigned char) (x >> 16);
+    p[3] = (unsigned char) (x >> 24);
+  }
+
+  // "expand 32-byte k"
+  static constexpr uint32_t SIGMA[4] = {
+    0x61707865, 0x3320646e, 0x79622d32, 0x6b206574
+  };
+
+  static void salsa20Rounds (uint32_t x[16]) {
+    for (int i = 0; i < 20; i += 2) {
+      x[4] ^= rotl32(x[0] + x[12], 7);
+      x[8] ^= rotl32(x[4] + x[0], 9);
+      x[12] ^= rotl32(x[8] + x[4], 13);
+      x[0] ^= rotl32(x[12] + x[8], 18);
+      x[9] ^= rotl32(x[5] + x[1], 7);
+      x[13] ^= rotl32(x[9] + x[5], 9);
+      x[1] ^= rotl32(x[13] + x[9], 13);
+      x[5] ^= rotl32(x[1] + x[13], 18);
+      x[14] ^= rotl32(x[10] + x[6], 7);
+      x[2] ^= rotl32(x[14] + x[10], 9);
+      x[6] ^= rotl32(x[2] + x[14], 13);
+      x[10] ^= rotl32(x[6] + x[2], 18);
+      x[3] ^= rotl32(x[15] + x[11], 7);
+      x[7] ^= rotl32(x[3] + x[15], 9);
+      x[11] ^= rotl32(x[7] + x[3], 13);
+      x[15] ^= rotl32(x[11] + x[7], 18);
+
+      x[1] ^= rotl32(x[0] + x[3], 7);
+      x[2] ^= rotl32(x[1] + x[0], 9);
+      x[3] ^= rotl32(x[2] + x[1], 13);
+      x[0] ^= rotl32(x[3] + x[2], 18);
+      x[6] ^= rotl32(x[5] + x[4], 7);
+      x[7] ^= rotl32(x[6] + x[5], 9);
+      x[4] ^= rotl32(x[7] + x[6], 13);
+      x[5] ^= rotl32(x[4] + x[7], 18);
+      x[11] ^= rotl32(x[10] + x[9], 7);
+      x[8] ^= rotl32(x[11] + x[10], 9);
+      x[9] ^= rotl32(x[8] + x[11], 13);
+      x[10] ^= rotl32(x[9] + x[8], 18);
+      x[12] ^= rotl32(x[15] + x[14], 7);
+      x[13] ^= rotl32(x[12] + x[15], 9);
+      x[14] ^= rotl32(x[13] + x[12], 13);
+      x[15] ^= rotl32(x[14] + x[13], 18);
+    }
+  }
+
+  static void salsa20Setup (uint32_t x[16], const unsigned char *key, const unsigned char *input) {
+    x[0] = SIGMA[0];
+    x[5] = SIGMA[1];
+    x[10] = SIGMA[2];
+    x[15] = SIGMA[3];
+
+    for (int i = 0; i < 4; ++i) {
+      x[1 + i] = load32le(key + i * 4);
+      x[11 + i] = load32le(key + 16 + i * 4);
+      x[6 + i] = load32le(input + i * 4);
+    }
+  }
+
+  // derives the XSalsa20 subkey from the first 16 bytes of the nonce
+  static void hsalsa20 (unsigned char *output, const unsigned char *key, const unsigned char *nonce) {
+    uint32_t x[16];
+    salsa20Setup(x, key, nonce);
+    salsa20Rounds(x);
+
+    static constexpr int words[8] = { 0, 5, 10, 15, 6, 7, 8, 9 };
+    for (int i = 0; i < 8; ++i) {
+      store32le(output + i * 4, x[words[i]]);
+    }
+  }
+
+  /**
+   * XORs `size` bytes of `input` with the XSalsa20 stream starting at byte
+   * 32 of the first block, the first 32 bytes being the Poly1305 key
+   * written to `polyKey`.
+   */
+  static void xsalsa20 (
+    unsigned char *output,
+    const unsigned char *input,
+    size_t size,
+    const unsigned char *nonce,
+    const unsigned char *key,
+    unsigned char *polyKey
+  ) {
+    unsigned char subkey[32];
+    unsigned char counter[16] = {0};
+    unsigned char block[64];
+    uint32_t state[16];
+    uint32_t x[16];
+    uint64_t blocks = 0;
+    size_t offset = 32;
+
+    hsalsa20(subkey, key, nonce);
+    memcpy(counter, nonce + 16, 8);
+    salsa20Setup(state, subkey, counter);
+
+    while (true) {
+      state[8] = (uint32_t) blocks;
+      state[9] = (uint32_t) (blocks >> 32);
+      memcpy(x, state, sizeof(x));
+      salsa20Rounds(x);
+
+      for (int i = 0; i < 16; ++i) {
+        store32le(block + i * 4, x[i] + state[i]);
+      }
+
+      if (blocks++ == 0) {
+        memcpy(polyKey, block, 32);
+      }
+
+      for (; offset < 64 && size > 0; ++offset, --size) {
+        *output++ = *input++ ^ block[offset];
+      }
+
+      if (size == 0) {
+        break;
+      }
+
+      offset = 0;
+    }
+
+    memset(subkey, 0, sizeof(subkey));
+    memset(block, 0, sizeof(block));
+  }
+
+  // RFC 8439 Poly1305 with 26 bit limbs
+  static void poly1305 (
+    unsigned char *mac,
+    const unsigned char *input,
+    size_t size,
+    const unsigned char *key
+  ) {
+    const uint32_t r0 = (load32le(key + 0)) & 0x3ffffff;
+    const uint32_t r1 = (load32le(key + 3) >> 2) & 0x3ffff03;
+    const uint32_t r2 = (load32le(key + 6) >> 4) & 0x3ffc0ff;
+    const uint32_t r3 = (load32le(key + 9) >> 6) & 0x3f03fff;
+    const uint32_t r4 = (load32le(key + 12) >> 8) & 0x00fffff;
+    const uint32_t s1 = r1 * 5;
+    const uint32_t s2 = r2 * 5;
+    const uint32_t s3 = r3 * 5;
+    const uint32_t s4 = r4 * 5;
+
+    uint32_t h0 = 0, h1 = 0, h2 = 0, h3 = 0, h4 = 0;
+    unsigned char last[16];
+
+    while (size > 0) {
+      const unsigned char *block = input;
+      uint32_t hibit = 1 << 24;
+
+      if (size < 16) {
+        memset(last, 0, sizeof(last));
+        memcpy(last, input, size);
+        last[size] = 1;
+        block = last;
+        hibit = 0;
+      }
+
+      h0 += (load32le(block + 0)) & 0x3ffffff;
+      h1 += (load32le(block + 3) >> 2) & 0x3ffffff;
+      h2 += (load32le(block + 6) >> 4) & 0x3ffffff;
+      h3 += (load32le(block + 9) >> 6) & 0x3ffffff;
+      h4 += (load32le(block + 12) >> 8) | hibit;
+
+      uint64_t d0 = (uint64_t) h0 * r0 + (uint64_t) h1 * s4 + (uint64_t) h2 * s3 + (uint64_t) h3 * s2 + (uint64_t) h4 * s1;
+      uint64_t d1 = (uint64_t) h0 * r1 + (uint64_t) h1 * r0 + (uint64_t) h2 * s4 + (uint64_t) h3 * s3 + (uint64_t) h4 * s2;
+      uint64_t d2 = (uint64_t) h0 * r2 + (uint64_t) h1 * r1 + (uint64_t) h2 * r0 + (uint64_t) h3 * s4 + (uint64_t) h4 * s3;
+      uint64_t d3 = (uint64_t) h0 * r3 + (uint64_t) h1 * r2 + (uint64_t) h2 * r1 + (uint64_t) h3 * r0 + (uint64_t) h4 * s4;
+      uint64_t d4 = (uint64_t) h0 * r4 + (uint64_t) h1 * r3 + (uint64_t) h2 * r2 + (uint64_t) h3 * r1 + (uint64_t) h4 * r0;
+
+      uint32_t c = (uint32_t) (d0 >> 26); h0 = (uint32_t) d0 & 0x3ffffff;
+      d1 += c; c = (uint32_t) (d1 >> 26); h1 = (uint32_t) d1 & 0x3ffffff;
+      d2 += c; c = (uint32_t) (d2 >> 26); h2 = (uint32_t) d2 & 0x3ffffff;
+      d3 += c; c = (uint32_t) (d3 >> 26); h3 = (uint32_t) d3 & 0x3ffffff;
+      d4 += c; c = (uint32_t) (d4 >> 26); h4 = (uint32_t) d4 & 0x3ffffff;
+      h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+      h1 += c;
+
+      if (size < 16) {
+        break;
+      }
+
+      input += 16;
+      size -= 16;
+    }
+
+    // fully carry h and compute h - p, keeping it when h >= p
+    uint32_t c = h1 >> 26; h1 &= 0x3ffffff;
+    h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+    h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+    h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+    h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+    h1 += c;
+
+    uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+    uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+    uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+    uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+    uint32_t g4 = h4 + c - (1 << 26);
+
+    uint32_t mask = (g4 >> 31) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+
+    // h = (h + s) % 2^128
+    h0 = h0 | (h1 << 26);
+    h1 = (h1 >> 6) | (h2 << 20);
+    h2 = (h2 >> 12) | (h3 << 14);
+    h3 = (h3 >> 18) | (h4 << 8);
+
+    uint64_t f = (uint64_t) h0 + load32le(key + 16);
+    store32le(mac + 0, (uint32_t) f);
+    f = (uint64_t) h1 + load32le(key + 20) + (f >> 32);
+    store32le(mac + 4, (uint32_t) f);
+    f = (uint64_t) h2 + load32le(key + 24) + (f >> 32);
+    store32le(mac + 8, (uint32_t) f);
+    f = (uint64_t) h3 + load32le(key + 28) + (f >> 32);
+    store32le(mac + 12, (uint32_t) f);
+  }
+
+  void seal (
+    unsigned char *output,
+    const unsigned char *input,
+    size_t size,
+    const unsigned char *nonce,
+    const unsigned char *key
+  ) {
+    unsigned char polyKey[32];
+    xsalsa20(output + MAC_SIZE, input, size, nonce, key, polyKey);
+    poly1305(output, output + MAC_SIZE, size, polyKey);
+    memset(polyKey, 0, sizeof(polyKey));
+  }
+
+  bool open (
+    unsigned char *output,
+    const unsigned char *input,
+    size_t size,
+    const unsigned char *nonce,
+    const unsigned char *key
+  ) {
+    unsigned char polyKey[32];
+    unsigned char mac[MAC_SIZE];
+    unsigned char difference = 0;
+
+    if (size < MAC_SIZE) {
+      return false;
+    }
+
+    // only the Poly1305 key is needed before the MAC is verified
+    xsalsa20(nullptr, nullptr, 0, nonce, key, polyKey);
+    poly1305(mac, input + MAC_SIZE, size - MAC_SIZE, polyKey);
+    memset(polyKey, 0, sizeof(polyKey));
+
+    for (size_t i = 0; i < MAC_SIZE; ++i) {
+      difference |= mac[i] ^ input[i];
+    }
+
+    if (difference != 0) {
+      return false;
+    }
+
+    xsalsa20(output, input + MAC_SIZE, size - MAC_SIZE, nonce, key, polyKey);
+    memset(polyKey, 0, sizeof(polyKey));
+    return true;
+  }
+}
@@ -0,0 +1,41 @@
+#ifndef SSC_SOCKET_SECRETBOX_HH
+#define SSC_SOCKET_SECRETBOX_HH
+
+#include "../common.hh"
+
+// XSalsa20-Poly1305, byte compatible with libsodium's `crypto_secretbox_easy()`
+// and `crypto_secretbox_open_easy()` so either end of a socket may use
+// `sodium` in JavaScript instead
+namespace SSC::Secretbox {
+  constexpr size_t KEY_SIZE = 32;
+  constexpr size_t NONCE_SIZE = 24;
+  constexpr size_t MAC_SIZE = 16;
+
+  /**
+   * Encrypts and authenticates `size` bytes of `input` into `output` as
+   * the MAC followed by the ciphertext. `output` must hold `size + MAC_SIZE`
+   * bytes and may not overlap `input`.
+   */
+  void seal (
+    unsigned char *output,
+    const unsigned char *input,
+    size_t size,
+    const unsigned char *nonce,
+    const unsigned char *key
+  );
+
+  /**
+   * Verifies and decrypts `size` bytes of `input` sealed with `seal()` into
+   * `output`, which must hold `size - MAC_SIZE` bytes. Returns `false`,
+   * leaving `output` untouched, when `input` was not sealed with `key`
+   * and `nonce` or was modified.
+   */
+  bool open (
+    unsigned char *output,
+    const unsigned char *input,
+    size_t size,
+    const unsigned char *nonce,
+    const unsigned char *key
+  );
+}
+#endif
@@ -91,6 +91,24 @@ namespace SSC {
     };
   }
 
+  static JSON::Object::Entries getPeerStatsJSON (
+    Peer *peer,
+    const Peer::ReceiveQueueDrops& drops
+  ) {
+    return JSON::Object::Entries {
+      {"id", std::to_string(peer->id)},
+      {"packetsIn", peer->stats.packetsIn.load()},
+      {"packetsOut", peer->stats.packetsOut.load()},
+      {"bytesIn", peer->stats.bytesIn.load()},
+      {"bytesOut", peer->stats.bytesOut.load()},
+      {"sendErrors", peer->stats.sendErrors.load()},
+      {"eagain", peer->stats.eagain.load()},
+      {"inflateErrors", peer->stats.inflateErrors.load()},
+      {"decryptErrors", peer->stats.decryptErrors.load()},
+      {"receiveQueueDrops", peer->getReceiveQueueDrops(drops)}
+    };
+  }
+
   void Core::UDP::bind (
     const String seq,
     uint64_t peerId,
@@ -120,6 +138,12 @@ namespace SSC {
         return cb(seq, json, Post{});
       }
 
+      if (options.rate > 0) {
+        peer->setPacing(options.rate, options.burst, options.highWaterMark);
+      }
+
+      peer->options.udp.compress = options.compress;
+
       auto info = peer->getLocalPeerInfo();
 
       if (info->err < 0) {
@@ -177,6 +201,12 @@ namespace SSC {
         return cb(seq, json, Post{});
       }
 
+      if (options.rate > 0) {
+        peer->setPacing(options.rate, options.burst, options.highWaterMark);
+      }
+
+      peer->options.udp.compress = options.compress;
+
       auto info = peer->getRemotePeerInfo();
 
       if (info->err < 0) {
@@ -356,7 +386,64 @@ namespace SSC {
       auto port = options.port;
       auto bytes = options.bytes;
       auto address = options.address;
-      peer->send(bytes, size, port, address, [=](auto status, auto post) {
+
+      auto send = [=](Peer::RequestContext::Callback callback) {
+        if (options.sizes.size() > 0) {
+          peer->sendBatch(bytes, options.sizes, port, address, callback);
+        } else {
+          peer->send(bytes, size, port, address, callback);
+        }
+      };
+
+      // paced peers copy `bytes` into a native queue drained by the loop,
+      // so the reply reports queue pressure and a later failed send is
+      // emitted as an error event for the socket
+      if (peer->isPaced()) {
+        send([=](auto status, auto post) {
+          if (status < 0) {
+            auto json = JSON::Object::Entries {
+              {"source", "udp.send"},
+              {"err", JSON::Object::Entries {
+                {"id", std::to_string(peerId)},
+                {"code", String(uv_err_name(status))},
+                {"message", String(uv_strerror(status))}
+              }}
+            };
+
+            cb("-1", json, Post{});
+          }
+        });
+
+        auto backpressure = !peer->isWritable();
+
+        if (backpressure) {
+          Lock lock(peer->mutex);
+          peer->pacing.ondrain = [=]() {
+            auto json = JSON::Object::Entries {
+              {"source", "udp.drain"},
+              {"data", JSON::Object::Entries {
+                {"id", std::to_string(peerId)}
+              }}
+            };
+
+            cb("-1", json, Post{});
+          };
+        }
+
+        auto json = JSON::Object::Entries {
+          {"source", "udp.send"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(peerId)},
+            {"queued", (uint64_t) peer->pacing.queuedBytes},
+            {"highWaterMark", (uint64_t) peer->pacing.highWaterMark},
+            {"backpressure", backpressure}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      send([=](auto status, auto post) {
         if (status < 0) {
           auto json = JSON::Object::Entries {
             {"source", "udp.send"},
@@ -382,6 +469,82 @@ namespace SSC {
     });
   }
 
+  void Core::UDP::setKey (
+    const String seq,
+    uint64_t peerId,
+    const Vector<unsigned char> key,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      if (!this->core->hasPeer(peerId)) {
+        auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.setKey", peerId);
+        return cb(seq, json, Post{});
+      }
+
+      auto peer = this->core->getPeer(peerId);
+      peer->setKey(key.size() > 0 ? key.data() : nullptr);
+
+      auto json = JSON::Object::Entries {
+        {"source", "udp.setKey"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(peerId)},
+          {"encrypted", key.size() > 0}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::UDP::getStats (
+    const String seq,
+    uint64_t peerId,
+    Module::Callback cb
+  ) {
+    if (!this->core->hasPeer(peerId)) {
+      auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.getStats", peerId);
+      return cb(seq, json, Post{});
+    }
+
+    auto peer = this->core->getPeer(peerId);
+
+    if (!peer->isUDP()) {
+      auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.getStats", peerId);
+      return cb(seq, json, Post{});
+    }
+
+    auto drops = Peer::readReceiveQueueDrops();
+    auto json = JSON::Object::Entries {
+      {"source", "udp.getStats"},
+      {"data", getPeerStatsJSON(peer, drops)}
+    };
+
+    cb(seq, json, Post{});
+  }
+
+  void Core::UDP::getAllStats (const String seq, Module::Callback cb) {
+    // procfs is parsed once up front and not while holding `peersMutex`
+    auto drops = Peer::readReceiveQueueDrops();
+    JSON::Array::Entries entries;
+
+    {
+      Lock lock(this->core->peersMutex);
+      for (const auto& tuple : this->core->peers) {
+        auto peer = tuple.second;
+        if (peer != nullptr && peer->isUDP()) {
+          entries.push_back(getPeerStatsJSON(peer, drops));
+        }
+      }
+    }
+
+    auto json = JSON::Object::Entries {
+      {"source", "udp.getAllStats"},
+      {"data", entries}
+    };
+
+    cb(seq, json, Post{});
+  }
+
   void Core::UDP::readStart (String seq, uint64_t peerId, Module::Callback cb) {
     if (!this->core->hasPeer(peerId)) {
       auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.readStart", peerId);
@@ -437,6 +600,8 @@ namespace SSC {
       }
 
       if (nread > 0) {
+        // one arena per datagram for the reply envelope
+        JSON::Arena::Scope scope;
         char address[17] = {0};
         Post post;
         int port;
@@ -313,18 +313,42 @@ MAIN {
     // just stdout and we can write the data to the pipe.
     //
     app.dispatch([&, out] {
-      IPC::Message message(out);
+      // a line starting with `{` is a JSON object with the same fields as an
+      // `ipc://` URI, whose values are not URI encoded
+      auto isJSON = out.size() > 0 && out[0] == '{';
+      IPC::Message message;
+
+      if (isJSON) {
+        try {
+          auto object = JSON::parse(out);
+
+          if (object.type != JSON::Type::Object) {
+            throw JSON::Error("TypeError", "expecting an object", "onStdOut");
+          }
+
+          message = IPC::Message(object.as<JSON::Object>());
+        } catch (...) {
+          stdWrite(out, false);
+          return;
+        }
+      } else {
+        message = IPC::Message(out);
+      }
+
+      auto decode = [isJSON](const SSC::String& string) {
+        return isJSON ? string : decodeURIComponent(string);
+      };
 
       auto value = message.get("value");
       auto seq = message.get("seq");
 
       if (message.name == "log" || message.name == "stdout") {
-        stdWrite(decodeURIComponent(value), false);
+        stdWrite(decode(value), false);
         return;
       }
 
       if (message.name == "stderr") {
-        stdWrite(decodeURIComponent(value), true);
+        stdWrite(decode(value), true);
         return;
       }
 
@@ -343,7 +367,7 @@ MAIN {
           auto window = windowManager.getWindow(message.index);
           if (window) {
             window->eval(getEmitToRenderProcessJavaScript(
-              decodeURIComponent(message.get("event")),
+              decode(message.get("event")),
               value
             ));
           }
@@ -352,7 +376,7 @@ MAIN {
             if (w != nullptr) {
               auto window = windowManager.getWindow(w->opts.index);
               window->eval(getEmitToRenderProcessJavaScript(
-                decodeURIComponent(message.get("event")),
+                decode(message.get("event")),
                 value
               ));
             }
@@ -445,8 +469,8 @@ MAIN {
 #ifdef _WIN32
         size_t last_pos = 0;
         while ((last_pos = process->path.find('\\', last_pos)) != std::string::npos) {
-          process->path.replace(last_pos, 1, "\\\\\\\\");
-          last_pos += 4;
+          process->path.replace(last_pos, 1, "\\\\");
+          last_pos += 2;
         }
 #endif
         const JSON::Object json = JSON::Object::Entries {
@@ -115,7 +115,9 @@ static String getcwd () {
                                                                                \
   if (!router->core->hasPost(result.post.id)) {                                \
     if (result.post.body != nullptr) {                                         \
-      delete [] result.post.body;                                              \
+      if (!router->core->fs.buffers.release(result.post.body)) {               \
+        delete [] result.post.body;                                            \
+      }                                                                        \
     }                                                                          \
   }                                                                            \
 }
@@ -215,6 +217,147 @@ void initFunctionsTable (Router *router) {
     reply(Result { message.seq, message });
   });
 
+  /**
+   * Creates a zlib stream fed with 'compression.write'.
+   * @param id
+   * @param decompress Inflate instead of deflate (default: false)
+   * @param format 'gzip' (default), 'deflate' or 'raw'
+   * @param level Compression level from 0 to 9 (default: -1, zlib default)
+   */
+  router->map("compression.createStream", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    Core::Compression::Options options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.level, "level", std::stoi, "-1");
+
+    options.format = message.get("format", "gzip");
+
+    if (options.format != "gzip" && options.format != "deflate" && options.format != "raw") {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'format' given in parameters"}
+      }});
+    }
+
+    router->core->compression.createStream(
+      message.seq,
+      id,
+      message.get("decompress") == "true",
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Destroys a zlib stream, discarding any output not yet produced.
+   * @param id
+   */
+  router->map("compression.destroyStream", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->compression.destroyStream(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Compresses or decompresses everything readable from one open file
+   * descriptor into another on the threadpool, without copying bytes
+   * through JavaScript. Emits progress as 'compression.pipe' data.
+   * @param id Pipe ID, used in progress events
+   * @param source File descriptor ID read from its current position
+   * @param target File descriptor ID written at its current position
+   * @param decompress Inflate instead of deflate (default: false)
+   * @param format 'gzip' (default), 'deflate' or 'raw'
+   * @param level Compression level from 0 to 9 (default: -1, zlib default)
+   */
+  router->map("compression.pipe", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "source", "target"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    uint64_t source;
+    uint64_t target;
+    Core::Compression::Options options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(source, "source", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(target, "target", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.level, "level", std::stoi, "-1");
+
+    options.format = message.get("format", "gzip");
+
+    if (options.format != "gzip" && options.format != "deflate" && options.format != "raw") {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'format' given in parameters"}
+      }});
+    }
+
+    router->core->compression.pipe(
+      message.seq,
+      id,
+      source,
+      target,
+      message.get("decompress") == "true",
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Feeds the message buffer to a zlib stream on the threadpool and replies
+   * with the output produced so far as an octet stream, which may be empty.
+   * Writes to the same stream must not overlap.
+   * @param id
+   * @param final Ends the stream, flushing all remaining output (default: false)
+   */
+  router->map("compression.write", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->compression.write(
+      message.seq,
+      id,
+      message.buffer.bytes,
+      message.buffer.size,
+      message.get("final") == "true",
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Returns a snapshot of native runtime diagnostics, such as the number
+   * and size of file system requests in flight.
+   */
+  router->map("diagnostics.query", [=](auto message, auto router, auto reply) {
+    router->core->diagnostics.query(
+      message.seq,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
   /**
    * Look up an IP address by `hostname`.
    * @param hostname Host name to lookup
@@ -262,6 +405,50 @@ void initFunctionsTable (Router *router) {
     );
   });
 
+  /**
+   * Cancels an in-flight 'fs.sendToPeer'. The transfer replies to its own
+   * request once datagrams still in flight have been sent.
+   * @param transferId
+   */
+  router->map("fs.cancelSendToPeer", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"transferId"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t transferId;
+    REQUIRE_AND_GET_MESSAGE_VALUE(transferId, "transferId", std::stoull);
+
+    router->core->fs.cancelSendToPeer(
+      message.seq,
+      transferId,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Cancels an in-flight walk. The walk replies to its own request with the
+   * entries found so far once scans still running have finished.
+   * @param id
+   */
+  router->map("fs.cancelWalk", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.cancelWalk(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
   /**
    * Returns a mapping of file system constants.
    */
@@ -402,12 +589,11 @@ void initFunctionsTable (Router *router) {
   });
 
   /**
-   * Computes stats for an open file descriptor.
+   * Finalizes the digest of the bytes written to an open file descriptor
+   * since 'fs.hashWrites' and stops hashing its writes.
    * @param id
-   * @see stat(2)
-   * @see fstat(2)
    */
-  router->map("fs.fstat", [=](auto message, auto router, auto reply) {
+  router->map("fs.digest", [=](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
@@ -417,108 +603,138 @@ void initFunctionsTable (Router *router) {
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.fstat(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+    router->core->fs.digest(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Returns all open file or directory descriptors.
+   * Allocates or releases disk space for a range of an open file descriptor.
+   * @param id
+   * @param offset
+   * @param length
+   * @param mode 'allocate' (default) extends the file to cover the range,
+   *   'keep-size' reserves it without changing the file size and
+   *   'punch-hole' releases it
+   * @see fallocate(2)
    */
-  router->map("fs.getOpenDescriptors", [=](auto message, auto router, auto reply) {
-    router->core->fs.getOpenDescriptors(
+  router->map("fs.fallocate", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "length"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    int64_t offset;
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoll, "0");
+
+    int64_t length;
+    REQUIRE_AND_GET_MESSAGE_VALUE(length, "length", std::stoll);
+
+    auto mode = message.get("mode", "allocate");
+
+    if (mode != "allocate" && mode != "keep-size" && mode != "punch-hole") {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'mode' given in parameters"}
+      }});
+    }
+
+    router->core->fs.fallocate(
       message.seq,
+      id,
+      offset,
+      length,
+      mode,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Computes stats for a symbolic link at `path`.
-   * @param path
-   * @see stat(2)
-   * @see lstat(2)
+   * Hashes the contents of an open file descriptor on the threadpool and
+   * replies with the digest only. Writes buffered with 'fs.writeBehind' are
+   * flushed first.
+   * @param id
+   * @param algorithm 'sha256' (default), 'blake2b', 'blake2b256' or 'xxh64'
    */
-  router->map("fs.lstat", [=](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path"});
+  router->map("fs.fhash", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.lstat(
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.fhash(
       message.seq,
-      message.get("path"),
+      id,
+      message.get("algorithm", "sha256"),
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Creates a directory at `path` with an optional mode.
-   * @param path
-   * @param mode
-   * @see mkdir(2)
+   * Writes every buffered write of an open file descriptor, see
+   * 'fs.writeBehind'. Replies with the error of a failed batch, if any.
+   * @param id
    */
-  router->map("fs.mkdir", [=](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path", "mode"});
+  router->map("fs.flush", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    int mode = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.mkdir(
+    router->core->fs.flush(
       message.seq,
-      message.get("path"),
-      mode,
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Opens a file descriptor at `path` for `id` with `flags` and `mode`
+   * Synchronizes the data of an open file descriptor with the disk, without
+   * metadata that is not needed to read it back. Writes buffered with
+   * 'fs.writeBehind' are flushed first.
    * @param id
-   * @param path
-   * @param flags
-   * @param mode
-   * @see open(2)
+   * @see fdatasync(2)
    */
-  router->map("fs.open", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {
-      "id",
-      "path",
-      "flags",
-      "mode"
-    });
+  router->map("fs.fdatasync", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
     uint64_t id;
-    int mode = 0;
-    int flags = 0;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
-    REQUIRE_AND_GET_MESSAGE_VALUE(flags, "flags", std::stoi);
 
-    router->core->fs.open(
+    router->core->fs.fsync(
       message.seq,
       id,
-      message.get("path"),
-      flags,
-      mode,
+      true,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Opens a directory descriptor at `path` for `id` with `flags` and `mode`
+   * Computes stats for an open file descriptor.
    * @param id
-   * @param path
-   * @see opendir(3)
+   * @param encoding 'binary' for a fixed-layout stats record (default: json)
+   * @see stat(2)
+   * @see fstat(2)
    */
-  router->map("fs.opendir", [=](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id", "path"});
+  router->map("fs.fstat", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
@@ -527,50 +743,46 @@ void initFunctionsTable (Router *router) {
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.opendir(
+    router->core->fs.fstat(
       message.seq,
       id,
-      message.get("path"),
+      message.get("encoding") == "binary",
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Reads `size` bytes at `offset` from the underlying file descriptor.
+   * Synchronizes the data and metadata of an open file descriptor with the
+   * disk. Writes buffered with 'fs.writeBehind' are flushed first.
    * @param id
-   * @param size
-   * @param offset
-   * @see read(2)
+   * @see fsync(2)
    */
-  router->map("fs.read", [=](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id", "size", "offset"});
+  router->map("fs.fsync", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
     uint64_t id;
-    int size = 0;
-    int offset = 0;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoi);
-    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
 
-    router->core->fs.read(
+    router->core->fs.fsync(
       message.seq,
       id,
-      size,
-      offset,
+      false,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Reads next `entries` of from the underlying directory descriptor.
+   * Truncates or extends an open file descriptor to `length` bytes. Writes
+   * buffered with 'fs.writeBehind' are flushed first.
    * @param id
-   * @param entries (default: 256)
+   * @param length
+   * @see ftruncate(2)
    */
-  router->map("fs.readdir", [=](auto message, auto router, auto reply) {
+  router->map("fs.ftruncate", [=](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
@@ -578,23 +790,759 @@ void initFunctionsTable (Router *router) {
     }
 
     uint64_t id;
-    int entries = 0;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(entries, "entries", std::stoi);
 
-    router->core->fs.readdir(
+    int64_t length;
+    REQUIRE_AND_GET_MESSAGE_VALUE(length, "length", std::stoll, "0");
+
+    router->core->fs.ftruncate(
+      message.seq,
+      id,
+      length,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Hashes the file at `path` on the threadpool and replies with the digest
+   * only.
+   * @param path
+   * @param algorithm 'sha256' (default), 'blake2b', 'blake2b256' or 'xxh64'
+   */
+  router->map("fs.hash", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.hash(
+      message.seq,
+      message.get("path"),
+      message.get("algorithm", "sha256"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Hashes every byte written to an open file descriptor from now on. Each
+   * write has to continue where the previous one ended, otherwise
+   * 'fs.digest' fails. See 'fs.digest'.
+   * @param id
+   * @param algorithm 'sha256' (default), 'blake2b', 'blake2b256' or 'xxh64'
+   */
+  router->map("fs.hashWrites", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.hashWrites(
+      message.seq,
+      id,
+      message.get("algorithm", "sha256"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Returns all open file or directory descriptors.
+   */
+  router->map("fs.getOpenDescriptors", [=](auto message, auto router, auto reply) {
+    router->core->fs.getOpenDescriptors(
+      message.seq,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Computes stats for a symbolic link at `path`.
+   * @param path
+   * @param encoding 'binary' for a fixed-layout stats record (default: json)
+   * @see stat(2)
+   * @see lstat(2)
+   */
+  router->map("fs.lstat", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.lstat(
+      message.seq,
+      message.get("path"),
+      message.get("encoding") == "binary",
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Creates a directory at `path` with an optional mode.
+   * @param path
+   * @param mode
+   * @see mkdir(2)
+   */
+  router->map("fs.mkdir", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path", "mode"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    int mode = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+
+    router->core->fs.mkdir(
+      message.seq,
+      message.get("path"),
+      mode,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Maps an open file descriptor into memory. Subsequent `fs.read` calls
+   * for ranges within the mapping are served from it.
+   * @param id
+   * @param advice One of `normal`, `sequential`, `random` or `willneed`
+   * @see mmap(2)
+   * @see madvise(2)
+   */
+  router->map("fs.mmap", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.mmap(
+      message.seq,
+      id,
+      message.get("advice", "normal"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Releases the memory mapping of an open file descriptor.
+   * @param id
+   * @see munmap(2)
+   */
+  router->map("fs.munmap", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.munmap(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Opens a file descriptor at `path` for `id` with `flags` and `mode`
+   * @param id
+   * @param path
+   * @param flags
+   * @param mode
+   * @see open(2)
+   */
+  router->map("fs.open", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {
+      "id",
+      "path",
+      "flags",
+      "mode"
+    });
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    int mode = 0;
+    int flags = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(flags, "flags", std::stoi);
+
+    router->core->fs.open(
+      message.seq,
+      id,
+      message.get("path"),
+      flags,
+      mode,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Opens a directory descriptor at `path` for `id` with `flags` and `mode`
+   * @param id
+   * @param path
+   * @see opendir(3)
+   */
+  router->map("fs.opendir", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.opendir(
+      message.seq,
+      id,
+      message.get("path"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Reads `size` bytes at `offset` from the underlying file descriptor.
+   * @param id
+   * @param size
+   * @param offset
+   * @see read(2)
+   */
+  router->map("fs.read", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "size", "offset"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    int size = 0;
+    int offset = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
+
+    router->core->fs.read(
+      message.seq,
+      id,
+      size,
+      offset,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Configures reads ahead of a sequential reader of an open file. Up to
+   * `window` chunks of `size` bytes starting at `offset` are kept in flight,
+   * so matching `fs.read` calls are answered without waiting on the disk.
+   * Replies with hit, stall and miss counts and the time reads stalled.
+   * @param id
+   * @param size Bytes per chunk (default: 65536)
+   * @param window Chunks kept ahead, 0 to stop, omitted to only query
+   * @param offset Offset of the first chunk (default: 0)
+   * @see posix_fadvise(2)
+   */
+  router->map("fs.readAhead", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    size_t size = 0;
+    int window = -1;
+    int64_t offset = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoull, "65536");
+    REQUIRE_AND_GET_MESSAGE_VALUE(window, "window", std::stoi, "-1");
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoll, "0");
+
+    router->core->fs.readAhead(
+      message.seq,
+      id,
+      size,
+      window,
+      offset,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Reads into `sizes` consecutive buffers at `offset` from the underlying
+   * file descriptor with a single read. The response body holds every
+   * buffer back to back.
+   * @param id
+   * @param sizes Comma separated buffer sizes
+   * @param offset
+   * @see readv(2)
+   */
+  router->map("fs.readv", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "sizes", "offset"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    int offset = 0;
+    size_t size = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
+
+    try {
+      for (const auto& value : split(message.get("sizes"), ',')) {
+        size += std::stoull(value);
+      }
+    } catch (...) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters"}
+      }});
+    }
+
+    // consecutive buffers in one body are equivalent to a single read
+    router->core->fs.read(
+      message.seq,
+      id,
+      size,
+      offset,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Reads the remaining contents of the underlying file descriptor in a
+   * single response.
+   * @param id
+   * @see read(2)
+   */
+  router->map("fs.readFile", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.readFile(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Reads next `entries` of from the underlying directory descriptor.
+   * @param id
+   * @param entries (default: 256)
+   * @param withStats Include stats for each entry (default: false)
+   */
+  router->map("fs.readdir", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    int entries = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(entries, "entries", std::stoi);
+
+    router->core->fs.readdir(
+      message.seq,
+      id,
+      entries,
+      message.get("withStats") == "true",
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Marks a file or directory descriptor as retained.
+   * @param id
+   */
+  router->map("fs.retainOpenDescriptor", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.retainOpenDescriptor(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Renames file at path `src` to path `dest`.
+   * @param src
+   * @param dest
+   * @see rename(2)
+   */
+  router->map("fs.rename", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"src", "dest"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.rename(
+      message.seq,
+      message.get("src"),
+      message.get("dest"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Removes file at `path`.
+   * @param path
+   * @see rmdir(2)
+   */
+  router->map("fs.rmdir", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.rmdir(
+      message.seq,
+      message.get("path"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Sends a range of an open file descriptor to a peer natively, without the
+   * bytes crossing the bridge. Datagrams are paced by the peer's pacing
+   * options and progress is emitted as 'fs.sendToPeer' events.
+   * @param id
+   * @param transferId
+   * @param peerId
+   * @param offset
+   * @param length Bytes to send (default: until the end of the file)
+   * @param port Destination of datagrams for peers that are not connected
+   * @param address Destination of datagrams for peers that are not connected
+   * @param chunkSize Bytes per datagram (default: 1200)
+   * @param window Datagrams in flight (default: 16)
+   * @param progressInterval Milliseconds between progress events (default: 100)
+   * @see sendfile(2)
+   */
+  router->map("fs.sendToPeer", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "transferId", "peerId"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    uint64_t transferId;
+    REQUIRE_AND_GET_MESSAGE_VALUE(transferId, "transferId", std::stoull);
+
+    uint64_t peerId;
+    REQUIRE_AND_GET_MESSAGE_VALUE(peerId, "peerId", std::stoull);
+
+    Core::FS::SendToPeerOptions options;
+    options.address = message.get("address");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.offset, "offset", std::stoll, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.length, "length", std::stoll, "-1");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.chunkSize, "chunkSize", std::stoull, "1200");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.window, "window", std::stoull, "16");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.progressInterval, "progressInterval", std::stoull, "100");
+
+    router->core->fs.sendToPeer(
+      message.seq,
+      id,
+      transferId,
+      peerId,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Computes stats for a file at `path`.
+   * @param path
+   * @param encoding 'binary' for a fixed-layout stats record (default: json)
+   * @see stat(2)
+   */
+  router->map("fs.stat", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.stat(
+      message.seq,
+      message.get("path"),
+      message.get("encoding") == "binary",
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Computes stats for every path in `message.buffer.bytes` in a single
+   * reply. Paths are given as a JSON array of strings.
+   * @param encoding 'binary' for one stats record per path (default: json)
+   * @see stat(2)
+   */
+  router->map("fs.statMany", [=](auto message, auto router, auto reply) {
+    Vector<String> paths;
+
+    try {
+      JSON::Any body = message.json();
+
+      if (body.type != JSON::Type::Null) {
+        if (body.type != JSON::Type::Array) {
+          throw JSON::Error("TypeError", "expecting an array", "fs.statMany");
+        }
+
+        const auto& array = body.as<JSON::Array>();
+
+        for (size_t i = 0; i < array.size(); ++i) {
+          auto path = array.get(i);
+
+          if (path.type != JSON::Type::String) {
+            throw JSON::Error("TypeError", "expecting a string", "fs.statMany");
+          }
+
+          paths.push_back(path.as<JSON::String>().value());
+        }
+      }
+    } catch (...) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'paths' given in body"}
+      }});
+    }
+
+    router->core->fs.statMany(
+      message.seq,
+      paths,
+      message.get("encoding") == "binary",
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Truncates or extends the file at `path` to `length` bytes.
+   * @param path
+   * @param length
+   * @see truncate(2)
+   */
+  router->map("fs.truncate", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    int64_t length;
+    REQUIRE_AND_GET_MESSAGE_VALUE(length, "length", std::stoll, "0");
+
+    router->core->fs.truncate(
+      message.seq,
+      message.get("path"),
+      length,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Removes a file or empty directory at `path`.
+   * @param path
+   * @see unlink(2)
+   */
+  router->map("fs.unlink", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.unlink(
+      message.seq,
+      message.get("path"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Stops a watcher started with 'fs.watch'. Changes still within the
+   * debounce window are emitted first.
+   * @param id
+   */
+  router->map("fs.unwatch", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.unwatch(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Recursively walks the directory tree at `path` on the threadpool.
+   * Entries are emitted in 'fs.walk' batches of `batchSize` and the request
+   * replies with the last batch once the walk is done.
+   * @param id
+   * @param path
+   * @param depth Max depth of entries, -1 for no limit (default: -1)
+   * @param include Newline separated glob patterns of entries to report
+   * @param exclude Newline separated glob patterns of entries to skip
+   * @param symlinks 'report', 'follow' or 'skip' (default: 'report')
+   * @param withStats Include stats for each entry (default: false)
+   * @param batchSize Entries per batch (default: 256)
+   * @param concurrency Max directories scanned in parallel (default: 4)
+   */
+  router->map("fs.walk", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    Core::FS::WalkOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.maxDepth, "depth", std::stoi, "-1");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.batchSize, "batchSize", std::stoull, "256");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.concurrency, "concurrency", std::stoull, "4");
+
+    options.include = split(message.get("include"), '\n');
+    options.exclude = split(message.get("exclude"), '\n');
+    options.symlinks = message.get("symlinks", "report");
+    options.withStats = message.get("withStats") == "true";
+
+    if (
+      options.symlinks != "report" &&
+      options.symlinks != "follow" &&
+      options.symlinks != "skip"
+    ) {
+      auto err = JSON::Object::Entries {
+        {"message", "Expecting 'symlinks' to be 'report', 'follow' or 'skip'"}
+      };
+
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.walk(
+      message.seq,
+      id,
+      message.get("path"),
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Watches the file or directory at `path` for changes. Changes are
+   * coalesced per path for `debounce` milliseconds and emitted as a single
+   * 'fs.watch' batch, nothing is emitted while nothing changes. The request
+   * replies once the watch has started.
+   * @param id
+   * @param path
+   * @param recursive Watch subdirectories (default: false)
+   * @param debounce Milliseconds changes are coalesced for (default: 50)
+   */
+  router->map("fs.watch", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    Core::FS::WatchOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.debounce, "debounce", std::stoull, "50");
+
+    options.recursive = message.get("recursive") == "true";
+
+    router->core->fs.watch(
+      message.seq,
+      id,
+      message.get("path"),
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Writes buffer at `message.buffer.bytes` of size `message.buffers.size`
+   * at `offset` for an opened file handle.
+   * @param id Handle ID for an open file descriptor
+   * @param offset The offset to start writing at
+   * @see write(2)
+   */
+  router->map("fs.write", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "offset"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    if (message.buffer.bytes == nullptr || message.buffer.size == 0) {
+      auto err = JSON::Object::Entries {{ "message", "Missing buffer in message" }};
+      return reply(Result::Err { message, err });
+    }
+
+
+    uint64_t id;
+    int offset = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
+
+    router->core->fs.write(
       message.seq,
       id,
-      entries,
+      message.buffer.bytes,
+      message.buffer.size,
+      offset,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Marks a file or directory descriptor as retained.
+   * Buffers `fs.write` calls of an open file descriptor. Writes are
+   * acknowledged once copied and written in batches when `highWaterMark`
+   * bytes are pending, after `delay` milliseconds, or on 'fs.flush' and
+   * 'fs.close'. A failed batch is reported to the next write, flush or close.
    * @param id
+   * @param highWaterMark Bytes per batch, 0 to flush and stop (default: 65536)
+   * @param delay Milliseconds before a partial batch is written (default: 10)
+   * @see writev(2)
    */
-  router->map("fs.retainOpenDescriptor", [=](auto message, auto router, auto reply) {
+  router->map("fs.writeBehind", [=](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
@@ -602,123 +1550,124 @@ void initFunctionsTable (Router *router) {
     }
 
     uint64_t id;
+    size_t highWaterMark = 0;
+    uint64_t delay = 0;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(highWaterMark, "highWaterMark", std::stoull, "65536");
+    REQUIRE_AND_GET_MESSAGE_VALUE(delay, "delay", std::stoull, "10");
 
-    router->core->fs.retainOpenDescriptor(
+    router->core->fs.writeBehind(
       message.seq,
       id,
+      highWaterMark,
+      delay,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Renames file at path `src` to path `dest`.
-   * @param src
-   * @param dest
-   * @see rename(2)
+   * Writes the entire buffer at `message.buffer.bytes` at the current
+   * position of an opened file handle in a single response.
+   * @param id Handle ID for an open file descriptor
+   * @see write(2)
    */
-  router->map("fs.rename", [=](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"src", "dest"});
+  router->map("fs.writeFile", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.rename(
-      message.seq,
-      message.get("src"),
-      message.get("dest"),
-      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
-    );
-  });
-
-  /**
-   * Removes file at `path`.
-   * @param path
-   * @see rmdir(2)
-   */
-  router->map("fs.rmdir", [=](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path"});
-
-    if (err.type != JSON::Type::Null) {
-      return reply(Result::Err { message, err });
-    }
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.rmdir(
+    router->core->fs.writeFile(
       message.seq,
-      message.get("path"),
+      id,
+      message.buffer.bytes,
+      message.buffer.size,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Computes stats for a file at `path`.
+   * Durably replaces the file at `path` with `message.buffer.bytes`. The
+   * bytes are written to a temporary file in the same directory, synced
+   * with fdatasync and renamed over `path`, then the directory is synced.
+   * With `groupCommit`, writes into the same directory finishing within
+   * that many milliseconds share a single directory sync.
    * @param path
-   * @see stat(2)
+   * @param mode (default: 0o666)
+   * @param groupCommit Milliseconds to wait for other writes (default: 0)
+   * @see rename(2)
+   * @see fdatasync(2)
    */
-  router->map("fs.stat", [=](auto message, auto router, auto reply) {
+  router->map("fs.writeFileAtomic", [=](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"path"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.stat(
+    int mode = 0;
+    uint64_t groupCommit = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi, "438");
+    REQUIRE_AND_GET_MESSAGE_VALUE(groupCommit, "groupCommit", std::stoull, "0");
+
+    router->core->fs.writeFileAtomic(
       message.seq,
       message.get("path"),
+      message.buffer.bytes,
+      message.buffer.size,
+      mode,
+      groupCommit,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Removes a file or empty directory at `path`.
-   * @param path
-   * @see unlink(2)
+   * Writes `sizes` buffers packed back to back in `message.buffer.bytes`
+   * at `offset` with a single vectored write.
+   * @param id Handle ID for an open file descriptor
+   * @param sizes Comma separated buffer sizes (at most 16)
+   * @param offset The offset to start writing at (-1 for current position)
+   * @see writev(2)
    */
-  router->map("fs.unlink", [=](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path"});
+  router->map("fs.writev", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "sizes", "offset"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.unlink(
-      message.seq,
-      message.get("path"),
-      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
-    );
-  });
-
-  /**
-   * Writes buffer at `message.buffer.bytes` of size `message.buffers.size`
-   * at `offset` for an opened file handle.
-   * @param id Handle ID for an open file descriptor
-   * @param offset The offset to start writing at
-   * @see write(2)
-   */
-  router->map("fs.write", [=](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id", "offset"});
+    uint64_t id;
+    int64_t offset = 0;
+    Vector<size_t> sizes;
+    size_t size = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoll);
 
-    if (err.type != JSON::Type::Null) {
-      return reply(Result::Err { message, err });
+    try {
+      for (const auto& value : split(message.get("sizes"), ',')) {
+        sizes.push_back(std::stoull(value));
+        size += sizes.back();
+      }
+    } catch (...) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters"}
+      }});
     }
 
-    if (message.buffer.bytes == nullptr || message.buffer.size == 0) {
-      auto err = JSON::Object::Entries {{ "message", "Missing buffer in message" }};
+    if (size != message.buffer.size) {
+      auto err = JSON::Object::Entries {{ "message", "Buffer sizes do not match message buffer" }};
       return reply(Result::Err { message, err });
     }
 
-
-    uint64_t id;
-    int offset = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
-
-    router->core->fs.write(
+    router->core->fs.writev(
       message.seq,
       id,
       message.buffer.bytes,
-      message.buffer.size,
+      sizes,
       offset,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
@@ -794,6 +1743,98 @@ void initFunctionsTable (Router *router) {
     router->core->os.uname(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
   });
 
+  /**
+   * Closes a reliable datagram channel and its underlying UDP socket.
+   * @param id Handle ID of the channel
+   */
+  router->map("p2p.close", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->p2p.close(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Get congestion control and delivery state of a reliable datagram channel.
+   * @param id Handle ID of the channel
+   */
+  router->map("p2p.getState", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->p2p.getState(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Opens a reliable, ordered datagram channel between a local UDP socket
+   * and a remote peer. Received messages are emitted as `data` events with
+   * the source `p2p.message`.
+   * @param id Handle ID of the channel
+   * @param port Local port to bind to (default: 0)
+   * @param address Local address to bind to (default: 0.0.0.0)
+   * @param remotePort Port of the remote peer
+   * @param remoteAddress Address of the remote peer
+   */
+  router->map("p2p.open", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "remotePort", "remoteAddress"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    Core::P2P::OpenOptions options;
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.remotePort, "remotePort", std::stoi);
+
+    options.address = message.get("address", "0.0.0.0");
+    options.remoteAddress = message.get("remoteAddress");
+
+    router->core->p2p.open(
+      message.seq,
+      id,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Queues a message for reliable, ordered delivery on a channel.
+   * @param id Handle ID of the channel
+   * @param bytes The message bytes (request body)
+   */
+  router->map("p2p.send", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->p2p.send(
+      message.seq,
+      id,
+      message.buffer.bytes,
+      message.buffer.size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
   /**
    * Simply returns `pong`.
    */
@@ -937,6 +1978,10 @@ void initFunctionsTable (Router *router) {
    * @param port Port to bind the UDP socket to
    * @param address The address to bind the UDP socket to (default: 0.0.0.0)
    * @param reuseAddr Reuse underlying UDP socket address (default: false)
+   * @param rate Optional send pacing rate in bytes per second (default: 0, disabled)
+   * @param burst Optional send pacing burst size in bytes, at least 64 KiB (default: 64 KiB)
+   * @param highWaterMark Optional queued bytes before `udp.send` reports backpressure
+   * @param compress Raw deflate sent and inflate received payloads (default: false)
    */
   router->map("udp.bind", [=](auto message, auto router, auto reply) {
     Core::UDP::BindOptions options;
@@ -949,10 +1994,28 @@ void initFunctionsTable (Router *router) {
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
     REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.rate, "rate", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.burst, "burst", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.highWaterMark, "highWaterMark", std::stoull, "0");
+
+    if (options.burst > 0 && options.burst < Peer::MIN_PACING_BURST) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"code", "ERR_OUT_OF_RANGE"},
+        {"message", "Invalid 'burst' given in parameters, must be at least 65536 bytes"}
+      }});
+    }
 
     options.reuseAddr = message.get("reuseAddr") == "true";
+    options.compress = message.get("compress") == "true";
     options.address = message.get("address", "0.0.0.0");
 
+    if (options.compress && !Core::Compression::isSupported()) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"code", "ENOTSUP"},
+        {"message", "Compression is not supported on this platform"}
+      }});
+    }
+
     router->core->udp.bind(
       message.seq,
       id,
@@ -984,6 +2047,10 @@ void initFunctionsTable (Router *router) {
    * @param id Handle ID of underlying socket
    * @param port Port to connect the UDP socket to
    * @param address The address to connect the UDP socket to (default: 0.0.0.0)
+   * @param rate Optional send pacing rate in bytes per second (default: 0, disabled)
+   * @param burst Optional send pacing burst size in bytes, at least 64 KiB (default: 64 KiB)
+   * @param highWaterMark Optional queued bytes before `udp.send` reports backpressure
+   * @param compress Raw deflate sent and inflate received payloads (default: false)
    */
   router->map("udp.connect", [=](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id", "port"});
@@ -996,9 +2063,27 @@ void initFunctionsTable (Router *router) {
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
     REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.rate, "rate", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.burst, "burst", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.highWaterMark, "highWaterMark", std::stoull, "0");
+
+    if (options.burst > 0 && options.burst < Peer::MIN_PACING_BURST) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"code", "ERR_OUT_OF_RANGE"},
+        {"message", "Invalid 'burst' given in parameters, must be at least 65536 bytes"}
+      }});
+    }
 
+    options.compress = message.get("compress") == "true";
     options.address = message.get("address", "0.0.0.0");
 
+    if (options.compress && !Core::Compression::isSupported()) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"code", "ENOTSUP"},
+        {"message", "Compression is not supported on this platform"}
+      }});
+    }
+
     router->core->udp.connect(
       message.seq,
       id,
@@ -1091,6 +2176,34 @@ void initFunctionsTable (Router *router) {
     );
   });
 
+  /**
+   * Returns packet, byte and error counters for a socket.
+   * @param id Handle ID of underlying socket
+   */
+  router->map("udp.getStats", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->udp.getStats(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Returns a snapshot of counters for every UDP socket.
+   */
+  router->map("udp.getAllStats", [=](auto message, auto router, auto reply) {
+    router->core->udp.getAllStats(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
   /**
    * Initializes socket handle to start receiving data from the underlying
    * socket and route through the IPC bridge to the WebView.
@@ -1171,6 +2284,93 @@ void initFunctionsTable (Router *router) {
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
+
+  /**
+   * Sends the message buffer as consecutive datagrams of `sizes` bytes,
+   * encoding all of them in a single pass. Replies once every datagram
+   * has been sent, or queued for paced sockets, like `udp.send`.
+   * @param id Handle ID of underlying socket
+   * @param sizes Comma separated datagram sizes
+   * @param port The port to send data to
+   * @param address The address to send to (default: 0.0.0.0)
+   */
+  router->map("udp.sendBatch", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "port", "sizes"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    Core::UDP::SendOptions options;
+    uint64_t id;
+    size_t size = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+
+    try {
+      for (const auto& value : split(message.get("sizes"), ',')) {
+        options.sizes.push_back(std::stoull(value));
+        size += options.sizes.back();
+      }
+    } catch (...) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters"}
+      }});
+    }
+
+    if (size > message.buffer.size) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters"}
+      }});
+    }
+
+    options.size = size;
+    options.bytes = message.buffer.bytes;
+    options.address = message.get("address", "0.0.0.0");
+
+    router->core->udp.send(
+      message.seq,
+      id,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Installs the 32 byte key in the message buffer on a bound or connected
+   * socket. Every datagram sent is then sealed as a 24 byte nonce followed
+   * by an XSalsa20-Poly1305 secretbox, compatible with libsodium's
+   * `crypto_secretbox_easy()`, and datagrams received that do not open
+   * with the key are dropped. An empty buffer removes the key.
+   * @param id Handle ID of underlying socket
+   */
+  router->map("udp.setKey", [=](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    auto size = message.buffer.bytes != nullptr ? message.buffer.size : 0;
+
+    if (size != 0 && size != Secretbox::KEY_SIZE) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Key must be 32 bytes"}
+      }});
+    }
+
+    auto bytes = (const unsigned char *) message.buffer.bytes;
+
+    router->core->udp.setKey(
+      message.seq,
+      id,
+      Vector<unsigned char>(bytes, bytes + size),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
 }
 
 static void registerSchemeHandler (Router *router) {
@@ -68,6 +68,40 @@ namespace SSC::IPC {
     }
   }
 
+  // the fields of `object` become `args` as they would from an `ipc://`
+  // URI, so string values are used as is and other values as JSON
+  Message::Message (const JSON::Object& object) {
+    this->uri = object.str();
+
+    for (const auto& tuple : object.entries()) {
+      const auto& key = tuple.first;
+      const auto& value = tuple.second;
+      auto string = value.type == JSON::Type::String
+        ? value.as<JSON::String>().value()
+        : value.str();
+
+      if (key == "index" && value.type == JSON::Type::Number) {
+        this->index = (int) value.as<JSON::Number>().value();
+      } else if (key == "name") {
+        this->name = string;
+      } else if (key == "value") {
+        this->value = string;
+      } else if (key == "seq") {
+        this->seq = string;
+      }
+
+      this->args[key] = encodeURIComponent(string);
+    }
+  }
+
+  JSON::Any Message::json () const {
+    if (this->buffer.bytes == nullptr || this->buffer.size == 0) {
+      return nullptr;
+    }
+
+    return JSON::parse(this->buffer.bytes, this->buffer.size);
+  }
+
   bool Message::has (const String& key) const {
     return this->args.find(key) != this->args.end();
   }
@@ -144,8 +178,45 @@ namespace SSC::IPC {
   }
 
   String Result::str () const {
-    auto json = this->json();
-    return json.str();
+    JSON::Writer writer(512);
+
+    // the reply is streamed around the value instead of copying it to add
+    // the source, see `Result::json()`
+    if (!this->value.isNull()) {
+      if (!this->value.isObject()) {
+        writer.write(this->value);
+        return writer.output;
+      }
+
+      writer.beginObject();
+      writer.key("source");
+      writer.write(this->source);
+
+      for (const auto& tuple : this->value.as<JSON::Object>().entries()) {
+        if (tuple.first != "source") {
+          writer.key(tuple.first);
+          writer.write(tuple.second);
+        }
+      }
+
+      writer.endObject();
+      return writer.output;
+    }
+
+    writer.beginObject();
+    writer.key("source");
+    writer.write(this->source);
+
+    if (!this->err.isNull()) {
+      writer.key("err");
+      writer.write(this->err);
+    } else {
+      writer.key("data");
+      writer.write(this->data);
+    }
+
+    writer.endObject();
+    return writer.output;
   }
 
   Result::Err::Err (
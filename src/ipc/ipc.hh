@@ -78,9 +78,11 @@ namespace SSC::IPC {
       Message (const Message& message);
       Message (const String& source);
       Message (const String& source, char *bytes, size_t size);
+      Message (const JSON::Object& object);
       bool has (const String& key) const;
       String get (const String& key) const;
       String get (const String& key, const String& fallback) const;
+      JSON::Any json () const;
       String str () const { return this->uri; }
       const char * c_str () const { return this->uri.c_str(); }
   };
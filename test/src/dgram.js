@@ -363,6 +363,106 @@ test('connect + disconnect', async (t) => {
   })
 })
 
+test('paced socket signals backpressure and drains', async (t) => {
+  const server = dgram.createSocket('udp4').bind(41240)
+  const client = dgram.createSocket({
+    type: 'udp4',
+    rate: 64 * 1024,
+    highWaterMark: 16 * 1024
+  })
+
+  await new Promise((resolve) => server.once('listening', resolve))
+  await new Promise((resolve) => client.connect(41240, '127.0.0.1', resolve))
+
+  const payload = Buffer.alloc(1024)
+  const sends = []
+
+  // more than one burst worth of data is queued natively
+  for (let i = 0; i < 128; ++i) {
+    sends.push(new Promise((resolve) => client.send(payload, resolve)))
+  }
+
+  await Promise.all(sends)
+  t.ok(client.writableNeedDrain, 'socket needs drain after a large burst')
+  await new Promise((resolve) => client.once('drain', resolve))
+  t.ok(!client.writableNeedDrain, 'socket is writable after drain')
+
+  const stats = await client.getStats()
+  t.ok(stats.packetsOut > 0 && stats.bytesOut >= stats.packetsOut * payload.length, 'socket counts sent packets and bytes')
+
+  const all = await dgram.getAllStats()
+  t.ok(all.some((entry) => BigInt(entry.id) === client.id), 'getAllStats includes the socket')
+
+  client.close()
+  server.close()
+})
+
+test('paced socket rejects a burst below 64 KiB', async (t) => {
+  const client = dgram.createSocket({
+    type: 'udp4',
+    rate: 64 * 1024,
+    burst: 1024
+  })
+
+  const err = await new Promise((resolve) => client.connect(41242, '127.0.0.1', resolve))
+  t.equal(err?.code, 'ERR_OUT_OF_RANGE', 'connect fails with ERR_OUT_OF_RANGE')
+})
+
+if (os.platform() !== 'win32') {
+  test('compressed sockets deflate datagrams on the wire', async (t) => {
+    const server = dgram.createSocket({ type: 'udp4', compress: true }).bind(41241)
+    const client = dgram.createSocket({ type: 'udp4', compress: true })
+    const payload = Buffer.from('ping '.repeat(200))
+
+    await new Promise((resolve) => server.once('listening', resolve))
+    await new Promise((resolve) => client.connect(41241, '127.0.0.1', resolve))
+
+    const message = new Promise((resolve) => server.once('message', resolve))
+    await new Promise((resolve) => client.send(payload, resolve))
+
+    t.ok(Buffer.from(await message).equals(payload), 'payload is inflated on receive')
+
+    const stats = await client.getStats()
+    t.ok(stats.bytesOut < payload.length, 'fewer bytes are sent than the payload')
+
+    client.close()
+    server.close()
+  })
+}
+
+test('sockets with a key seal and open batches of datagrams', async (t) => {
+  const key = crypto.randomBytes(32)
+  const server = dgram.createSocket({ type: 'udp4', key }).bind(41242)
+  const client = dgram.createSocket('udp4')
+
+  await new Promise((resolve) => server.once('listening', resolve))
+  await new Promise((resolve) => client.connect(41242, '127.0.0.1', resolve))
+
+  const messages = []
+  const received = new Promise((resolve) => {
+    server.on('message', (data) => {
+      messages.push(Buffer.from(data).toString())
+      if (messages.length === 3) resolve()
+    })
+  })
+
+  // datagrams that do not open with the key are dropped
+  await client.setKey(crypto.randomBytes(32))
+  await new Promise((resolve) => client.send(Buffer.from('forged'), resolve))
+
+  await client.setKey(key)
+  await new Promise((resolve) => client.sendBatch(['a', 'bb', 'ccc'], resolve))
+  await received
+
+  t.deepEqual(messages.sort(), ['a', 'bb', 'ccc'], 'sealed datagrams are opened on receive')
+
+  const stats = await server.getStats()
+  t.equal(stats.decryptErrors, 1, 'datagrams sealed with another key are dropped')
+
+  client.close()
+  server.close()
+})
+
 /*
 test('can send and receive packets to a remote server', async (t) => {
   const remoteAddress = '3.25.141.150'
@@ -1,2 +1,3 @@
 // import './diagnostics/channels.js'
+import './diagnostics/query.js'
 import './diagnostics/window.js'
@@ -0,0 +1,12 @@
+import diagnostics from 'socket:diagnostics'
+import test from 'socket:test'
+
+test('diagnostics - query - fs requests', async (t) => {
+  const snapshot = await diagnostics.query()
+
+  t.ok(snapshot?.fs?.requests, 'fs request counters are reported')
+  t.equal(typeof snapshot.fs.requests.inFlight, 'number', 'in-flight count is a number')
+  t.equal(typeof snapshot.fs.requests.bytes, 'number', 'in-flight bytes is a number')
+  t.equal(typeof snapshot.fs.requests.pooled, 'number', 'pooled count is a number')
+  t.ok(['default', 'threadpool', 'io_uring'].includes(snapshot.fs.requestedEngine), 'requested fs engine is reported')
+})
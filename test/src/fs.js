@@ -1,3 +1,4 @@
 import './fs/index.js'
 import './fs/promises.js'
 import './fs/flags.js'
+import './fs/engine.js'
@@ -0,0 +1,66 @@
+import diagnostics from 'socket:diagnostics'
+import Buffer from 'socket:buffer'
+import path from 'socket:path'
+import fs from 'socket:fs/promises'
+import os from 'socket:os'
+
+import { test } from 'socket:test'
+
+const TMPDIR = `${os.tmpdir()}${path.sep}`
+const FIXTURES = /android/i.test(os.platform())
+  ? '/data/local/tmp/ssc-socket-test-fixtures/'
+  : `${TMPDIR}ssc-socket-test-fixtures${path.sep}`
+
+// the same workloads run against either engine, compare the reported
+// timings of a run with `SSC_FS_ENGINE=io_uring` to one without it
+const STAT_STORM_SIZE = 512
+const READ_STORM_SIZE = 64
+const WRITE_STORM_SIZE = 64
+
+async function measure (t, engine, name, workload) {
+  const start = Date.now()
+  await workload()
+  t.comment(`${engine}: ${name} took ${Date.now() - start}ms`)
+}
+
+test('fs engine - parallel stat, read and write workloads', async (t) => {
+  const { fs: { requestedEngine: engine } } = await diagnostics.query()
+  const files = ['file.txt', 'file.js', 'file.json']
+
+  await measure(t, engine, `${STAT_STORM_SIZE} stat calls`, async () => {
+    const stats = await Promise.all(Array.from({ length: STAT_STORM_SIZE }, (_, i) =>
+      fs.stat(FIXTURES + files[i % files.length])
+    ))
+
+    t.equal(stats.length, STAT_STORM_SIZE, 'every stat completes')
+  })
+
+  await measure(t, engine, `${READ_STORM_SIZE} open, read and close calls`, async () => {
+    const reads = await Promise.all(Array.from({ length: READ_STORM_SIZE }, async () => {
+      const fd = await fs.open(FIXTURES + 'file.txt', 'r')
+      const { bytesRead } = await fd.read(Buffer.alloc(16), 0, 16, 0)
+      await fd.close()
+      return bytesRead
+    }))
+
+    t.ok(reads.every((bytesRead) => bytesRead === 9), 'every read completes')
+  })
+
+  if (os.platform() !== 'android') {
+    await measure(t, engine, `${WRITE_STORM_SIZE} open, write and close calls`, async () => {
+      const data = Buffer.alloc(4096, 'x')
+      const writes = await Promise.all(Array.from({ length: WRITE_STORM_SIZE }, async (_, i) => {
+        const fd = await fs.open(`${TMPDIR}fs-engine-${i}.txt`, 'w')
+        const { bytesWritten } = await fd.write(data, 0, data.length, 0)
+        await fd.close()
+        return bytesWritten
+      }))
+
+      t.ok(writes.every((bytesWritten) => bytesWritten === data.length), 'every write completes')
+    })
+
+    await Promise.all(Array.from({ length: WRITE_STORM_SIZE }, (_, i) =>
+      fs.unlink(`${TMPDIR}fs-engine-${i}.txt`)
+    ))
+  }
+})
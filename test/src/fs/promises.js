@@ -1,6 +1,7 @@
 import Buffer from 'socket:buffer'
 import path from 'socket:path'
 import fs from 'socket:fs/promises'
+import dgram from 'socket:dgram'
 import os from 'socket:os'
 
 import { FileHandle } from 'socket:fs/handle'
@@ -60,6 +61,380 @@ test('fs.promises.readdir', async (t) => {
   t.deepEqual(files.map(file => file.name), ['0', '1', '2', 'a', 'b', 'c'].map(name => `${name}.txt`), 'array contains files')
 })
 
+test('fs.promises.readdir with stats', async (t) => {
+  const files = await fs.readdir(FIXTURES + 'directory', { withStats: true })
+  t.equal(files.length, 6, 'array contains 6 items')
+  t.ok(files.every((file) => file.stats?.isFile()), 'every entry has stats')
+})
+
+test('fs.promises.stat with bigint from a binary stats record', async (t) => {
+  const stats = await fs.stat(FIXTURES + 'file.txt', { bigint: true })
+  t.equal(stats.size, 9n, 'size is a bigint')
+  t.equal(stats.isFile(), true, 'stats are for a file')
+  t.ok(stats.mtimeMs > 0n, 'mtime is decoded')
+})
+
+test('FileHandle#stat and close release the descriptor', async (t) => {
+  const handle = await fs.open(FIXTURES + 'file.txt', 'r')
+
+  for (let i = 0; i < 8; ++i) {
+    const stats = await handle.stat()
+    t.equal(stats.size, 9, `binary fstat ${i + 1} returns the file size`)
+  }
+
+  t.equal(await handle.close(), true, 'handle closes after fstat')
+  t.ok(handle.closed, 'handle is closed')
+})
+
+test('fs.promises.statMany', async (t) => {
+  const stats = await fs.statMany([
+    FIXTURES + 'file.txt',
+    FIXTURES + 'directory',
+    FIXTURES + 'missing.txt'
+  ])
+
+  t.equal(stats.length, 3, 'a result is returned for every path')
+  t.equal(stats[0].size, 9, 'file stats are returned')
+  t.equal(stats[1].isDirectory(), true, 'directory stats are returned')
+  t.ok(stats[2] instanceof Error, 'an error is returned for a missing path')
+})
+
+test('fs.promises.statMany with paths that need escaping', async (t) => {
+  const stats = await fs.statMany([
+    FIXTURES + 'missing "quoted"\tfile-\u00e9.txt',
+    FIXTURES + 'file.txt'
+  ])
+
+  t.ok(stats[0] instanceof Error, 'an escaped path is stat\'d as given')
+  t.equal(stats[1].size, 9, 'paths after an escaped path are stat\'d')
+})
+
+test('fs.promises.walk', async (t) => {
+  const entries = []
+
+  for await (const entry of fs.walk(FIXTURES, { exclude: ['bin'], batchSize: 2 })) {
+    entries.push(entry)
+  }
+
+  const paths = entries.map((entry) => entry.path)
+  t.ok(paths.includes('file.txt'), 'top level entries are walked')
+  t.ok(paths.includes('directory/a.txt'), 'nested entries are walked')
+  t.ok(!paths.some((path) => path.startsWith('bin')), 'excluded entries are skipped')
+
+  const files = []
+  for await (const entry of fs.walk(FIXTURES, { include: ['*.json'], depth: 1 })) {
+    files.push(entry.name)
+  }
+
+  t.deepEqual(files, ['file.json'], 'include and depth filters are applied')
+})
+
+if (os.platform() !== 'android') {
+  test('fs.promises.watch', async (t) => {
+    const filename = `watch-${Math.random().toString(16).slice(2)}.txt`
+    const controller = new AbortController()
+    const changes = []
+
+    const watching = (async () => {
+      for await (const change of fs.watch(FIXTURES, { signal: controller.signal, debounce: 100 })) {
+        changes.push(change)
+        controller.abort()
+      }
+    })()
+
+    await new Promise((resolve) => setTimeout(resolve, 100))
+    await fs.writeFile(FIXTURES + filename, 'a')
+    await fs.writeFile(FIXTURES + filename, 'b')
+    await watching
+
+    t.ok(changes.some((change) => change.filename === filename), 'change is reported')
+    t.equal(
+      changes.filter((change) => change.filename === filename).length,
+      1,
+      'changes within the debounce window are coalesced'
+    )
+
+    await fs.unlink(FIXTURES + filename)
+  })
+}
+
+test('FileHandle#readAhead serves sequential reads from the ring', async (t) => {
+  const fd = await fs.open(FIXTURES + 'file.txt', 'r')
+  await fd.readAhead({ size: 4, window: 2, offset: 0 })
+
+  const chunks = []
+  for (let position = 0; position < 12; position += 4) {
+    const { bytesRead, buffer } = await fd.read(Buffer.alloc(4), 0, 4, position)
+    chunks.push(buffer.slice(0, bytesRead).toString())
+  }
+
+  const stats = await fd.readAhead()
+  t.equal(chunks.join(''), 'test 123\n', 'bytes are read in order')
+  t.equal(stats.hits + stats.stalls, 3, 'every read is served ahead')
+  t.equal(stats.misses, 0, 'sequential reads do not miss')
+  t.equal(typeof stats.stallTime, 'number', 'stall time is reported')
+  await fd.close()
+})
+
+if (os.platform() !== 'android') {
+  test('FileHandle#readAhead does not serve bytes overwritten after they were read', async (t) => {
+    const file = FIXTURES + 'read-ahead-write.txt'
+    await fs.writeFile(file, 'test 123\n')
+
+    const fd = await fs.open(file, 'r+')
+    await fd.readAhead({ size: 4, window: 2, offset: 0 })
+    await fd.write(Buffer.from('TEST'), 0, 4, 0)
+
+    const { bytesRead, buffer } = await fd.read(Buffer.alloc(4), 0, 4, 0)
+    t.equal(buffer.slice(0, bytesRead).toString(), 'TEST', 'the write is seen by the next read')
+
+    const stops = await Promise.all([
+      fd.readAhead({ window: 0 }),
+      fd.readAhead({ window: 0 })
+    ])
+
+    t.equal(stops.length, 2, 'concurrent stops both resolve')
+    await fd.close()
+    await fs.unlink(file)
+  })
+}
+
+if (os.platform() !== 'android') {
+  test('FileHandle#writeBehind coalesces writes until flushed', async (t) => {
+    const file = TMPDIR + 'write-behind.txt'
+    const fd = await fs.open(file, 'w+')
+    await fd.writeBehind({ delay: 60 * 1000 })
+
+    for (const [i, line] of ['a\n', 'b\n', 'c\n'].entries()) {
+      const { bytesWritten } = await fd.write(Buffer.from(line), 0, 2, i * 2)
+      t.equal(bytesWritten, 2, 'write is acknowledged once buffered')
+    }
+
+    await fd.flush()
+    const contents = await fs.readFile(file)
+    t.equal(contents.toString(), 'a\nb\nc\n', 'buffered writes are written in order')
+    await fd.close()
+  })
+
+  test('FileHandle#writeBehind writes directly once stopped', async (t) => {
+    const file = TMPDIR + 'write-behind-stop.txt'
+    const fd = await fs.open(file, 'w+')
+    await fd.writeBehind({ delay: 60 * 1000 })
+
+    const buffered = fd.write(Buffer.from('a\n'), 0, 2, 0)
+    const stopped = fd.writeBehind({ highWaterMark: 0 })
+    const direct = fd.write(Buffer.from('b\n'), 0, 2, 2)
+
+    await Promise.all([buffered, stopped, direct])
+    const contents = await fs.readFile(file)
+    t.equal(contents.toString(), 'a\nb\n', 'writes during and after stop are not lost')
+    await fd.close()
+  })
+}
+
+if (os.platform() !== 'android') {
+  test('fs.promises.writeFileAtomic', async (t) => {
+    const file = TMPDIR + 'write-file-atomic.txt'
+    await fs.writeFileAtomic(file, 'first')
+    await fs.writeFileAtomic(file, 'second')
+    t.equal((await fs.readFile(file)).toString(), 'second', 'file is replaced')
+
+    const files = [0, 1, 2, 3].map((i) => TMPDIR + `write-file-atomic-${i}.txt`)
+    await Promise.all(files.map((file, i) => fs.writeFileAtomic(file, String(i), { groupCommit: 5 })))
+
+    const contents = await Promise.all(files.map((file) => fs.readFile(file)))
+    t.deepEqual(contents.map(String), ['0', '1', '2', '3'], 'group committed writes are durable')
+
+    const fd = await fs.open(file, 'r+')
+    await fd.writeBehind({ delay: 60 * 1000 })
+    await fd.write(Buffer.from('synced'), 0, 6, 0)
+    await fd.sync()
+    t.equal((await fs.readFile(file)).toString(), 'synced', 'FileHandle#sync flushes buffered writes')
+    await fd.write(Buffer.from('second'), 0, 6, 0)
+    await fd.datasync()
+    t.equal((await fs.readFile(file)).toString(), 'second', 'FileHandle#datasync flushes buffered writes')
+    await fd.close()
+  })
+}
+
+if (os.platform() !== 'android') {
+  test('fs.promises.truncate', async (t) => {
+    const file = TMPDIR + 'truncate.txt'
+    await fs.writeFile(file, 'hello world')
+    await fs.truncate(file, 5)
+    t.equal((await fs.readFile(file)).toString(), 'hello', 'file is truncated')
+
+    const fd = await fs.open(file, 'r+')
+    await fd.truncate(8)
+    t.equal((await fd.stat()).size, 8, 'FileHandle#truncate extends the file')
+
+    await fd.fallocate(0, 4096)
+    t.equal((await fd.stat()).size, 4096, 'FileHandle#fallocate extends the file')
+
+    try {
+      await fd.punchHole(0, 4096)
+      t.equal((await fd.stat()).size, 4096, 'FileHandle#punchHole keeps the file size')
+    } catch (err) {
+      t.ok(err, 'FileHandle#punchHole is unsupported on this file system')
+    }
+
+    await fd.close()
+  })
+}
+
+test('FileHandle#sendToPeer sends the file as datagrams', async (t) => {
+  const server = dgram.createSocket('udp4')
+  const client = dgram.createSocket('udp4')
+  const received = []
+
+  await new Promise((resolve) => server.bind(41260, '127.0.0.1', resolve))
+  await new Promise((resolve) => client.bind(0, '127.0.0.1', resolve))
+
+  const messages = new Promise((resolve) => {
+    server.on('message', (message) => {
+      received.push(Buffer.from(message))
+      if (Buffer.concat(received).length >= 9) {
+        resolve()
+      }
+    })
+  })
+
+  const fd = await fs.open(FIXTURES + 'file.txt', 'r')
+  const result = await fd.sendToPeer(client, {
+    port: 41260,
+    address: '127.0.0.1',
+    chunkSize: 4
+  })
+
+  t.equal(result.bytesSent, 9, 'whole file is sent')
+  t.equal(result.chunks, 3, 'file is sent in chunkSize datagrams')
+
+  await messages
+  t.equal(Buffer.concat(received).toString(), 'test 123\n', 'datagrams arrive in order')
+
+  await fd.close()
+  await new Promise((resolve) => server.close(resolve))
+  await new Promise((resolve) => client.close(resolve))
+})
+
+test('fs.promises.hash', async (t) => {
+  const file = FIXTURES + 'file.txt'
+  const sha256 = '4082633a7a42a605affbe6b5c992ac9aa123a98613c36709e73e68920a54d763'
+
+  t.equal(await fs.hash(file), sha256, 'sha256 is the default algorithm')
+  t.equal(await fs.hash(file, 'blake2b256'), '0d14d9a0bdc8bd022d3d106126a7d52c5821fa624b7b50935051d89bcce9330d', 'blake2b256 digest is correct')
+  t.equal(await fs.hash(file, 'xxh64'), 'c9d909dd6d4beaa6', 'xxh64 digest is correct')
+  t.equal((await fs.hash(file, 'blake2b', { encoding: 'buffer' })).length, 64, 'blake2b digest is 64 bytes')
+
+  const fd = await fs.open(file, 'r')
+  t.equal(await fd.hash(), sha256, 'FileHandle#hash hashes an open file')
+  await fd.close()
+
+  try {
+    await fs.hash(file, 'md4')
+    t.fail('unsupported algorithms are rejected')
+  } catch (err) {
+    t.equal(err.code, 'ERR_CRYPTO_INVALID_DIGEST', 'unsupported algorithms are rejected')
+  }
+})
+
+if (os.platform() !== 'android') {
+  test('FileHandle#hashWrites hashes bytes as they are written', async (t) => {
+    const fd = await fs.open(TMPDIR + 'hash-writes.txt', 'w')
+    await fd.hashWrites('sha256')
+    await fd.write(Buffer.from('test '), 0, 5, 0)
+    await fd.write(Buffer.from('123\n'), 0, 4, 5)
+
+    t.equal(
+      await fd.digest(),
+      '4082633a7a42a605affbe6b5c992ac9aa123a98613c36709e73e68920a54d763',
+      'digest of the written bytes is correct'
+    )
+
+    await fd.hashWrites('sha256')
+    await fd.write(Buffer.from('test '), 0, 5, 0)
+    await fd.write(Buffer.from('123\n'), 0, 4, 0)
+
+    try {
+      await fd.digest()
+      t.fail('digest of non-contiguous writes should fail')
+    } catch (err) {
+      t.ok(err, 'digest is unavailable after a non-contiguous write')
+    }
+
+    await fd.close()
+  })
+}
+
+if (os.platform() !== 'android' && os.platform() !== 'win32') {
+  test('FileHandle#compressTo compresses between descriptors', async (t) => {
+    const source = await fs.open(FIXTURES + 'file.txt', 'r')
+    const compressed = await fs.open(TMPDIR + 'compress-to.txt.gz', 'w+')
+    const result = await source.compressTo(compressed)
+
+    t.equal(result.bytesIn, 9, 'every byte is read')
+    t.ok(result.bytesOut > 0, 'compressed bytes are written')
+
+    const target = await fs.open(TMPDIR + 'compress-to.txt', 'w+')
+    await compressed.close()
+
+    const input = await fs.open(TMPDIR + 'compress-to.txt.gz', 'r')
+    await input.compressTo(target, { decompress: true })
+    t.equal((await fs.readFile(TMPDIR + 'compress-to.txt')).toString(), 'test 123\n', 'decompressed bytes match')
+
+    await Promise.all([source.close(), input.close(), target.close()])
+  })
+}
+
+test('FileHandle#read fills the caller provided window', async (t) => {
+  const fd = await fs.open(FIXTURES + 'file.txt', 'r')
+  const window = Buffer.alloc(16, '.')
+  const { bytesRead, buffer } = await fd.read(window, 4, 8, 0)
+  t.equal(bytesRead, 8, 'bytes are read')
+  t.ok(buffer === window, 'caller buffer is returned')
+  t.equal(window.toString(), '....test 123....', 'bytes are written at offset')
+  await fd.close()
+})
+
+if (os.platform() !== 'win32') {
+  test('FileHandle#mmap serves reads from the mapping', async (t) => {
+    const fd = await fs.open(FIXTURES + 'file.txt', 'r')
+    const size = await fd.mmap({ advice: 'sequential' })
+    t.equal(size, 9, 'whole file is mapped')
+
+    const { bytesRead, buffer } = await fd.read(Buffer.alloc(4), 0, 4, 5)
+    t.equal(bytesRead, 4, 'bytes are read from the mapping')
+    t.equal(buffer.toString(), '123\n', 'mapped bytes are correct')
+
+    await fd.munmap()
+    await fd.close()
+  })
+}
+
+test('FileHandle#readv scatters a single read over buffers', async (t) => {
+  const fd = await fs.open(FIXTURES + 'file.txt', 'r')
+  const buffers = [Buffer.alloc(5), Buffer.alloc(4)]
+  const { bytesRead } = await fd.readv(buffers, 0)
+  t.equal(bytesRead, 9, 'all bytes are read')
+  t.equal(buffers[0].toString(), 'test ', 'first buffer is filled')
+  t.equal(buffers[1].toString(), '123\n', 'second buffer is filled')
+  await fd.close()
+})
+
+if (os.platform() !== 'android') {
+  test('FileHandle#writev gathers buffers into a single write', async (t) => {
+    const file = FIXTURES + 'writev-file.txt'
+    const fd = await fs.open(file, 'w')
+    const buffers = [Buffer.from('test '), Buffer.from('123'), Buffer.from('\n')]
+    const { bytesWritten } = await fd.writev(buffers, 0)
+    t.equal(bytesWritten, 9, 'all bytes are written')
+    await fd.close()
+    const contents = await fs.readFile(file)
+    t.equal(contents.toString(), 'test 123\n', 'file contents are correct')
+    await fs.unlink(file)
+  })
+}
+
 test('fs.promises.readFile', async (t) => {
   const data = await fs.readFile(FIXTURES + 'file.txt')
   t.ok(Buffer.isBuffer(data), 'buffer is returned')
@@ -97,3 +472,46 @@ if (os.platform() !== 'android') {
     t.equal(contents.toString(), data, 'file contents are correct')
   })
 }
+
+if (os.platform() !== 'android') {
+  test('FileHandle#writeFile and FileHandle#readFile', async (t) => {
+    const file = FIXTURES + 'handle-file.txt'
+    const data = Buffer.alloc(200 * 1024, 'socket ')
+
+    let handle = await fs.open(file, 'w')
+    await handle.writeFile(data)
+    await handle.close()
+
+    handle = await fs.open(file, 'r')
+    const contents = await handle.readFile()
+    t.ok(contents.equals(data), 'file larger than one chunk is read back whole')
+    t.equal(await handle.readFile({ encoding: 'utf8' }), '', 'reading again at EOF is empty')
+    await handle.close()
+
+    await fs.unlink(file)
+  })
+
+  test('FileHandle#writeFile and FileHandle#readFile report errors', async (t) => {
+    const file = FIXTURES + 'handle-file-errors.txt'
+
+    let handle = await fs.open(file, 'w')
+    try {
+      await handle.readFile()
+      t.fail('readFile on a write only handle should fail')
+    } catch (err) {
+      t.ok(err instanceof Error && err.message, 'readFile rejects with the native error')
+    }
+    await handle.close()
+
+    handle = await fs.open(file, 'r')
+    try {
+      await handle.writeFile('test 123\n')
+      t.fail('writeFile on a read only handle should fail')
+    } catch (err) {
+      t.ok(err instanceof Error && err.message, 'writeFile rejects with the native error')
+    }
+    await handle.close()
+
+    await fs.unlink(file)
+  })
+}
@@ -10,9 +10,11 @@ import './os.js'
 import './process.js'
 import './path.js'
 import './dgram.js'
+import './p2p.js'
 import './dns.js'
 import './backend.js'
 import './crypto.js'
 import './util.js'
 import './runtime.js'
 import './fs.js'
+import './stream.js'
@@ -0,0 +1,117 @@
+import { EventEmitter } from 'socket:events'
+import { test } from 'socket:test'
+import Buffer from 'socket:buffer'
+import dgram from 'socket:dgram'
+import p2p from 'socket:p2p'
+
+test('p2p exports', t => {
+  t.ok(p2p.Channel.prototype instanceof EventEmitter, 'p2p.Channel is an EventEmitter')
+  t.ok(typeof p2p.createChannel === 'function', 'p2p.createChannel is available')
+})
+
+test('p2p.Channel delivers whole messages in order', async t => {
+  const a = p2p.createChannel({ port: 41300, address: '127.0.0.1' })
+  const b = p2p.createChannel({ port: 41301, address: '127.0.0.1' })
+  const large = Buffer.alloc(8 * 1024, 'x')
+  const expected = ['hello', 'world', large.toString(), 'done']
+
+  t.ok(!(await a.open(41301, '127.0.0.1')).err, 'channel a opened')
+  t.ok(!(await b.open(41300, '127.0.0.1')).err, 'channel b opened')
+
+  const received = new Promise((resolve) => {
+    const messages = []
+    b.on('message', (message) => {
+      messages.push(message.toString())
+      if (messages.length === expected.length) resolve(messages)
+    })
+  })
+
+  for (const message of expected) {
+    await a.send(message)
+  }
+
+  t.deepEqual(await received, expected, 'messages are received in order')
+
+  const state = await a.getState()
+  t.ok(state.packetsSent > expected.length, 'large message was fragmented')
+
+  await a.close()
+  await b.close()
+})
+
+test('p2p.Channel send queue is bounded', async t => {
+  const a = p2p.createChannel({ port: 41302, address: '127.0.0.1' })
+
+  // nothing listens on the remote port, so nothing is ever acknowledged
+  t.ok(!(await a.open(41303, '127.0.0.1')).err, 'channel opened')
+
+  const result = await a.send(Buffer.alloc(8 * 1024 * 1024))
+  t.equal(result.err?.code, 'ENOBUFS', 'a send larger than the queue fails')
+
+  const state = await a.getState()
+  t.ok(state.queued + state.inflight <= 4096, 'the queue did not grow')
+
+  await a.close()
+})
+
+test('p2p.Channel drops messages larger than a sender can queue', async t => {
+  const b = p2p.createChannel({ port: 41304, address: '127.0.0.1' })
+  const raw = dgram.createSocket('udp4')
+  const fragmentSize = 60 * 1024
+  const maxMessageSize = 4096 * 1200
+  let acked = 0n
+  let onack = null
+
+  await new Promise((resolve) => raw.bind(41305, '127.0.0.1', resolve))
+  t.ok(!(await b.open(41305, '127.0.0.1')).err, 'channel opened')
+
+  const received = new Promise((resolve) => {
+    b.once('message', (message) => resolve(message.toString()))
+  })
+
+  raw.on('message', (packet) => {
+    // ACK: [version:1][type:1][flags:1][reserved:1][ack:8][sack:8]
+    if (packet[1] === 2) {
+      acked = packet.readBigUInt64BE(4)
+      if (onack) onack()
+    }
+  })
+
+  // sends DATA packets one at a time, resending until each is acknowledged
+  async function send (seq, more, payload) {
+    const packet = Buffer.alloc(12 + payload.length)
+    packet[0] = 1
+    packet[1] = 1
+    packet[2] = more ? 1 : 0
+    packet.writeBigUInt64BE(BigInt(seq), 4)
+    payload.copy(packet, 12)
+
+    while (acked <= BigInt(seq)) {
+      raw.send(packet, 41304, '127.0.0.1')
+      await new Promise((resolve) => {
+        onack = resolve
+        setTimeout(resolve, 100)
+      })
+    }
+  }
+
+  const fragment = Buffer.alloc(fragmentSize, 'x')
+  const fragments = Math.ceil(maxMessageSize / fragmentSize) + 1
+  let seq = 0
+
+  for (let i = 0; i < fragments; ++i) {
+    await send(seq++, true, fragment)
+  }
+
+  await send(seq++, false, Buffer.alloc(0))
+  await send(seq++, false, Buffer.from('after'))
+
+  t.equal(await received, 'after', 'the next message is still delivered')
+
+  const state = await b.getState()
+  t.equal(state.dropped, 1, 'the oversized message was dropped')
+  t.equal(state.delivered, 1, 'nothing else was delivered')
+
+  await b.close()
+  raw.close()
+})
@@ -0,0 +1,34 @@
+import { test } from 'socket:test'
+import Buffer from 'socket:buffer'
+import os from 'socket:os'
+
+import {
+  createCompressionStream,
+  createDecompressionStream,
+  pipelinePromise,
+  Readable,
+  Writable
+} from 'socket:stream'
+
+if (os.platform() !== 'win32') {
+  test('stream.CompressionStream round trips through gzip', async (t) => {
+    const input = Buffer.from('hello world '.repeat(16 * 1024))
+    const chunks = []
+
+    const compress = createCompressionStream()
+    await pipelinePromise(
+      Readable.from([input.slice(0, 1024), input.slice(1024)]),
+      compress,
+      createDecompressionStream(),
+      new Writable({
+        write (data, cb) {
+          chunks.push(data)
+          cb(null)
+        }
+      })
+    )
+
+    t.ok(compress.bytesOut < compress.bytesIn, 'output is compressed')
+    t.ok(Buffer.concat(chunks).equals(input), 'decompressed bytes match')
+  })
+}